@@ -125,6 +125,15 @@ static portTASK_FUNCTION_PROTO( vPolledQueueConsumer, pvParameters );
 errors. */
 static volatile BaseType_t xPollingConsumerCount = pollqINITIAL_VALUE, xPollingProducerCount = pollqINITIAL_VALUE;
 
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The queue's structure and storage, and the TCBs and stacks of the two
+	tasks. */
+	static StaticQueue_t xPolledQueueBuffer;
+	static uint8_t ucPolledQueueStorage[ pollqQUEUE_SIZE * sizeof( uint16_t ) ];
+	static StaticTask_t xConsumerTaskBuffer, xProducerTaskBuffer;
+	static StackType_t xConsumerStack[ pollqSTACK_SIZE ], xProducerStack[ pollqSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartPolledQueueTasks( UBaseType_t uxPriority )
@@ -132,7 +141,15 @@ void vStartPolledQueueTasks( UBaseType_t uxPriority )
 static QueueHandle_t xPolledQueue;
 
 	/* Create the queue used by the producer and consumer. */
-	xPolledQueue = xQueueCreate( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ) );
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		xPolledQueue = xQueueCreateStatic( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ), ucPolledQueueStorage, &xPolledQueueBuffer );
+	}
+	#else
+	{
+		xPolledQueue = xQueueCreate( pollqQUEUE_SIZE, ( UBaseType_t ) sizeof( uint16_t ) );
+	}
+	#endif
 
 	if( xPolledQueue != NULL )
 	{
@@ -145,8 +162,17 @@ static QueueHandle_t xPolledQueue;
 		vQueueAddToRegistry( xPolledQueue, "Poll_Test_Queue" );
 
 		/* Spawn the producer and consumer. */
-		xTaskCreate( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
-		xTaskCreate( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			xTaskCreateStatic( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, xConsumerStack, &xConsumerTaskBuffer );
+			xTaskCreateStatic( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, xProducerStack, &xProducerTaskBuffer );
+		}
+		#else
+		{
+			xTaskCreate( vPolledQueueConsumer, "QConsNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+			xTaskCreate( vPolledQueueProducer, "QProdNB", pollqSTACK_SIZE, ( void * ) &xPolledQueue, uxPriority, ( TaskHandle_t * ) NULL );
+		}
+		#endif
 	}
 }
 /*-----------------------------------------------------------*/
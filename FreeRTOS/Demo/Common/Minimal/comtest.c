@@ -153,17 +153,32 @@ increment this variable after every successfully received sequence.  If at any
 time the sequence is incorrect the the variable will stop being incremented. */
 static volatile UBaseType_t uxRxLoops = comINITIAL_RX_COUNT_VALUE;
 
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The TCBs and stacks of the Tx and Rx tasks. */
+	static StaticTask_t xTxTaskBuffer, xRxTaskBuffer;
+	static StackType_t xTxStack[ comSTACK_SIZE ], xRxStack[ comSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vAltStartComTestTasks( UBaseType_t uxPriority, uint32_t ulBaudRate, UBaseType_t uxLED )
 {
 	/* Initialise the com port then spawn the Rx and Tx tasks. */
 	uxBaseLED = uxLED;
-	xSerialPortInitMinimal( ulBaudRate, comBUFFER_LEN );
+	xPort = xSerialPortInitMinimal( ulBaudRate, comBUFFER_LEN );
 
 	/* The Tx task is spawned with a lower priority than the Rx task. */
-	xTaskCreate( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
-	xTaskCreate( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		xTaskCreateStatic( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, xTxStack, &xTxTaskBuffer );
+		xTaskCreateStatic( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, xRxStack, &xRxTaskBuffer );
+	}
+	#else
+	{
+		xTaskCreate( vComTxTask, "COMTx", comSTACK_SIZE, NULL, uxPriority - 1, ( TaskHandle_t * ) NULL );
+		xTaskCreate( vComRxTask, "COMRx", comSTACK_SIZE, NULL, uxPriority, ( TaskHandle_t * ) NULL );
+	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -119,6 +119,13 @@ created. */
 /* We don't want to block when posting to the queue. */
 #define crfPOSTING_BLOCK_TIME		0
 
+/* With static allocation a control block is reserved for every 'fixed delay'
+co-routine that can be created, so the limit is lowered to what the demo
+uses. */
+#ifndef crfMAX_STATIC_FLASH_TASKS
+	#define crfMAX_STATIC_FLASH_TASKS	3
+#endif
+
 /*
  * The 'fixed delay' co-routine as described at the top of the file.
  */
@@ -136,6 +143,14 @@ static QueueHandle_t xFlashQueue;
 /* This will be set to pdFALSE if we detect an error. */
 static BaseType_t xCoRoutineFlashStatus = pdPASS;
 
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The queue's structure and storage, and the control blocks of the 'fixed
+	delay' co-routines followed by the 'flash' co-routine. */
+	static StaticQueue_t xFlashQueueBuffer;
+	static uint8_t ucFlashQueueStorage[ crfQUEUE_LENGTH * sizeof( UBaseType_t ) ];
+	static StaticCoRoutine_t xCoRoutineBuffers[ crfMAX_STATIC_FLASH_TASKS + 1 ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -150,19 +165,49 @@ UBaseType_t uxIndex;
 		uxNumberToCreate = crfMAX_FLASH_TASKS;
 	}
 
-	/* Create the queue used to pass data between the co-routines. */
-	xFlashQueue = xQueueCreate( crfQUEUE_LENGTH, sizeof( UBaseType_t ) );
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		if( uxNumberToCreate > crfMAX_STATIC_FLASH_TASKS )
+		{
+			uxNumberToCreate = crfMAX_STATIC_FLASH_TASKS;
+		}
+
+		/* Create the queue used to pass data between the co-routines. */
+		xFlashQueue = xQueueCreateStatic( crfQUEUE_LENGTH, sizeof( UBaseType_t ), ucFlashQueueStorage, &xFlashQueueBuffer );
+	}
+	#else
+	{
+		/* Create the queue used to pass data between the co-routines. */
+		xFlashQueue = xQueueCreate( crfQUEUE_LENGTH, sizeof( UBaseType_t ) );
+	}
+	#endif
 
 	if( xFlashQueue )
 	{
 		/* Create uxNumberToCreate 'fixed delay' co-routines. */
 		for( uxIndex = 0; uxIndex < uxNumberToCreate; uxIndex++ )
 		{
-			xCoRoutineCreate( prvFixedDelayCoRoutine, crfFIXED_DELAY_PRIORITY, uxIndex );
+			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				xCoRoutineCreateStatic( prvFixedDelayCoRoutine, crfFIXED_DELAY_PRIORITY, uxIndex, &( xCoRoutineBuffers[ uxIndex ] ) );
+			}
+			#else
+			{
+				xCoRoutineCreate( prvFixedDelayCoRoutine, crfFIXED_DELAY_PRIORITY, uxIndex );
+			}
+			#endif
 		}
 
 		/* Create the 'flash' co-routine. */
-		xCoRoutineCreate( prvFlashCoRoutine, crfFLASH_PRIORITY, crfFLASH_INDEX );
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			xCoRoutineCreateStatic( prvFlashCoRoutine, crfFLASH_PRIORITY, crfFLASH_INDEX, &( xCoRoutineBuffers[ uxNumberToCreate ] ) );
+		}
+		#else
+		{
+			xCoRoutineCreate( prvFlashCoRoutine, crfFLASH_PRIORITY, crfFLASH_INDEX );
+		}
+		#endif
 	}
 }
 /*-----------------------------------------------------------*/
@@ -106,6 +106,12 @@ false, flagging an error if the variable is still false the next time it
 is called. */
 static volatile BaseType_t xTaskCheck[ intgNUMBER_OF_TASKS ] = { ( BaseType_t ) pdFALSE };
 
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The TCB and stack of each task. */
+	static StaticTask_t xIntMathTaskBuffers[ intgNUMBER_OF_TASKS ];
+	static StackType_t xIntMathStacks[ intgNUMBER_OF_TASKS ][ intgSTACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartIntegerMathTasks( UBaseType_t uxPriority )
@@ -114,7 +120,15 @@ short sTask;
 
 	for( sTask = 0; sTask < intgNUMBER_OF_TASKS; sTask++ )
 	{
-		xTaskCreate( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, ( TaskHandle_t * ) NULL );
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			xTaskCreateStatic( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, xIntMathStacks[ sTask ], &( xIntMathTaskBuffers[ sTask ] ) );
+		}
+		#else
+		{
+			xTaskCreate( vCompeteingIntMathTask, "IntMath", intgSTACK_SIZE, ( void * ) &( xTaskCheck[ sTask ] ), uxPriority, ( TaskHandle_t * ) NULL );
+		}
+		#endif
 	}
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,1088 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Measures the CPU cycles taken by the kernel primitives used on hot paths,
+ * and writes them to a serial port in a form that can be diffed between
+ * builds.  Each round starts with
+ *
+ *     KERN begin clock=16000000 prescaler=64
+ *
+ * and then has one line per primitive, such as
+ *
+ *     KERN send n=1024 cycles=312.25
+ *
+ * cycles being the average over n operations, to hundredths of a cycle as
+ * the host simulation is faster than a cycle of the simulated CPU clock for
+ * some, and ends with "KERN end".  The primitives, in order, are:
+ *
+ *  - timer:          reading the time itself, which is taken off the others.
+ *  - queue_ram:      the bytes of RAM taken by the structure of a queue and by
+ *                    that of a queue of 1 byte items (the same unless
+ *                    configUSE_BYTE_QUEUES is 1 and configUSE_QUEUE_INDICES
+ *                    is 0), not counting the storage.
+ *  - yield:          taskYIELD() with no other task ready at the same priority,
+ *                    so the context is saved and restored but not switched.
+ *  - switch:         taskYIELD() to a task of the same priority that yields
+ *                    straight back, per context switch.
+ *  - send/receive:   xQueueSend() and xQueueReceive() of one byte with no block
+ *                    time and no task waiting on the queue.  Diff the byte
+ *                    queue lines against a build with configUSE_BYTE_QUEUES 0,
+ *                    or all the queue lines against one with
+ *                    configUSE_QUEUE_INDICES 0.
+ *  - send_wake:      xQueueSend() to a queue a higher priority task is waiting
+ *                    to receive from, per round trip - the send, the switch to
+ *                    the woken task, its receive blocking again and the switch
+ *                    back.
+ *  - receive_wake:   the same for xQueueReceive() from a full queue a higher
+ *                    priority task is waiting to send to.
+ *  - send_isr/receive_isr: xQueueSendFromISR() and xQueueReceiveFromISR(),
+ *                    called with interrupts disabled as from an ISR.
+ *  - suspend_resume: vTaskSuspendAll() followed by xTaskResumeAll() with
+ *                    nothing to do on resuming.
+ *  - delay_until:    the time from the tick at which vTaskDelayUntil() should
+ *                    return until it has returned, with min and max as well.
+ *  - pollq:          the PollQ.c workload - kbPOLLQ_VALUES 16 bit values
+ *                    posted to a queue of kbPOLLQ_LENGTH with xQueueSend(),
+ *                    then received while uxQueueMessagesWaiting() is not 0 -
+ *                    per value posted and received.
+ *  - pollq_multiple: the same with one xQueueSendMultiple() and one
+ *                    xQueueReceiveMultiple() per round.
+ *  - pollq_full/pollq_full_multiple: the same, filling the queue each round.
+ *  - record:         a kbRECORD_SIZE byte record filled in, posted with
+ *                    xQueueSend(), received with xQueueReceive() and summed -
+ *                    per record.
+ *  - record_slot:    the same filled in and summed where it lies in the
+ *                    queue, with pvQueueAcquireSlot()/vQueueCommitSlot() and
+ *                    pvQueueBorrowSlot()/vQueueReleaseSlot().
+ *  - record_isr/record_slot_isr: the same with the FromISR calls.
+ *  - slot_held:      not a time, but a check that a slot held by
+ *                    pvQueueAcquireSlot() or pvQueueBorrowSlot() is kept from
+ *                    the woken task, which posts a record to the back of the
+ *                    queue while a slot is acquired, and to the front while a
+ *                    record is borrowed, and has to wait until the slot is
+ *                    committed or released.  Gives the records that did not
+ *                    come out in the right order, which should be 0.
+ *
+ * The pollq and record lines also give the values or records moved per
+ * second, and the number that did not come out of the queue as they went in,
+ * which should be 0.
+ *
+ * The time comes from timer 1, which generates the tick: the tick count times
+ * the counts per tick (OCR1A + 1), plus TCNT1.  At 16MHz a count of timer 1
+ * is 64 cycles, so all but delay_until are timed in batches of kbBATCH
+ * operations and averaged.  Timer 3 runs at the CPU clock alongside it, and
+ * gives the cycles of a batch instead when timer 1 shows the batch took less
+ * than a wrap of TCNT3.  That matters most in the host simulation, where a
+ * batch can take less than a count of timer 1.  delay_until is a single TCNT1
+ * reading per sample, so is only good to 64 cycles.  Tick interrupts that
+ * fall in a batch are included, adding well under 1% at a 1KHz tick.
+ *
+ * The measuring task and the task it yields to run at the priority passed to
+ * vStartKernelBenchTasks(), and the woken task at the next priority up, so no
+ * other task should be ready at either while the measurements are taken.  The
+ * port is opened here, so no other task can use it.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo program include files. */
+#include "serial.h"
+#include "kernbench.h"
+
+/* Operations timed together, and batches averaged, per primitive. */
+#define kbBATCH					( ( UBaseType_t ) 16 )
+#define kbBATCHES				( ( UBaseType_t ) 64 )
+#define kbOPERATIONS			( ( uint32_t ) kbBATCH * ( uint32_t ) kbBATCHES )
+
+/* vTaskDelayUntil() wakes averaged. */
+#define kbDELAY_SAMPLES			( ( uint16_t ) 64 )
+
+/* Time between rounds. */
+#define kbPERIOD				( ( TickType_t ) 10000 / portTICK_PERIOD_MS )
+
+/* Values passed through the queues.  The task woken by send_wake stops
+receiving when it receives kbSTOP_VALUE. */
+#define kbQUEUE_VALUE			( ( uint8_t ) 0x55 )
+#define kbSTOP_VALUE			( ( uint8_t ) 0xff )
+
+/* What the woken task does when it is notified. */
+#define kbWAKE_RECEIVE			( ( UBaseType_t ) 0 )
+#define kbWAKE_SEND				( ( UBaseType_t ) 1 )
+#define kbWAKE_SEND_RECORD		( ( UBaseType_t ) 2 )
+#define kbWAKE_SEND_RECORD_FRONT	( ( UBaseType_t ) 3 )
+
+/* The queue and round of PollQ.c. */
+#define kbPOLLQ_LENGTH			( ( UBaseType_t ) 10 )
+#define kbPOLLQ_VALUES			( ( UBaseType_t ) 3 )
+
+/* The records moved by record and record_slot, and the queue they go
+through. */
+#ifndef kbRECORD_SIZE
+	#define kbRECORD_SIZE		( ( UBaseType_t ) 32 )
+#endif
+#define kbRECORD_QUEUE_LENGTH	( ( UBaseType_t ) 4 )
+
+/* Clock select bits of TCCR1B. */
+#define kbCLOCK_SELECT			( ( uint8_t ) 0x07 )
+
+/* Timer 3 in normal mode, clocked with no prescaler. */
+#define kbTIMER3_NORMAL_TCCR3A		( ( uint8_t ) 0b00000000 )
+#define kbTIMER3_NO_PRESCALE_TCCR3B	( ( uint8_t ) 0b00000001 )
+
+#define kbSERIAL_QUEUE_LENGTH	( ( unsigned portBASE_TYPE ) 48 )
+#define kbTX_BLOCK_TIME			( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define kbSTACK_SIZE			( configMINIMAL_STACK_SIZE + 32 )
+
+/* A point in time, from timer 1, and TCNT3 at the same moment. */
+typedef struct KERNEL_BENCH_TIME
+{
+	TickType_t xTick;
+	uint16_t usCount;
+	uint16_t usCycles;
+} KernelBenchTime_t;
+
+/*
+ * The task that takes the measurements, and the two it switches to.
+ */
+static portTASK_FUNCTION_PROTO( vKernelBenchTask, pvParameters );
+static portTASK_FUNCTION_PROTO( vKernelBenchYieldTask, pvParameters );
+static portTASK_FUNCTION_PROTO( vKernelBenchWakeTask, pvParameters );
+
+/*
+ * Measure and write one line for each primitive.
+ */
+static void prvMeasureYield( void );
+static void prvMeasureQueue( void );
+static void prvMeasureWake( void );
+static void prvMeasureDelayUntil( void );
+static void prvMeasurePollQ( void );
+
+/*
+ * Move the PollQ.c workload through xPollQueue, uxValues values per round,
+ * one at a time or with the batch calls.  Returns the cycles taken, and
+ * counts the values received out of order in ulErrors.
+ */
+static uint32_t prvPollQRounds( UBaseType_t uxValues, BaseType_t xMultiple );
+
+/*
+ * Fill in and sum records, moving them through xRecordQueue by copy or in
+ * place, from a task or as from an ISR.  Returns the cycles taken, and counts
+ * the records that do not add up in ulErrors.
+ */
+static void prvMeasureRecords( void );
+static uint32_t prvRecordRounds( BaseType_t xInPlace, BaseType_t xFromISR );
+static void prvFillRecord( uint8_t *pucRecord, uint8_t ucSequence );
+static void prvCheckRecord( const uint8_t *pucRecord, uint8_t ucSequence );
+
+/*
+ * Have the woken task post records while this one holds a slot of the record
+ * queue, counting the records that come out of order in ulErrors.
+ */
+static void prvCheckHeldSlots( void );
+
+/*
+ * Read the time, and the cycles since an earlier time.
+ */
+static void prvGetTime( KernelBenchTime_t *pxTime );
+static uint32_t prvCyclesSince( const KernelBenchTime_t *pxStart );
+
+/*
+ * Write the line for a primitive that took ulCycles, less the time taken to
+ * read the time, for kbBATCHES batches of ulOperations operations in total.
+ */
+static void prvReport( const char *pcName, uint32_t ulCycles, uint32_t ulOperations );
+
+/*
+ * As prvReport(), adding the operations per second and ulErrors.
+ */
+static void prvReportThroughput( const char *pcName, uint32_t ulCycles, uint32_t ulOperations );
+
+/*
+ * Write a string to the serial port, and ulCycles divided by ulOperations as
+ * " cycles=" to two decimal places.
+ */
+static void prvSendString( const char *pcString );
+static void prvSendCycles( uint32_t ulCycles, uint32_t ulOperations );
+
+/* Handle of the port the results are written to. */
+static xComPortHandle xPort = NULL;
+
+/* The queue used with no task waiting, which holds a batch, and the one the
+woken task waits on. */
+static QueueHandle_t xQueue = NULL;
+static QueueHandle_t xWakeQueue = NULL;
+
+/* The queue the PollQ.c workload goes through, and the next value to post
+and receive. */
+static QueueHandle_t xPollQueue = NULL;
+static uint16_t usPollQSend = 0, usPollQReceive = 0;
+
+/* The queue of records, and the records copied into and out of it. */
+static QueueHandle_t xRecordQueue = NULL;
+static uint8_t ucRecordOut[ kbRECORD_SIZE ], ucRecordIn[ kbRECORD_SIZE ];
+
+/* The record the woken task posts for slot_held, and its sequence number. */
+static uint8_t ucWakeRecord[ kbRECORD_SIZE ];
+static volatile uint8_t ucWakeSequence = 0;
+
+/* Values or records that did not come out as they went in. */
+static uint32_t ulErrors = 0;
+
+static TaskHandle_t xYieldTask = NULL;
+static TaskHandle_t xWakeTask = NULL;
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The structures and storage of the queues, and the TCBs and stacks of the
+	three tasks. */
+	static StaticByteQueue_t xQueueBuffer, xWakeQueueBuffer;
+	static StaticQueue_t xPollQueueBuffer, xRecordQueueBuffer;
+	static uint8_t ucQueueStorage[ kbBATCH * sizeof( uint8_t ) ], ucWakeQueueStorage[ sizeof( uint8_t ) ];
+	static uint8_t ucPollQueueStorage[ kbPOLLQ_LENGTH * sizeof( uint16_t ) ];
+	static uint8_t ucRecordQueueStorage[ kbRECORD_QUEUE_LENGTH * kbRECORD_SIZE ];
+	static StaticTask_t xYieldTaskBuffer, xWakeTaskBuffer, xBenchTaskBuffer;
+	static StackType_t xYieldStack[ configMINIMAL_STACK_SIZE ], xWakeStack[ configMINIMAL_STACK_SIZE ], xBenchStack[ kbSTACK_SIZE ];
+#endif
+
+/* Told to the other tasks before they are notified. */
+static volatile BaseType_t xYielding = pdFALSE;
+static volatile BaseType_t xSending = pdFALSE;
+static volatile UBaseType_t uxWakeAction = kbWAKE_RECEIVE;
+
+/* Timer 1 set up, read when the measurements start. */
+static uint32_t ulCountsPerTick = 0;
+static uint16_t usPrescaler = 0;
+
+/* Cycles taken by kbBATCHES batches just to read the time. */
+static uint32_t ulOverhead = 0;
+
+/* Timer 1 prescalers by clock select value. */
+static const uint16_t usPrescalers[ kbCLOCK_SELECT + 1 ] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+/*-----------------------------------------------------------*/
+
+void vStartKernelBenchTasks( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	/* The woken task has to be able to preempt the measuring task. */
+	configASSERT( uxPriority < ( configMAX_PRIORITIES - 1 ) );
+
+	xPort = xSerialPortInitMinimal( ulBaudRate, kbSERIAL_QUEUE_LENGTH );
+
+	TCCR3A = kbTIMER3_NORMAL_TCCR3A;
+	TCCR3B = kbTIMER3_NO_PRESCALE_TCCR3B;
+
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		xQueue = xQueueCreateByteStatic( kbBATCH, ucQueueStorage, &xQueueBuffer );
+		xWakeQueue = xQueueCreateByteStatic( 1, ucWakeQueueStorage, &xWakeQueueBuffer );
+		xPollQueue = xQueueCreateStatic( kbPOLLQ_LENGTH, ( UBaseType_t ) sizeof( uint16_t ), ucPollQueueStorage, &xPollQueueBuffer );
+		xRecordQueue = xQueueCreateStatic( kbRECORD_QUEUE_LENGTH, kbRECORD_SIZE, ucRecordQueueStorage, &xRecordQueueBuffer );
+
+		xYieldTask = xTaskCreateStatic( vKernelBenchYieldTask, "KBYield", configMINIMAL_STACK_SIZE, NULL, uxPriority, xYieldStack, &xYieldTaskBuffer );
+		xWakeTask = xTaskCreateStatic( vKernelBenchWakeTask, "KBWake", configMINIMAL_STACK_SIZE, NULL, uxPriority + 1, xWakeStack, &xWakeTaskBuffer );
+		xTaskCreateStatic( vKernelBenchTask, "KBench", kbSTACK_SIZE, NULL, uxPriority, xBenchStack, &xBenchTaskBuffer );
+	}
+	#else
+	{
+		xQueue = xQueueCreate( kbBATCH, ( UBaseType_t ) sizeof( uint8_t ) );
+		xWakeQueue = xQueueCreate( 1, ( UBaseType_t ) sizeof( uint8_t ) );
+		xPollQueue = xQueueCreate( kbPOLLQ_LENGTH, ( UBaseType_t ) sizeof( uint16_t ) );
+		xRecordQueue = xQueueCreate( kbRECORD_QUEUE_LENGTH, kbRECORD_SIZE );
+
+		if( ( xQueue != NULL ) && ( xWakeQueue != NULL ) && ( xPollQueue != NULL ) && ( xRecordQueue != NULL ) )
+		{
+			xTaskCreate( vKernelBenchYieldTask, "KBYield", configMINIMAL_STACK_SIZE, NULL, uxPriority, &xYieldTask );
+			xTaskCreate( vKernelBenchWakeTask, "KBWake", configMINIMAL_STACK_SIZE, NULL, uxPriority + 1, &xWakeTask );
+			xTaskCreate( vKernelBenchTask, "KBench", kbSTACK_SIZE, NULL, uxPriority, NULL );
+		}
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vKernelBenchTask, pvParameters )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		ulCountsPerTick = ( uint32_t ) OCR1A + 1UL;
+		usPrescaler = usPrescalers[ TCCR1B & kbCLOCK_SELECT ];
+
+		vSerialPutValue( xPort, "KERN begin clock=", configCPU_CLOCK_HZ, kbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " prescaler=", usPrescaler, kbTX_BLOCK_TIME );
+		prvSendString( "\r\n" );
+
+		/* Let the line go, so the serial interrupts are out of the way. */
+		vTaskDelay( kbTX_BLOCK_TIME );
+
+		/* The cost of reading the time, taken off every batch. */
+		ulOverhead = 0;
+		for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+		{
+			prvGetTime( &xStart );
+			ulOverhead += prvCyclesSince( &xStart );
+		}
+		vSerialPutValue( xPort, "KERN timer n=", kbBATCHES, kbTX_BLOCK_TIME );
+		prvSendCycles( ulOverhead, kbBATCHES );
+		prvSendString( "\r\n" );
+		vSerialPutValue( xPort, "KERN queue_ram queue=", sizeof( StaticQueue_t ), kbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " byte_queue=", sizeof( StaticByteQueue_t ), kbTX_BLOCK_TIME );
+		prvSendString( "\r\n" );
+		vTaskDelay( kbTX_BLOCK_TIME );
+
+		prvMeasureYield();
+		prvMeasureQueue();
+		prvMeasureWake();
+		prvMeasureDelayUntil();
+		prvMeasurePollQ();
+		prvMeasureRecords();
+		prvCheckHeldSlots();
+
+		prvSendString( "KERN end\r\n" );
+
+		vTaskDelay( kbPERIOD );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureYield( void )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch, ux;
+uint32_t ulCycles = 0;
+
+	/* Nothing else is ready at this priority. */
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			taskYIELD();
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+	prvReport( "yield", ulCycles, kbOPERATIONS );
+
+	/* Make the yield task ready, and let it get to its own yield loop before
+	starting.  Each yield then switches there and back. */
+	xYielding = pdTRUE;
+	xTaskNotifyGive( xYieldTask );
+	taskYIELD();
+
+	ulCycles = 0;
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			taskYIELD();
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+
+	/* The yield task waits to be notified again. */
+	xYielding = pdFALSE;
+	taskYIELD();
+
+	prvReport( "switch", ulCycles, kbOPERATIONS * 2UL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureQueue( void )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch, ux;
+uint32_t ulSendCycles = 0, ulReceiveCycles = 0;
+uint8_t ucValue = kbQUEUE_VALUE;
+BaseType_t xWoken = pdFALSE;
+
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			( void ) xQueueSend( xQueue, &ucValue, 0 );
+		}
+		ulSendCycles += prvCyclesSince( &xStart );
+
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			( void ) xQueueReceive( xQueue, &ucValue, 0 );
+		}
+		ulReceiveCycles += prvCyclesSince( &xStart );
+	}
+	prvReport( "send", ulSendCycles, kbOPERATIONS );
+	prvReport( "receive", ulReceiveCycles, kbOPERATIONS );
+
+	/* The same from an ISR.  Each batch is short enough that a tick is only
+	held off, not lost. */
+	ulSendCycles = 0;
+	ulReceiveCycles = 0;
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		portENTER_CRITICAL();
+		{
+			for( ux = 0; ux < kbBATCH; ux++ )
+			{
+				( void ) xQueueSendFromISR( xQueue, &ucValue, &xWoken );
+			}
+		}
+		portEXIT_CRITICAL();
+		ulSendCycles += prvCyclesSince( &xStart );
+
+		prvGetTime( &xStart );
+		portENTER_CRITICAL();
+		{
+			for( ux = 0; ux < kbBATCH; ux++ )
+			{
+				( void ) xQueueReceiveFromISR( xQueue, &ucValue, &xWoken );
+			}
+		}
+		portEXIT_CRITICAL();
+		ulReceiveCycles += prvCyclesSince( &xStart );
+	}
+	prvReport( "send_isr", ulSendCycles, kbOPERATIONS );
+	prvReport( "receive_isr", ulReceiveCycles, kbOPERATIONS );
+
+	ulSendCycles = 0;
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			vTaskSuspendAll();
+			( void ) xTaskResumeAll();
+		}
+		ulSendCycles += prvCyclesSince( &xStart );
+	}
+	prvReport( "suspend_resume", ulSendCycles, kbOPERATIONS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureWake( void )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch, ux;
+uint32_t ulCycles = 0;
+uint8_t ucValue = kbQUEUE_VALUE;
+
+	/* The wake task preempts this one as soon as it is notified, and blocks
+	receiving from the empty queue. */
+	uxWakeAction = kbWAKE_RECEIVE;
+	xTaskNotifyGive( xWakeTask );
+
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			( void ) xQueueSend( xWakeQueue, &ucValue, 0 );
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+
+	ucValue = kbSTOP_VALUE;
+	( void ) xQueueSend( xWakeQueue, &ucValue, 0 );
+	prvReport( "send_wake", ulCycles, kbOPERATIONS );
+
+	/* This time it fills the queue and blocks sending to it again. */
+	xSending = pdTRUE;
+	uxWakeAction = kbWAKE_SEND;
+	xTaskNotifyGive( xWakeTask );
+
+	ulCycles = 0;
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			( void ) xQueueReceive( xWakeQueue, &ucValue, 0 );
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+
+	/* Its last send completes on the next receive, and leaves an item in
+	the queue. */
+	xSending = pdFALSE;
+	( void ) xQueueReceive( xWakeQueue, &ucValue, 0 );
+	( void ) xQueueReceive( xWakeQueue, &ucValue, 0 );
+	prvReport( "receive_wake", ulCycles, kbOPERATIONS );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureDelayUntil( void )
+{
+TickType_t xLastWakeTime;
+uint16_t usSample;
+uint32_t ulCycles, ulMin = 0xffffffffUL, ulMax = 0, ulTotal = 0;
+
+	xLastWakeTime = xTaskGetTickCount();
+
+	for( usSample = 0; usSample < kbDELAY_SAMPLES; usSample++ )
+	{
+		vTaskDelayUntil( &xLastWakeTime, 1 );
+
+		/* TCNT1 restarted from 0 at the compare match that generated the
+		tick this task should have woken on. */
+		ulCycles = ( uint32_t ) TCNT1 * ( uint32_t ) usPrescaler;
+		ulTotal += ulCycles;
+
+		if( ulCycles < ulMin )
+		{
+			ulMin = ulCycles;
+		}
+
+		if( ulCycles > ulMax )
+		{
+			ulMax = ulCycles;
+		}
+	}
+
+	vSerialPutValue( xPort, "KERN delay_until n=", kbDELAY_SAMPLES, kbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " cycles=", ulTotal / kbDELAY_SAMPLES, kbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " min=", ulMin, kbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " max=", ulMax, kbTX_BLOCK_TIME );
+	prvSendString( "\r\n" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasurePollQ( void )
+{
+uint32_t ulCycles;
+
+	ulErrors = 0;
+	ulCycles = prvPollQRounds( kbPOLLQ_VALUES, pdFALSE );
+	prvReportThroughput( "pollq", ulCycles, kbOPERATIONS * ( uint32_t ) kbPOLLQ_VALUES );
+
+	ulErrors = 0;
+	ulCycles = prvPollQRounds( kbPOLLQ_VALUES, pdTRUE );
+	prvReportThroughput( "pollq_multiple", ulCycles, kbOPERATIONS * ( uint32_t ) kbPOLLQ_VALUES );
+
+	ulErrors = 0;
+	ulCycles = prvPollQRounds( kbPOLLQ_LENGTH, pdFALSE );
+	prvReportThroughput( "pollq_full", ulCycles, kbOPERATIONS * ( uint32_t ) kbPOLLQ_LENGTH );
+
+	ulErrors = 0;
+	ulCycles = prvPollQRounds( kbPOLLQ_LENGTH, pdTRUE );
+	prvReportThroughput( "pollq_full_multiple", ulCycles, kbOPERATIONS * ( uint32_t ) kbPOLLQ_LENGTH );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvPollQRounds( UBaseType_t uxValues, BaseType_t xMultiple )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch, ux, uxValue, uxReceived;
+uint32_t ulCycles = 0;
+uint16_t usValues[ kbPOLLQ_LENGTH ];
+
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			/* The producer's round... */
+			if( xMultiple == pdFALSE )
+			{
+				for( uxValue = 0; uxValue < uxValues; uxValue++ )
+				{
+					( void ) xQueueSend( xPollQueue, &usPollQSend, 0 );
+					usPollQSend++;
+				}
+			}
+			else
+			{
+				for( uxValue = 0; uxValue < uxValues; uxValue++ )
+				{
+					usValues[ uxValue ] = usPollQSend;
+					usPollQSend++;
+				}
+				( void ) xQueueSendMultiple( xPollQueue, usValues, uxValues, 0 );
+			}
+
+			/* ...and the consumer's. */
+			if( xMultiple == pdFALSE )
+			{
+				uxReceived = 0;
+				while( uxQueueMessagesWaiting( xPollQueue ) != ( UBaseType_t ) 0 )
+				{
+					( void ) xQueueReceive( xPollQueue, &( usValues[ uxReceived ] ), 0 );
+					uxReceived++;
+				}
+			}
+			else
+			{
+				uxReceived = xQueueReceiveMultiple( xPollQueue, usValues, kbPOLLQ_LENGTH, 0 );
+			}
+
+			for( uxValue = 0; uxValue < uxReceived; uxValue++ )
+			{
+				if( usValues[ uxValue ] != usPollQReceive )
+				{
+					ulErrors++;
+					usPollQReceive = usValues[ uxValue ];
+				}
+				usPollQReceive++;
+			}
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+
+	return ulCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureRecords( void )
+{
+uint32_t ulCycles;
+
+	ulErrors = 0;
+	ulCycles = prvRecordRounds( pdFALSE, pdFALSE );
+	prvReportThroughput( "record", ulCycles, kbOPERATIONS );
+
+	ulErrors = 0;
+	ulCycles = prvRecordRounds( pdTRUE, pdFALSE );
+	prvReportThroughput( "record_slot", ulCycles, kbOPERATIONS );
+
+	ulErrors = 0;
+	ulCycles = prvRecordRounds( pdFALSE, pdTRUE );
+	prvReportThroughput( "record_isr", ulCycles, kbOPERATIONS );
+
+	ulErrors = 0;
+	ulCycles = prvRecordRounds( pdTRUE, pdTRUE );
+	prvReportThroughput( "record_slot_isr", ulCycles, kbOPERATIONS );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRecordRounds( BaseType_t xInPlace, BaseType_t xFromISR )
+{
+KernelBenchTime_t xStart;
+UBaseType_t uxBatch, ux;
+uint32_t ulCycles = 0;
+uint8_t ucSequence = 0;
+uint8_t *pucSlot;
+BaseType_t xWoken = pdFALSE;
+
+	for( uxBatch = 0; uxBatch < kbBATCHES; uxBatch++ )
+	{
+		prvGetTime( &xStart );
+		for( ux = 0; ux < kbBATCH; ux++ )
+		{
+			if( xFromISR == pdFALSE )
+			{
+				if( xInPlace == pdFALSE )
+				{
+					prvFillRecord( ucRecordOut, ucSequence );
+					( void ) xQueueSend( xRecordQueue, ucRecordOut, 0 );
+					( void ) xQueueReceive( xRecordQueue, ucRecordIn, 0 );
+					prvCheckRecord( ucRecordIn, ucSequence );
+				}
+				else
+				{
+					/* The queue holds at most one record, so neither call
+					returns NULL. */
+					pucSlot = ( uint8_t * ) pvQueueAcquireSlot( xRecordQueue, 0 );
+					prvFillRecord( pucSlot, ucSequence );
+					vQueueCommitSlot( xRecordQueue );
+
+					pucSlot = ( uint8_t * ) pvQueueBorrowSlot( xRecordQueue, 0 );
+					prvCheckRecord( pucSlot, ucSequence );
+					vQueueReleaseSlot( xRecordQueue );
+				}
+			}
+			else
+			{
+				portENTER_CRITICAL();
+				{
+					if( xInPlace == pdFALSE )
+					{
+						prvFillRecord( ucRecordOut, ucSequence );
+						( void ) xQueueSendFromISR( xRecordQueue, ucRecordOut, &xWoken );
+						( void ) xQueueReceiveFromISR( xRecordQueue, ucRecordIn, &xWoken );
+						prvCheckRecord( ucRecordIn, ucSequence );
+					}
+					else
+					{
+						pucSlot = ( uint8_t * ) pvQueueAcquireSlotFromISR( xRecordQueue );
+						prvFillRecord( pucSlot, ucSequence );
+						vQueueCommitSlotFromISR( xRecordQueue, &xWoken );
+
+						pucSlot = ( uint8_t * ) pvQueueBorrowSlotFromISR( xRecordQueue );
+						prvCheckRecord( pucSlot, ucSequence );
+						vQueueReleaseSlotFromISR( xRecordQueue, &xWoken );
+					}
+				}
+				portEXIT_CRITICAL();
+			}
+
+			ucSequence++;
+		}
+		ulCycles += prvCyclesSince( &xStart );
+	}
+
+	return ulCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckHeldSlots( void )
+{
+uint8_t *pucSlot;
+uint8_t ucSequence;
+
+	ulErrors = 0;
+
+	/* The queue is empty, so there is a slot to acquire.  The woken task
+	preempts this one to post record 1 behind it, and has to block. */
+	pucSlot = ( uint8_t * ) pvQueueAcquireSlot( xRecordQueue, 0 );
+	if( pucSlot != NULL )
+	{
+		ucWakeSequence = 1;
+		uxWakeAction = kbWAKE_SEND_RECORD;
+		xTaskNotifyGive( xWakeTask );
+
+		if( uxQueueMessagesWaiting( xRecordQueue ) != ( UBaseType_t ) 0 )
+		{
+			ulErrors++;
+		}
+
+		/* Committing the slot lets record 1 in after record 0. */
+		prvFillRecord( pucSlot, 0 );
+		vQueueCommitSlot( xRecordQueue );
+
+		for( ucSequence = 0; ucSequence < 2; ucSequence++ )
+		{
+			if( xQueueReceive( xRecordQueue, ucRecordIn, 0 ) == pdPASS )
+			{
+				prvCheckRecord( ucRecordIn, ucSequence );
+			}
+			else
+			{
+				ulErrors++;
+			}
+		}
+	}
+	else
+	{
+		ulErrors++;
+	}
+
+	/* Borrow record 2, while the woken task tries to post record 3 to the
+	front of the queue, so it is received next. */
+	prvFillRecord( ucRecordOut, 2 );
+	( void ) xQueueSend( xRecordQueue, ucRecordOut, 0 );
+	pucSlot = ( uint8_t * ) pvQueueBorrowSlot( xRecordQueue, 0 );
+	if( pucSlot != NULL )
+	{
+		ucWakeSequence = 3;
+		uxWakeAction = kbWAKE_SEND_RECORD_FRONT;
+		xTaskNotifyGive( xWakeTask );
+
+		if( uxQueueMessagesWaiting( xRecordQueue ) != ( UBaseType_t ) 1 )
+		{
+			ulErrors++;
+		}
+
+		/* Releasing record 2 lets record 3 in. */
+		prvCheckRecord( pucSlot, 2 );
+		vQueueReleaseSlot( xRecordQueue );
+
+		if( xQueueReceive( xRecordQueue, ucRecordIn, 0 ) == pdPASS )
+		{
+			prvCheckRecord( ucRecordIn, 3 );
+		}
+		else
+		{
+			ulErrors++;
+		}
+	}
+	else
+	{
+		ulErrors++;
+	}
+
+	/* Leave the queue empty for the next round. */
+	while( xQueueReceive( xRecordQueue, ucRecordIn, 0 ) == pdPASS )
+	{
+		ulErrors++;
+	}
+
+	vSerialPutValue( xPort, "KERN slot_held errors=", ulErrors, kbTX_BLOCK_TIME );
+	prvSendString( "\r\n" );
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillRecord( uint8_t *pucRecord, uint8_t ucSequence )
+{
+UBaseType_t ux;
+
+	for( ux = 0; ux < kbRECORD_SIZE; ux++ )
+	{
+		pucRecord[ ux ] = ( uint8_t ) ( ucSequence + ( uint8_t ) ux );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckRecord( const uint8_t *pucRecord, uint8_t ucSequence )
+{
+UBaseType_t ux;
+uint8_t ucSum = 0, ucExpected = 0;
+
+	for( ux = 0; ux < kbRECORD_SIZE; ux++ )
+	{
+		ucSum += pucRecord[ ux ];
+		ucExpected += ( uint8_t ) ( ucSequence + ( uint8_t ) ux );
+	}
+
+	if( ( ucSum != ucExpected ) || ( pucRecord[ 0 ] != ucSequence ) )
+	{
+		ulErrors++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vKernelBenchYieldTask, pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		/* Without INCLUDE_vTaskSuspend the wait can time out, in which case
+		xYielding is still pdFALSE. */
+		( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		while( xYielding != pdFALSE )
+		{
+			taskYIELD();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vKernelBenchWakeTask, pvParameters )
+{
+uint8_t ucValue;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if( ulTaskNotifyTake( pdTRUE, portMAX_DELAY ) == 0 )
+		{
+			continue;
+		}
+
+		if( uxWakeAction == kbWAKE_RECEIVE )
+		{
+			do
+			{
+				ucValue = 0;
+				( void ) xQueueReceive( xWakeQueue, &ucValue, portMAX_DELAY );
+			} while( ucValue != kbSTOP_VALUE );
+		}
+		else if( uxWakeAction == kbWAKE_SEND )
+		{
+			ucValue = kbQUEUE_VALUE;
+			while( xSending != pdFALSE )
+			{
+				( void ) xQueueSend( xWakeQueue, &ucValue, portMAX_DELAY );
+			}
+		}
+		else
+		{
+			/* Blocks until the slot the measuring task holds is given
+			back. */
+			prvFillRecord( ucWakeRecord, ucWakeSequence );
+			( void ) xQueueGenericSend( xRecordQueue, ucWakeRecord, portMAX_DELAY, ( uxWakeAction == kbWAKE_SEND_RECORD ) ? queueSEND_TO_BACK : queueSEND_TO_FRONT );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetTime( KernelBenchTime_t *pxTime )
+{
+	/* Read again if a tick came in between, as TCNT1 would then belong to
+	the next tick. */
+	do
+	{
+		pxTime->xTick = xTaskGetTickCount();
+		pxTime->usCount = TCNT1;
+		pxTime->usCycles = TCNT3;
+	} while( pxTime->xTick != xTaskGetTickCount() );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvCyclesSince( const KernelBenchTime_t *pxStart )
+{
+KernelBenchTime_t xNow;
+uint32_t ulCounts, ulCycles;
+
+	prvGetTime( &xNow );
+
+	ulCounts = ( ( uint32_t ) ( TickType_t ) ( xNow.xTick - pxStart->xTick ) * ulCountsPerTick ) + xNow.usCount;
+	ulCounts -= pxStart->usCount;
+	ulCycles = ulCounts * ( uint32_t ) usPrescaler;
+
+	/* Timer 1 can be out by a count either way, so TCNT3 cannot have wrapped
+	if timer 1 shows less than a wrap less two counts. */
+	if( ulCycles < ( 0x10000UL - ( 2UL * ( uint32_t ) usPrescaler ) ) )
+	{
+		ulCycles = ( uint32_t ) ( uint16_t ) ( xNow.usCycles - pxStart->usCycles );
+	}
+
+	return ulCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, uint32_t ulCycles, uint32_t ulOperations )
+{
+	if( ulCycles > ulOverhead )
+	{
+		ulCycles -= ulOverhead;
+	}
+	else
+	{
+		ulCycles = 0;
+	}
+
+	prvSendString( "KERN " );
+	prvSendString( pcName );
+	vSerialPutValue( xPort, " n=", ulOperations, kbTX_BLOCK_TIME );
+	prvSendCycles( ulCycles, ulOperations );
+	prvSendString( "\r\n" );
+
+	/* Let the line go, so the serial interrupts are out of the way of the
+	next measurement. */
+	vTaskDelay( kbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReportThroughput( const char *pcName, uint32_t ulCycles, uint32_t ulOperations )
+{
+	if( ulCycles > ulOverhead )
+	{
+		ulCycles -= ulOverhead;
+	}
+	else
+	{
+		ulCycles = 0;
+	}
+
+	prvSendString( "KERN " );
+	prvSendString( pcName );
+	vSerialPutValue( xPort, " n=", ulOperations, kbTX_BLOCK_TIME );
+	prvSendCycles( ulCycles, ulOperations );
+
+	/* Per second, counting in 64 cycle steps (one count of timer 1) so the
+	product stays within 32 bits. */
+	ulCycles /= 64UL;
+	if( ulCycles != 0UL )
+	{
+		vSerialPutValue( xPort, " ops/s=", ( ( configCPU_CLOCK_HZ / 64UL ) * ulOperations ) / ulCycles, kbTX_BLOCK_TIME );
+	}
+	vSerialPutValue( xPort, " errors=", ulErrors, kbTX_BLOCK_TIME );
+	prvSendString( "\r\n" );
+
+	vTaskDelay( kbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), kbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendCycles( uint32_t ulCycles, uint32_t ulOperations )
+{
+uint32_t ulWhole, ulHundredths;
+
+	/* The remainder is below ulOperations, so times 100 stays in 32 bits. */
+	ulWhole = ulCycles / ulOperations;
+	ulHundredths = ( ( ( ulCycles % ulOperations ) * 100UL ) + ( ulOperations / 2UL ) ) / ulOperations;
+	if( ulHundredths == 100UL )
+	{
+		ulWhole++;
+		ulHundredths = 0UL;
+	}
+
+	vSerialPutValue( xPort, " cycles=", ulWhole, kbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, ".", ulHundredths / 10UL, kbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, "", ulHundredths % 10UL, kbTX_BLOCK_TIME );
+}
@@ -70,8 +70,107 @@
 #ifndef SERIAL_COMMS_H
 #define SERIAL_COMMS_H
 
+/* Set to 0 to buffer characters in queues rather than in the byte rings of
+serial.c. */
+#ifndef serUSE_RING_BUFFERS
+	#define serUSE_RING_BUFFERS			1
+#endif
+
+/* Set to 1 to let a port decode COBS frames in its Rx ISR (see
+xSerialEnableFrames() in serial.c).  Frames longer than serMAX_FRAME_LENGTH
+bytes, once decoded, are dropped. */
+#ifndef serUSE_COBS_FRAMES
+	#define serUSE_COBS_FRAMES			0
+#endif
+
+#ifndef serMAX_FRAME_LENGTH
+	#define serMAX_FRAME_LENGTH			128
+#endif
+
+/* Set to 1 to build in the RTS/CTS and XON/XOFF flow control of serial.c (see
+xSerialSetFlowControl()). */
+#ifndef serUSE_FLOW_CONTROL
+	#define serUSE_FLOW_CONTROL			0
+#endif
+
+/* Set to 0 to leave out the per port counters read by vSerialGetStats(). */
+#ifndef serUSE_STATS
+	#define serUSE_STATS				1
+#endif
+
 typedef void * xComPortHandle;
 
+/*
+ * The baud rate settings serial.c picks for ulBaud from a clock of ulClock Hz,
+ * as constant expressions.  Both the normal (16 samples per bit) and double
+ * speed (8 samples, U2Xn = 1) modes are tried with UBRRn + 1 rounded down and
+ * up, and the one that gives the rate nearest ulBaud is used, normal speed on
+ * a tie.  For example serBAUD_ERROR( 16000000UL, 57600UL ) is 79 (0.79%).
+ * They can be used in #if as long as both arguments are plain numbers, and
+ * are worked out in 64 bits, so are best kept to constant arguments.
+ */
+#define serBAUD_MAX_DIVISOR			4096ULL
+
+#define serBAUD_DIFF( ullA, ullB )	( ( ( ullA ) > ( ullB ) ) ? ( ( ullA ) - ( ullB ) ) : ( ( ullB ) - ( ullA ) ) )
+
+/* UBRRn + 1 rounded down, kept where it and the one above are valid. */
+#define serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples )											\
+	( ( ( 1ULL * ( ulClock ) ) < ( 1ULL * ( ulSamples ) * ( ulBaud ) ) ) ? 1ULL :					\
+	  ( ( ( 1ULL * ( ulClock ) ) / ( 1ULL * ( ulSamples ) * ( ulBaud ) ) ) >= serBAUD_MAX_DIVISOR ) ?	\
+		( serBAUD_MAX_DIVISOR - 1ULL ) : ( ( 1ULL * ( ulClock ) ) / ( 1ULL * ( ulSamples ) * ( ulBaud ) ) ) )
+
+/* The rate error of a divisor, times ulSamples * ulDivisor. */
+#define serBAUD_CLOCK_ERROR( ulClock, ulBaud, ulSamples, ulDivisor )		\
+	serBAUD_DIFF( 1ULL * ( ulClock ), 1ULL * ( ulSamples ) * ( ulBaud ) * ( ulDivisor ) )
+
+/* The divisor rounded down or up, whichever is nearer ulBaud (down on a tie). */
+#define serBAUD_DIVISOR( ulClock, ulBaud, ulSamples )																	\
+	( ( ( serBAUD_CLOCK_ERROR( ulClock, ulBaud, ulSamples, serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) ) *			\
+		  ( serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) + 1ULL ) ) <=												\
+		( serBAUD_CLOCK_ERROR( ulClock, ulBaud, ulSamples, serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) + 1ULL ) *	\
+		  serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) ) ) ?															\
+	  serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) : ( serBAUD_LOW_DIVISOR( ulClock, ulBaud, ulSamples ) + 1ULL ) )
+
+/* 1 if double speed gets nearer ulBaud than normal speed. */
+#define serBAUD_DOUBLE_SPEED( ulClock, ulBaud )																			\
+	( ( ( serBAUD_CLOCK_ERROR( ulClock, ulBaud, 8ULL, serBAUD_DIVISOR( ulClock, ulBaud, 8ULL ) ) * 2ULL *				\
+		  serBAUD_DIVISOR( ulClock, ulBaud, 16ULL ) ) <																		\
+		( serBAUD_CLOCK_ERROR( ulClock, ulBaud, 16ULL, serBAUD_DIVISOR( ulClock, ulBaud, 16ULL ) ) *						\
+		  serBAUD_DIVISOR( ulClock, ulBaud, 8ULL ) ) ) ? 1ULL : 0ULL )
+
+/* The rate a divisor gives, rounded, and its error in hundredths of a
+percent. */
+#define serBAUD_RATE_FOR( ulClock, ulSamples, ulDivisor )										\
+	( ( ( 1ULL * ( ulClock ) ) + ( ( 1ULL * ( ulSamples ) * ( ulDivisor ) ) / 2ULL ) ) / ( 1ULL * ( ulSamples ) * ( ulDivisor ) ) )
+
+#define serBAUD_ERROR_FOR( ulClock, ulBaud, ulSamples, ulDivisor )								\
+	( ( serBAUD_CLOCK_ERROR( ulClock, ulBaud, ulSamples, ulDivisor ) * 10000ULL ) / ( 1ULL * ( ulSamples ) * ( ulDivisor ) * ( ulBaud ) ) )
+
+/* The UBRRn value, the baud rate it gives and its error in hundredths of a
+percent (not signed). */
+#define serBAUD_UBRR( ulClock, ulBaud )													\
+	( serBAUD_DOUBLE_SPEED( ulClock, ulBaud ) ? ( serBAUD_DIVISOR( ulClock, ulBaud, 8ULL ) - 1ULL ) :	\
+												( serBAUD_DIVISOR( ulClock, ulBaud, 16ULL ) - 1ULL ) )
+
+#define serBAUD_ACTUAL( ulClock, ulBaud )														\
+	( serBAUD_DOUBLE_SPEED( ulClock, ulBaud ) ?													\
+		serBAUD_RATE_FOR( ulClock, 8ULL, serBAUD_DIVISOR( ulClock, ulBaud, 8ULL ) ) :			\
+		serBAUD_RATE_FOR( ulClock, 16ULL, serBAUD_DIVISOR( ulClock, ulBaud, 16ULL ) ) )
+
+#define serBAUD_ERROR( ulClock, ulBaud )														\
+	( serBAUD_DOUBLE_SPEED( ulClock, ulBaud ) ?													\
+		serBAUD_ERROR_FOR( ulClock, ulBaud, 8ULL, serBAUD_DIVISOR( ulClock, ulBaud, 8ULL ) ) :	\
+		serBAUD_ERROR_FOR( ulClock, ulBaud, 16ULL, serBAUD_DIVISOR( ulClock, ulBaud, 16ULL ) ) )
+
+/* The same settings worked out at run time by vSerialSolveBaud(). */
+typedef struct SERIAL_BAUD
+{
+	uint16_t usUBRR;
+	uint8_t ucDoubleSpeed;		/* U2Xn. */
+	uint32_t ulBaud;			/* The baud rate achieved. */
+	int16_t sError;				/* ( ulBaud - wanted ) in hundredths of a percent. */
+} SerialBaud_t;
+
 typedef enum
 { 
 	serCOM1, 
@@ -128,12 +227,47 @@ typedef enum
 	ser115200
 } eBaud;
 
+typedef enum
+{
+	serFLOW_NONE,
+	serFLOW_RTS_CTS,
+	serFLOW_XON_XOFF
+} eFlowControl;
+
+/* Counted for each port since it was opened or the counters were reset. */
+typedef struct SERIAL_STATS
+{
+	uint32_t ulFrameErrors;		/* Characters received with a framing error. */
+	uint32_t ulOverruns;		/* Characters lost because the Rx ISR ran too late. */
+	uint32_t ulParityErrors;	/* Characters received with a parity error. */
+	uint32_t ulRxDropped;		/* Characters lost because the Rx buffer was full. */
+	uint32_t ulFramesDropped;	/* COBS frames dropped. */
+	uint32_t ulTxStalls;		/* Writes that found the Tx buffer full. */
+	UBaseType_t uxRxPeak;		/* Most characters held in the Rx buffer. */
+	UBaseType_t uxTxPeak;		/* Most characters held in the Tx buffer. */
+} SerialStats_t;
+
 xComPortHandle xSerialPortInitMinimal( unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength );
+xComPortHandle xSerialPortInitUSART( eCOMPort ePort, unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength );
 xComPortHandle xSerialPortInit( eCOMPort ePort, eBaud eWantedBaud, eParity eWantedParity, eDataBits eWantedDataBits, eStopBits eWantedStopBits, unsigned portBASE_TYPE uxBufferLength );
 void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength );
+signed portBASE_TYPE xSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength, TickType_t xBlockTime );
+void vSerialPutValue( xComPortHandle pxPort, const char *pcName, uint32_t ulValue, TickType_t xBlockTime );
+unsigned short usSerialRead( xComPortHandle pxPort, signed char *pcBuffer, unsigned short usMaxLength, TickType_t xBlockTime );
 signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedChar, TickType_t xBlockTime );
 signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort, signed char cOutChar, TickType_t xBlockTime );
 portBASE_TYPE xSerialWaitForSemaphore( xComPortHandle xPort );
+signed portBASE_TYPE xSerialEnableFrames( xComPortHandle pxPort );
+const uint8_t *pucSerialGetFrame( xComPortHandle pxPort, unsigned short *pusLength, TickType_t xBlockTime );
+void vSerialReleaseFrame( xComPortHandle pxPort );
+void vSerialSetFlowPins( xComPortHandle pxPort, volatile uint8_t *pucRTSPort, uint8_t ucRTSMask, volatile uint8_t *pucCTSPin, uint8_t ucCTSMask );
+signed portBASE_TYPE xSerialSetFlowControl( xComPortHandle pxPort, eFlowControl eFlow, UBaseType_t uxLowWater, UBaseType_t uxHighWater );
+void vSerialCheckCTS( xComPortHandle pxPort );
+void vSerialSolveBaud( uint32_t ulClockHz, uint32_t ulWantedBaud, SerialBaud_t *pxBaud );
+void vSerialGetBaud( xComPortHandle pxPort, SerialBaud_t *pxBaud );
+void vSerialGetStats( xComPortHandle pxPort, SerialStats_t *pxStats );
+void vSerialResetStats( xComPortHandle pxPort );
+void vSerialPutStats( xComPortHandle pxOutPort, xComPortHandle pxPort );
 void vSerialClose( xComPortHandle xPort );
 
 #endif
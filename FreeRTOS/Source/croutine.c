@@ -139,62 +139,101 @@ static void prvCheckPendingReadyList( void );
  */
 static void prvCheckDelayedList( void );
 
+/*
+ * Fills in a co-routine control block, allocated or static, and adds the
+ * co-routine to the ready list.
+ */
+static void prvInitialiseNewCoRoutine( CRCB_t *pxCoRoutine, crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex );
+
 /*-----------------------------------------------------------*/
 
-BaseType_t xCoRoutineCreate( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex )
-{
-BaseType_t xReturn;
-CRCB_t *pxCoRoutine;
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
 
-	/* Allocate the memory that will store the co-routine control block. */
-	pxCoRoutine = ( CRCB_t * ) pvPortMalloc( sizeof( CRCB_t ) );
-	if( pxCoRoutine )
+	BaseType_t xCoRoutineCreate( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex )
 	{
-		/* If pxCurrentCoRoutine is NULL then this is the first co-routine to
-		be created and the co-routine data structures need initialising. */
-		if( pxCurrentCoRoutine == NULL )
+	BaseType_t xReturn;
+	CRCB_t *pxCoRoutine;
+
+		/* Allocate the memory that will store the co-routine control block. */
+		pxCoRoutine = ( CRCB_t * ) pvPortMalloc( sizeof( CRCB_t ) );
+		if( pxCoRoutine )
 		{
-			pxCurrentCoRoutine = pxCoRoutine;
-			prvInitialiseCoRoutineLists();
+			prvInitialiseNewCoRoutine( pxCoRoutine, pxCoRoutineCode, uxPriority, uxIndex );
+			xReturn = pdPASS;
 		}
-
-		/* Check the priority is within limits. */
-		if( uxPriority >= configMAX_CO_ROUTINE_PRIORITIES )
+		else
 		{
-			uxPriority = configMAX_CO_ROUTINE_PRIORITIES - 1;
+			xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
 		}
 
-		/* Fill out the co-routine control block from the function parameters. */
-		pxCoRoutine->uxState = corINITIAL_STATE;
-		pxCoRoutine->uxPriority = uxPriority;
-		pxCoRoutine->uxIndex = uxIndex;
-		pxCoRoutine->pxCoRoutineFunction = pxCoRoutineCode;
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+/*-----------------------------------------------------------*/
 
-		/* Initialise all the other co-routine control block parameters. */
-		vListInitialiseItem( &( pxCoRoutine->xGenericListItem ) );
-		vListInitialiseItem( &( pxCoRoutine->xEventListItem ) );
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 
-		/* Set the co-routine control block as a link back from the ListItem_t.
-		This is so we can get back to the containing CRCB from a generic item
-		in a list. */
-		listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xGenericListItem ), pxCoRoutine );
-		listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xEventListItem ), pxCoRoutine );
+	BaseType_t xCoRoutineCreateStatic( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex, StaticCoRoutine_t *pxCoRoutineBuffer )
+	{
+	BaseType_t xReturn;
+
+		configASSERT( pxCoRoutineBuffer != NULL );
+
+		if( pxCoRoutineBuffer != NULL )
+		{
+			prvInitialiseNewCoRoutine( pxCoRoutineBuffer, pxCoRoutineCode, uxPriority, uxIndex );
+			xReturn = pdPASS;
+		}
+		else
+		{
+			xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		}
 
-		/* Event lists are always in priority order. */
-		listSET_LIST_ITEM_VALUE( &( pxCoRoutine->xEventListItem ), ( ( TickType_t ) configMAX_CO_ROUTINE_PRIORITIES - ( TickType_t ) uxPriority ) );
+		return xReturn;
+	}
 
-		/* Now the co-routine has been initialised it can be added to the ready
-		list at the correct priority. */
-		prvAddCoRoutineToReadyQueue( pxCoRoutine );
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
 
-		xReturn = pdPASS;
+static void prvInitialiseNewCoRoutine( CRCB_t *pxCoRoutine, crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex )
+{
+	/* If pxCurrentCoRoutine is NULL then this is the first co-routine to
+	be created and the co-routine data structures need initialising. */
+	if( pxCurrentCoRoutine == NULL )
+	{
+		pxCurrentCoRoutine = pxCoRoutine;
+		prvInitialiseCoRoutineLists();
 	}
-	else
+
+	/* Check the priority is within limits. */
+	if( uxPriority >= configMAX_CO_ROUTINE_PRIORITIES )
 	{
-		xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		uxPriority = configMAX_CO_ROUTINE_PRIORITIES - 1;
 	}
 
-	return xReturn;
+	/* Fill out the co-routine control block from the function parameters. */
+	pxCoRoutine->uxState = corINITIAL_STATE;
+	pxCoRoutine->uxPriority = uxPriority;
+	pxCoRoutine->uxIndex = uxIndex;
+	pxCoRoutine->pxCoRoutineFunction = pxCoRoutineCode;
+
+	/* Initialise all the other co-routine control block parameters. */
+	vListInitialiseItem( &( pxCoRoutine->xGenericListItem ) );
+	vListInitialiseItem( &( pxCoRoutine->xEventListItem ) );
+
+	/* Set the co-routine control block as a link back from the ListItem_t.
+	This is so we can get back to the containing CRCB from a generic item
+	in a list. */
+	listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xGenericListItem ), pxCoRoutine );
+	listSET_LIST_ITEM_OWNER( &( pxCoRoutine->xEventListItem ), pxCoRoutine );
+
+	/* Event lists are always in priority order. */
+	listSET_LIST_ITEM_VALUE( &( pxCoRoutine->xEventListItem ), ( ( TickType_t ) configMAX_CO_ROUTINE_PRIORITIES - ( TickType_t ) uxPriority ) );
+
+	/* Now the co-routine has been initialised it can be added to the ready
+	list at the correct priority. */
+	prvAddCoRoutineToReadyQueue( pxCoRoutine );
 }
 /*-----------------------------------------------------------*/
 
@@ -728,6 +728,34 @@ extern "C" {
 	#define configUSE_TIME_SLICING 1
 #endif
 
+#ifndef configUSE_TIMING_WHEEL
+	#define configUSE_TIMING_WHEEL 0
+#endif
+
+#ifndef configTIMING_WHEEL_BITS
+	#define configTIMING_WHEEL_BITS 4
+#endif
+
+#ifndef configUSE_COALESCING_HEAP
+	#define configUSE_COALESCING_HEAP 0
+#endif
+
+#ifndef configUSE_BLOCK_POOLS
+	#define configUSE_BLOCK_POOLS 0
+#endif
+
+#ifndef configUSE_BYTE_QUEUES
+	#define configUSE_BYTE_QUEUES 0
+#endif
+
+#ifndef configUSE_QUEUE_INDICES
+	#define configUSE_QUEUE_INDICES 0
+#endif
+
+#ifndef configUSE_QUEUE_RAM_STATS
+	#define configUSE_QUEUE_RAM_STATS 0
+#endif
+
 #ifndef configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS
 	#define configINCLUDE_APPLICATION_DEFINED_PRIVILEGED_FUNCTIONS 0
 #endif
@@ -789,6 +817,12 @@ extern "C" {
 	#endif /* INCLUDE_vTaskSuspend */
 #endif /* configUSE_TICKLESS_IDLE */
 
+#if( configUSE_TIMING_WHEEL == 1 )
+	#if( ( configTIMING_WHEEL_BITS < 1 ) || ( ( configUSE_16_BIT_TICKS == 1 ) && ( configTIMING_WHEEL_BITS > 7 ) ) || ( configTIMING_WHEEL_BITS > 15 ) )
+		#error configTIMING_WHEEL_BITS must be at least 1, and the two levels of the wheel must span less than the range of TickType_t.
+	#endif
+#endif /* configUSE_TIMING_WHEEL */
+
 #if( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
 	#error configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION cannot both be 0, but can both be 1.
 #endif
@@ -967,17 +1001,10 @@ typedef struct xSTATIC_TCB
  */
 typedef struct xSTATIC_QUEUE
 {
-	void *pvDummy1[ 3 ];
-
-	union
-	{
-		void *pvDummy2;
-		UBaseType_t uxDummy2;
-	} u;
-
+	void *pvDummy1[ 2 ];
 	StaticList_t xDummy3[ 2 ];
 	UBaseType_t uxDummy4[ 3 ];
-	uint8_t ucDummy5[ 2 ];
+	uint8_t ucDummy5[ 3 ];
 
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucDummy6;
@@ -992,9 +1019,54 @@ typedef struct xSTATIC_QUEUE
 		uint8_t ucDummy9;
 	#endif
 
+	#if( configUSE_QUEUE_INDICES == 0 )
+		void *pvDummy10;
+
+		union
+		{
+			void *pvDummy2;
+			UBaseType_t uxDummy2;
+		} u;
+	#elif( configUSE_RECURSIVE_MUTEXES == 1 )
+		UBaseType_t uxDummy2;
+	#endif
+
 } StaticQueue_t;
 typedef StaticQueue_t StaticSemaphore_t;
 
+/*
+ * A queue of 1 byte items created while configUSE_BYTE_QUEUES is 1 does not
+ * use the end of the queue structure, so can be created from the smaller
+ * StaticByteQueue_t below by xQueueCreateByteStatic().  With
+ * configUSE_QUEUE_INDICES set to 1 no queue has the end of the structure, so
+ * the two are the same.
+ */
+#if( ( configUSE_BYTE_QUEUES == 1 ) && ( configUSE_QUEUE_INDICES == 0 ) )
+	typedef struct xSTATIC_BYTE_QUEUE
+	{
+		void *pvDummy1[ 2 ];
+		StaticList_t xDummy3[ 2 ];
+		UBaseType_t uxDummy4[ 3 ];
+		uint8_t ucDummy5[ 3 ];
+
+		#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+			uint8_t ucDummy6;
+		#endif
+
+		#if ( configUSE_QUEUE_SETS == 1 )
+			void *pvDummy7;
+		#endif
+
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			UBaseType_t uxDummy8;
+			uint8_t ucDummy9;
+		#endif
+
+	} StaticByteQueue_t;
+#else
+	typedef StaticQueue_t StaticByteQueue_t;
+#endif
+
 /*
  * In line with software engineering best practice, especially when supplying a
  * library that is likely to change in future versions, FreeRTOS implements a
@@ -98,6 +98,10 @@ typedef struct corCoRoutineControlBlock
 	uint16_t 			uxState;			/*< Used internally by the co-routine implementation. */
 } CRCB_t; /* Co-routine control block.  Note must be identical in size down to uxPriority with TCB_t. */
 
+/* The control block is public, so a statically allocated co-routine uses the
+block itself as its buffer. */
+typedef CRCB_t StaticCoRoutine_t;
+
 /**
  * croutine. h
  *<pre>
@@ -172,6 +176,34 @@ typedef struct corCoRoutineControlBlock
  */
 BaseType_t xCoRoutineCreate( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex );
 
+/**
+ * croutine. h
+ *<pre>
+ BaseType_t xCoRoutineCreateStatic(
+                                 crCOROUTINE_CODE pxCoRoutineCode,
+                                 UBaseType_t uxPriority,
+                                 UBaseType_t uxIndex,
+                                 StaticCoRoutine_t *pxCoRoutineBuffer
+                               );</pre>
+ *
+ * As xCoRoutineCreate(), but the co-routine control block is provided by the
+ * application rather than allocated from the heap, so can be used when
+ * configSUPPORT_DYNAMIC_ALLOCATION is 0.  Needs
+ * configSUPPORT_STATIC_ALLOCATION set to 1.
+ *
+ * @param pxCoRoutineBuffer Must point to a StaticCoRoutine_t variable, which
+ * is used as the co-routine control block for as long as the co-routine
+ * exists.
+ *
+ * @return pdPASS if the co-routine was created and added to a ready list,
+ * otherwise errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY if pxCoRoutineBuffer is
+ * NULL.
+ *
+ * \defgroup xCoRoutineCreateStatic xCoRoutineCreateStatic
+ * \ingroup Tasks
+ */
+BaseType_t xCoRoutineCreateStatic( crCOROUTINE_CODE pxCoRoutineCode, UBaseType_t uxPriority, UBaseType_t uxIndex, StaticCoRoutine_t *pxCoRoutineBuffer );
+
 
 /**
  * croutine. h
@@ -173,6 +173,29 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetLargestFreeBlockSize( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Fixed size block pools (heap_pools.c), used by pvPortMalloc() and
+ * vPortFree() when configUSE_BLOCK_POOLS is 1.  pvPortPoolMalloc() returns
+ * NULL if the request is to go to the heap, and xPortPoolFree() pdFALSE if
+ * the block did not come from a pool.
+ */
+#if( configUSE_BLOCK_POOLS == 1 )
+	typedef struct BLOCK_POOL_STATS
+	{
+		size_t xBlockSize;
+		UBaseType_t uxBlocks;
+		UBaseType_t uxInUse;
+		UBaseType_t uxMaxInUse;			/* The most blocks ever in use at once. */
+		uint32_t ulFallbacks;			/* Requests passed on to the heap as the pool was empty. */
+	} BlockPoolStats_t;
+
+	void *pvPortPoolMalloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+	BaseType_t xPortPoolFree( void *pv ) PRIVILEGED_FUNCTION;
+	UBaseType_t uxPortGetBlockPoolCount( void ) PRIVILEGED_FUNCTION;
+	void vPortGetBlockPoolStats( UBaseType_t uxPool, BlockPoolStats_t *pxStats ) PRIVILEGED_FUNCTION;
+#endif
 
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
@@ -101,6 +101,18 @@ typedef void * QueueSetHandle_t;
  */
 typedef void * QueueSetMemberHandle_t;
 
+/**
+ * The RAM used by the queues, semaphores and mutexes that exist, as returned
+ * by vQueueGetRAMStats() when configUSE_QUEUE_RAM_STATS is set to 1.
+ */
+typedef struct xQUEUE_RAM_STATS
+{
+	UBaseType_t uxQueues;			/*< The number of queues, semaphores and mutexes. */
+	size_t xStructureBytes;			/*< The bytes of RAM used by their structures. */
+	size_t xStorageBytes;			/*< The bytes of RAM used to store their items. */
+	size_t xBytesSaved;				/*< The bytes fewer their structures need than with pointers to the read and write positions (byte queues and configUSE_QUEUE_INDICES). */
+} QueueRAMStats_t;
+
 /* For internal use only. */
 #define	queueSEND_TO_BACK		( ( BaseType_t ) 0 )
 #define	queueSEND_TO_FRONT		( ( BaseType_t ) 1 )
@@ -272,6 +284,56 @@ typedef void * QueueSetMemberHandle_t;
 	#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxQueueBuffer ), ( queueQUEUE_TYPE_BASE ) )
 #endif /* configSUPPORT_STATIC_ALLOCATION */
 
+/**
+ * queue. h
+ * <pre>
+ QueueHandle_t xQueueCreateByteStatic(
+							  UBaseType_t uxQueueLength,
+							  uint8_t *pucQueueStorageBuffer,
+							  StaticByteQueue_t *pxQueueBuffer
+						  );
+ * </pre>
+ *
+ * As xQueueCreateStatic() with an item size of 1, but the queue structure is
+ * held in a StaticByteQueue_t.  When configUSE_BYTE_QUEUES is set to 1 in
+ * FreeRTOSConfig.h a queue of 1 byte items is a byte queue, which keeps 8 bit
+ * offsets in place of the read and write pointers, so needs less RAM than a
+ * StaticQueue_t and can hold at most 255 items.  When configUSE_BYTE_QUEUES is
+ * 0 StaticByteQueue_t is the same as StaticQueue_t.
+ *
+ * @param uxQueueLength The maximum number of bytes the queue can contain.
+ *
+ * @param pucQueueStorageBuffer Must point to a uint8_t array of at least
+ * uxQueueLength bytes.
+ *
+ * @param pxQueueBuffer Must point to a variable of type StaticByteQueue_t,
+ * which will be used to hold the queue's data structure.
+ *
+ * @return As xQueueCreateStatic().
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH 32
+
+ StaticByteQueue_t xQueueBuffer;
+ uint8_t ucQueueStorage[ QUEUE_LENGTH ];
+
+ void vATask( void *pvParameters )
+ {
+ QueueHandle_t xQueue1;
+
+	xQueue1 = xQueueCreateByteStatic( QUEUE_LENGTH, &( ucQueueStorage[ 0 ] ), &xQueueBuffer );
+
+	// ... Rest of task code.
+ }
+ </pre>
+ * \defgroup xQueueCreateByteStatic xQueueCreateByteStatic
+ * \ingroup QueueManagement
+ */
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define xQueueCreateByteStatic( uxQueueLength, pucQueueStorage, pxQueueBuffer ) xQueueGenericCreateStatic( ( uxQueueLength ), ( UBaseType_t ) 1U, ( pucQueueStorage ), ( StaticQueue_t * ) ( pxQueueBuffer ), ( queueQUEUE_TYPE_BASE ) )
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 /**
  * queue. h
  * <pre>
@@ -1012,6 +1074,194 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue, void * const pvBuffer ) PRIV
  */
 BaseType_t xQueueGenericReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait, const BaseType_t xJustPeek ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueSendMultiple(
+                                 QueueHandle_t xQueue,
+                                 const void *pvItemsToQueue,
+                                 UBaseType_t uxItems,
+                                 TickType_t xTicksToWait
+                             );
+ * </pre>
+ *
+ * Post up to uxItems items, held one after the other in pvItemsToQueue, to
+ * the back of a queue.  As many as there is space for are copied in one
+ * critical section, with at most two calls to memcpy() (the second when the
+ * items wrap round the end of the queue storage), so a batch costs little
+ * more than a single xQueueSend().
+ *
+ * The call only blocks while the queue is full.  Once there is space it
+ * posts what fits and returns, so fewer than uxItems items may be posted.
+ *
+ * At most one task is woken per call: the highest priority task waiting to
+ * receive from the queue.  The call is therefore best suited to queues with
+ * a single reader, such as one using xQueueReceiveMultiple().  It cannot be
+ * used with semaphores, mutexes or queues that are members of a queue set.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItemsToQueue A pointer to the first of the items to be posted.
+ *
+ * @param uxItems The number of items at pvItemsToQueue.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it already be
+ * full.
+ *
+ * @return The number of items posted, which is 0 if the queue was full for
+ * the whole of the block time.
+ *
+ * Example usage:
+   <pre>
+ uint16_t usValues[ 3 ] = { 1, 2, 3 };
+ UBaseType_t uxSent = 0;
+
+	// Post all three values, waiting as long as it takes.
+	while( uxSent < 3 )
+	{
+		uxSent += xQueueSendMultiple( xQueue, &( usValues[ uxSent ] ), 3 - uxSent, portMAX_DELAY );
+	}
+ </pre>
+ * \defgroup xQueueSendMultiple xQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, UBaseType_t uxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t xQueueReceiveMultiple(
+                                    QueueHandle_t xQueue,
+                                    void *pvBuffer,
+                                    UBaseType_t uxMaxItems,
+                                    TickType_t xTicksToWait
+                                );
+ * </pre>
+ *
+ * Receive up to uxMaxItems items from a queue into pvBuffer, one after the
+ * other.  Everything the queue holds, up to uxMaxItems, is copied in one
+ * critical section with at most two calls to memcpy().
+ *
+ * The call only blocks while the queue is empty.  At most one task is woken
+ * per call: the highest priority task waiting to post to the queue.  It
+ * cannot be used with semaphores, mutexes or queues that are members of a
+ * queue set.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to a buffer with space for uxMaxItems items.
+ *
+ * @param uxMaxItems The most items to receive.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time of
+ * the call.
+ *
+ * @return The number of items received, which is 0 if the queue was empty
+ * for the whole of the block time.
+ *
+ * Example usage:
+   <pre>
+ uint16_t usValues[ 10 ];
+ UBaseType_t uxReceived, ux;
+
+	// Empty the queue without blocking.
+	uxReceived = xQueueReceiveMultiple( xQueue, usValues, 10, 0 );
+	for( ux = 0; ux < uxReceived; ux++ )
+	{
+		// Process usValues[ ux ].
+	}
+ </pre>
+ * \defgroup xQueueReceiveMultiple xQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueAcquireSlot( QueueHandle_t xQueue, TickType_t xTicksToWait );
+ void vQueueCommitSlot( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Post an item without copying it.  pvQueueAcquireSlot() returns a pointer
+ * to the queue storage the next item will go in, blocking while the queue is
+ * full.  The caller writes the item there and calls vQueueCommitSlot() to
+ * post it, which wakes a task waiting to receive as xQueueSend() would.
+ *
+ * The slot is reserved until it is committed: until then the queue is full
+ * to every other call that posts to it, including another
+ * pvQueueAcquireSlot(), so they block, or fail if they cannot block, and are
+ * unblocked by vQueueCommitSlot().  Items can still be received with any of
+ * the receive calls.  It cannot be used with semaphores, mutexes or queues
+ * that are members of a queue set.
+ *
+ * @param xQueue The handle to the queue on which the item is to be posted.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue, should it already be
+ * full.
+ *
+ * @return The slot to write the item to, or NULL if the queue was full for
+ * the whole of the block time, in which case vQueueCommitSlot() must not be
+ * called.
+ *
+ * Example usage:
+   <pre>
+ struct AReading *pxReading;
+
+	pxReading = ( struct AReading * ) pvQueueAcquireSlot( xQueue, portMAX_DELAY );
+	if( pxReading != NULL )
+	{
+		// Fill in the reading where it lies in the queue, then post it.
+		vReadSensor( pxReading );
+		vQueueCommitSlot( xQueue );
+	}
+ </pre>
+ * \defgroup pvQueueAcquireSlot pvQueueAcquireSlot
+ * \ingroup QueueManagement
+ */
+void *pvQueueAcquireSlot( QueueHandle_t xQueue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vQueueCommitSlot( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueBorrowSlot( QueueHandle_t xQueue, TickType_t xTicksToWait );
+ void vQueueReleaseSlot( QueueHandle_t xQueue );
+ * </pre>
+ *
+ * Receive an item without copying it.  pvQueueBorrowSlot() returns a
+ * pointer to the next item in the queue storage, blocking while the queue is
+ * empty.  The item stays in the queue, and its space cannot be reused, until
+ * the caller is done with it and calls vQueueReleaseSlot(), which wakes a
+ * task waiting to post as xQueueReceive() would.
+ *
+ * Until the item is released the queue is empty to every other call that
+ * receives or peeks from it, including another pvQueueBorrowSlot(), and full
+ * to calls that send to its front or overwrite it, so they block, or fail if
+ * they cannot block, and are unblocked by vQueueReleaseSlot().  Items can
+ * still be posted to the back with any of the send calls.  It cannot be used
+ * with semaphores, mutexes or queues that are members of a queue set.
+ *
+ * @param xQueue The handle to the queue from which the item is to be
+ * received.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time of
+ * the call.
+ *
+ * @return The item, or NULL if the queue was empty for the whole of the
+ * block time, in which case vQueueReleaseSlot() must not be called.
+ *
+ * \defgroup pvQueueBorrowSlot pvQueueBorrowSlot
+ * \ingroup QueueManagement
+ */
+void *pvQueueBorrowSlot( QueueHandle_t xQueue, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+void vQueueReleaseSlot( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue );</pre>
@@ -1058,6 +1308,24 @@ UBaseType_t uxQueueSpacesAvailable( const QueueHandle_t xQueue ) PRIVILEGED_FUNC
  */
 void vQueueDelete( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>void vQueueGetRAMStats( QueueRAMStats_t *pxStats );</pre>
+ *
+ * configUSE_QUEUE_RAM_STATS must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * Fills in pxStats with the RAM used by the queues, semaphores and mutexes
+ * that have been created and not deleted - see QueueRAMStats_t.  Queues
+ * created statically are included, and counted at the size they use.
+ *
+ * @param pxStats The structure to fill in.
+ *
+ * \defgroup vQueueGetRAMStats vQueueGetRAMStats
+ * \ingroup QueueManagement
+ */
+void vQueueGetRAMStats( QueueRAMStats_t *pxStats ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>
@@ -1529,6 +1797,32 @@ BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherP
  */
 BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue, void * const pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ void *pvQueueAcquireSlotFromISR( QueueHandle_t xQueue );
+ void vQueueCommitSlotFromISR( QueueHandle_t xQueue, BaseType_t *pxHigherPriorityTaskWoken );
+ void *pvQueueBorrowSlotFromISR( QueueHandle_t xQueue );
+ void vQueueReleaseSlotFromISR( QueueHandle_t xQueue, BaseType_t *pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * Versions of pvQueueAcquireSlot(), vQueueCommitSlot(), pvQueueBorrowSlot()
+ * and vQueueReleaseSlot() that can be used in an interrupt service routine.
+ * The acquire and borrow calls return NULL straight away if the queue is full
+ * or empty, or a slot is already acquired or an item already borrowed.  The
+ * commit and release calls set *pxHigherPriorityTaskWoken to pdTRUE if they
+ * unblock a task of higher priority than the one interrupted, as
+ * xQueueSendFromISR() and xQueueReceiveFromISR() do.  A slot acquired or
+ * borrowed in an interrupt should be committed or released before it returns.
+ *
+ * \defgroup pvQueueAcquireSlotFromISR pvQueueAcquireSlotFromISR
+ * \ingroup QueueManagement
+ */
+void *pvQueueAcquireSlotFromISR( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+void vQueueCommitSlotFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+void *pvQueueBorrowSlotFromISR( QueueHandle_t xQueue ) PRIVILEGED_FUNCTION;
+void vQueueReleaseSlotFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from witin an ISR, or within a critical section.
@@ -0,0 +1,185 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * avr/io.h for the Posix (host simulation) port
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: GCC (Linux host)
+ *
+ * Description:
+ * 	Stands in for the avr-libc header so that the demo sources build
+ * 	unmodified on the host.  Only the registers used by the demo are
+ * 	provided.  They are plain variables that the simulated peripherals in
+ * 	avrio.c read and write on every tick.
+ *
+ */
+
+#ifndef AVR_IO_H
+#define AVR_IO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port B - the LEDs driven by ParTest.c.
+ *-----------------------------------------------------------*/
+
+extern volatile uint8_t ucAvrDDRB;
+extern volatile uint8_t ucAvrPINB;
+
+/* Writing a one to a PINB bit toggles the matching PORTB bit, so PORTB is
+accessed through a function that applies any such write first. */
+extern volatile uint8_t *pucAvrPORTB( void );
+
+#define DDRB		ucAvrDDRB
+#define PINB		ucAvrPINB
+#define PORTB		( *pucAvrPORTB() )
+
+/*-----------------------------------------------------------
+ * USART0 to USART3.
+ *-----------------------------------------------------------*/
+
+#define avrNUM_USARTS		4
+
+/* UDRn is wider than the hardware register so the simulation can tell
+whether the UDRE interrupt wrote a character. */
+typedef struct AVR_USART
+{
+	volatile uint8_t ucUCSRA;
+	volatile uint8_t ucUCSRB;
+	volatile uint8_t ucUCSRC;
+	volatile uint16_t usUBRR;
+	volatile uint16_t usUDR;
+} AvrUsart_t;
+
+extern AvrUsart_t xAvrUSART[ avrNUM_USARTS ];
+
+#define UCSR0A		xAvrUSART[ 0 ].ucUCSRA
+#define UCSR0B		xAvrUSART[ 0 ].ucUCSRB
+#define UCSR0C		xAvrUSART[ 0 ].ucUCSRC
+#define UBRR0		xAvrUSART[ 0 ].usUBRR
+#define UDR0		xAvrUSART[ 0 ].usUDR
+
+#define UCSR1A		xAvrUSART[ 1 ].ucUCSRA
+#define UCSR1B		xAvrUSART[ 1 ].ucUCSRB
+#define UCSR1C		xAvrUSART[ 1 ].ucUCSRC
+#define UBRR1		xAvrUSART[ 1 ].usUBRR
+#define UDR1		xAvrUSART[ 1 ].usUDR
+
+#define UCSR2A		xAvrUSART[ 2 ].ucUCSRA
+#define UCSR2B		xAvrUSART[ 2 ].ucUCSRB
+#define UCSR2C		xAvrUSART[ 2 ].ucUCSRC
+#define UBRR2		xAvrUSART[ 2 ].usUBRR
+#define UDR2		xAvrUSART[ 2 ].usUDR
+
+#define UCSR3A		xAvrUSART[ 3 ].ucUCSRA
+#define UCSR3B		xAvrUSART[ 3 ].ucUCSRB
+#define UCSR3C		xAvrUSART[ 3 ].ucUCSRC
+#define UBRR3		xAvrUSART[ 3 ].usUBRR
+#define UDR3		xAvrUSART[ 3 ].usUDR
+
+/*-----------------------------------------------------------
+ * Timer 1 - the tick timer, set up as the ATmega2560 port does: clear on
+ * compare match with OCR1A, clocked at the CPU clock divided by 64.  TCNT1 is
+ * worked out from the host time since the last tick was serviced, and cannot
+ * be written.  Writes to TCCR1B and OCR1A have no effect on the tick.
+ *-----------------------------------------------------------*/
+
+extern volatile uint8_t ucAvrTCCR1B;
+extern volatile uint16_t usAvrOCR1A;
+extern uint16_t usAvrTCNT1( void );
+
+#define TCCR1B		ucAvrTCCR1B
+#define OCR1A		usAvrOCR1A
+#define TCNT1		( usAvrTCNT1() )
+
+/*-----------------------------------------------------------
+ * Timer 3 - only as a free running counter for the benchmarks.  TCNT3 is
+ * worked out from the host clock, in counts of the simulated CPU clock
+ * divided by the prescaler selected in TCCR3B, and cannot be written.
+ *-----------------------------------------------------------*/
+
+extern volatile uint8_t ucAvrTCCR3A;
+extern volatile uint8_t ucAvrTCCR3B;
+extern uint16_t usAvrTCNT3( void );
+
+#define TCCR3A		ucAvrTCCR3A
+#define TCCR3B		ucAvrTCCR3B
+#define TCNT3		( usAvrTCNT3() )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVR_IO_H */
@@ -0,0 +1,501 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * avrio.c for the Posix (host simulation) port
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: GCC (Linux host)
+ *
+ * Description:
+ * 	Simulated ATmega2560 peripherals for the demo:
+ * 	 - PORTB: the LEDs driven by ParTest.c.  Every edge on each pin is
+ * 	   counted and the pin states are printed periodically.
+ * 	 - USART0 to USART3: characters are clocked out at the rate set by
+ * 	   UBRRn and U2Xn, and looped straight back into the receiver - the
+ * 	   same as the loopback connector expected by comtest.c.  What is
+ * 	   sent on USART0 can also be captured to portSIM_USART0_CAPTURE.
+ * 	 - Timer 1: TCNT1 counts through each tick period from the host clock.
+ * 	 - Timer 3: TCNT3 counts from the host clock, for the benchmarks.
+ *
+ * 	Output is written with write() so it is safe from the tick interrupt.
+ *
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <avr/io.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "avrio.h"
+
+/* Bits in UCSRnA. */
+#define avrioRXC						( ( uint8_t ) 0x80 )
+#define avrioUDRE						( ( uint8_t ) 0x20 )
+#define avrioU2X						( ( uint8_t ) 0x02 )
+
+/* Bits in UCSRnB. */
+#define avrioRXCIE						( ( uint8_t ) 0x80 )
+#define avrioUDRIE						( ( uint8_t ) 0x20 )
+#define avrioRXEN						( ( uint8_t ) 0x10 )
+#define avrioTXEN						( ( uint8_t ) 0x08 )
+
+/* Left in UDRn before the UDRE vector is called.  An 8 bit store from the
+driver can never produce this value. */
+#define avrioUDR_EMPTY					( ( uint16_t ) 0x0100 )
+
+/* Start bit, 8 data bits and a stop bit. */
+#define avrioBITS_PER_CHAR				( ( uint32_t ) 10 )
+
+/* Baud rate * tick period needed to clock out one character. */
+#define avrioCHAR_COST					( avrioBITS_PER_CHAR * ( uint32_t ) configTICK_RATE_HZ )
+
+/* Clock select bits in TCCRnB. */
+#define avrioCLOCK_SELECT				( ( uint8_t ) 0x07 )
+
+/* Timer 1 as the ATmega2560 port sets it up for the tick: clear on compare
+match, divided by 64. */
+#define avrioTIMER1_TCCR1B				( ( uint8_t ) 0b00001011 )
+#define avrioTIMER1_PRESCALER			( 64ULL )
+#define avrioTIMER1_OCR1A				( ( uint16_t ) ( ( configCPU_CLOCK_HZ / configTICK_RATE_HZ / avrioTIMER1_PRESCALER ) - 1ULL ) )
+
+#define avrioNUM_LEDS					( 8 )
+#define avrioLINE_LENGTH				( 160 )
+
+typedef void ( *AvrVector_t )( void );
+
+/* The vectors are provided by the drivers that use the peripherals.  Weak
+references leave them NULL if a driver is not linked in. */
+extern void USART0_RX_vect( void ) __attribute__ ( ( weak ) );
+extern void USART1_RX_vect( void ) __attribute__ ( ( weak ) );
+extern void USART2_RX_vect( void ) __attribute__ ( ( weak ) );
+extern void USART3_RX_vect( void ) __attribute__ ( ( weak ) );
+extern void USART0_UDRE_vect( void ) __attribute__ ( ( weak ) );
+extern void USART1_UDRE_vect( void ) __attribute__ ( ( weak ) );
+extern void USART2_UDRE_vect( void ) __attribute__ ( ( weak ) );
+extern void USART3_UDRE_vect( void ) __attribute__ ( ( weak ) );
+
+static const AvrVector_t pxRxVectors[ avrNUM_USARTS ] = { USART0_RX_vect, USART1_RX_vect, USART2_RX_vect, USART3_RX_vect };
+static const AvrVector_t pxUdreVectors[ avrNUM_USARTS ] = { USART0_UDRE_vect, USART1_UDRE_vect, USART2_UDRE_vect, USART3_UDRE_vect };
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Count the edges on PORTB since the last call.
+ */
+static void prvCountEdges( void );
+
+/*
+ * Clock one tick worth of characters through a USART.
+ */
+static void prvUsartTick( UBaseType_t uxUsart );
+
+/*
+ * Deliver a character to the receiver of a USART.
+ */
+static void prvUsartReceive( UBaseType_t uxUsart, uint8_t ucChar );
+
+/*
+ * Append a character sent on USART0 to the capture file.
+ */
+static void prvCapture( uint8_t ucChar );
+
+/*
+ * Print the LED states and USART0 character counts.
+ */
+static void prvPrintStatus( uint64_t ullTick );
+
+/*
+ * write() a formatted line to stdout.
+ */
+static void prvPrint( const char *pcLine, int iLength );
+
+/*-----------------------------------------------------------*/
+
+volatile uint8_t ucAvrDDRB = 0;
+volatile uint8_t ucAvrPINB = 0;
+AvrUsart_t xAvrUSART[ avrNUM_USARTS ];
+volatile uint8_t ucAvrTCCR1B = avrioTIMER1_TCCR1B;
+volatile uint16_t usAvrOCR1A = avrioTIMER1_OCR1A;
+volatile uint8_t ucAvrTCCR3A = 0;
+volatile uint8_t ucAvrTCCR3B = 0;
+
+static volatile uint8_t ucAvrPORTB = 0;
+static uint8_t ucLastPORTB = 0;
+static uint32_t ulLEDEdges[ avrioNUM_LEDS ] = { 0 };
+
+/* Baud rate ticks not yet spent on a character, per USART. */
+static uint32_t ulUsartCredit[ avrNUM_USARTS ] = { 0 };
+static uint64_t ullTxChars[ avrNUM_USARTS ] = { 0 };
+static uint64_t ullRxChars[ avrNUM_USARTS ] = { 0 };
+static uint64_t ullRxDropped[ avrNUM_USARTS ] = { 0 };
+
+/* Timer prescalers by clock select value, 0 for stopped or an external
+clock. */
+static const uint16_t usPrescalers[ avrioCLOCK_SELECT + 1 ] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+/* Host time at which the last tick was serviced, for TCNT1. */
+static struct timespec xLastTickTime = { 0, 0 };
+
+static uint64_t ullNextStatusTick = portSIM_STATUS_PERIOD_TICKS;
+
+#ifdef portSIM_USART0_CAPTURE
+	/* Opened on the first character. */
+	static int iCaptureFile = -1;
+#endif
+
+/*-----------------------------------------------------------*/
+
+volatile uint8_t *pucAvrPORTB( void )
+{
+	/* Pick up any edges written directly to PORTB before applying the
+	toggles requested through PINB. */
+	prvCountEdges();
+
+	if( ucAvrPINB != 0 )
+	{
+		ucAvrPORTB ^= ucAvrPINB;
+		ucAvrPINB = 0;
+		prvCountEdges();
+	}
+
+	return &ucAvrPORTB;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCountEdges( void )
+{
+uint8_t ucChanged = ucAvrPORTB ^ ucLastPORTB;
+UBaseType_t uxLED;
+
+	for( uxLED = 0; uxLED < avrioNUM_LEDS; uxLED++ )
+	{
+		if( ( ucChanged & ( ( uint8_t ) 1 << uxLED ) ) != 0 )
+		{
+			ulLEDEdges[ uxLED ]++;
+		}
+	}
+
+	ucLastPORTB ^= ucChanged;
+}
+/*-----------------------------------------------------------*/
+
+void vAvrIoTick( uint64_t ullTick )
+{
+UBaseType_t uxUsart;
+
+	clock_gettime( CLOCK_MONOTONIC, &xLastTickTime );
+
+	for( uxUsart = 0; uxUsart < avrNUM_USARTS; uxUsart++ )
+	{
+		prvUsartTick( uxUsart );
+	}
+
+	/* The clock can jump forward in virtual time, so print once the period
+has passed rather than on an exact multiple of it. */
+	if( ( portSIM_STATUS_PERIOD_TICKS > 0 ) && ( ullTick >= ullNextStatusTick ) )
+	{
+		prvPrintStatus( ullTick );
+
+		while( ullNextStatusTick <= ullTick )
+		{
+			ullNextStatusTick += portSIM_STATUS_PERIOD_TICKS;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintStatus( uint64_t ullTick )
+{
+char cLine[ avrioLINE_LENGTH ];
+char cLEDs[ avrioNUM_LEDS + 1 ];
+UBaseType_t uxLED;
+int iLength;
+
+	/* LED 7 on the left, as the bits are written. */
+	for( uxLED = 0; uxLED < avrioNUM_LEDS; uxLED++ )
+	{
+		cLEDs[ uxLED ] = ( ( ucAvrPORTB & ( ( uint8_t ) 0x80 >> uxLED ) ) != 0 ) ? '*' : '.';
+	}
+	cLEDs[ avrioNUM_LEDS ] = '\0';
+
+	iLength = snprintf( cLine, sizeof( cLine ), "[%10llu.%03llu s] PORTB %s  USART0 tx %llu rx %llu\n",
+						( unsigned long long ) ( ullTick / configTICK_RATE_HZ ),
+						( unsigned long long ) ( ( ( ullTick % configTICK_RATE_HZ ) * 1000ULL ) / configTICK_RATE_HZ ),
+						cLEDs,
+						( unsigned long long ) ullTxChars[ 0 ],
+						( unsigned long long ) ullRxChars[ 0 ] );
+	prvPrint( cLine, iLength );
+}
+/*-----------------------------------------------------------*/
+
+static void prvUsartTick( UBaseType_t uxUsart )
+{
+AvrUsart_t *pxUsart = &( xAvrUSART[ uxUsart ] );
+uint32_t ulDivisor;
+
+	/* The data register is always ready for the next character - the
+	simulated shift register takes it at the end of the call. */
+	pxUsart->ucUCSRA |= avrioUDRE;
+
+	if( ( pxUsart->ucUCSRB & avrioTXEN ) == 0 )
+	{
+		ulUsartCredit[ uxUsart ] = 0;
+		return;
+	}
+
+	/* Baud rate from the data sheet equations for normal and double speed
+	mode. */
+	ulDivisor = ( ( pxUsart->ucUCSRA & avrioU2X ) != 0 ) ? ( uint32_t ) 8 : ( uint32_t ) 16;
+	ulDivisor *= ( uint32_t ) pxUsart->usUBRR + ( uint32_t ) 1;
+	ulUsartCredit[ uxUsart ] += configCPU_CLOCK_HZ / ulDivisor;
+
+	while( ulUsartCredit[ uxUsart ] >= avrioCHAR_COST )
+	{
+		if( ( ( pxUsart->ucUCSRB & avrioUDRIE ) == 0 ) || ( pxUdreVectors[ uxUsart ] == NULL ) )
+		{
+			/* Nothing to send - an idle line does not bank time. */
+			ulUsartCredit[ uxUsart ] = avrioCHAR_COST;
+			break;
+		}
+
+		pxUsart->usUDR = avrioUDR_EMPTY;
+		pxUdreVectors[ uxUsart ]();
+
+		if( pxUsart->usUDR != avrioUDR_EMPTY )
+		{
+			ullTxChars[ uxUsart ]++;
+
+			if( uxUsart == 0 )
+			{
+				prvCapture( ( uint8_t ) pxUsart->usUDR );
+			}
+
+			prvUsartReceive( uxUsart, ( uint8_t ) pxUsart->usUDR );
+		}
+
+		ulUsartCredit[ uxUsart ] -= avrioCHAR_COST;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvUsartReceive( UBaseType_t uxUsart, uint8_t ucChar )
+{
+AvrUsart_t *pxUsart = &( xAvrUSART[ uxUsart ] );
+const uint8_t ucRxEnabled = avrioRXEN | avrioRXCIE;
+
+	if( ( ( pxUsart->ucUCSRB & ucRxEnabled ) == ucRxEnabled ) && ( pxRxVectors[ uxUsart ] != NULL ) )
+	{
+		pxUsart->usUDR = ucChar;
+		pxUsart->ucUCSRA |= avrioRXC;
+		pxRxVectors[ uxUsart ]();
+		pxUsart->ucUCSRA &= ( uint8_t ) ~avrioRXC;
+		ullRxChars[ uxUsart ]++;
+	}
+	else
+	{
+		ullRxDropped[ uxUsart ]++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCapture( uint8_t ucChar )
+{
+#ifdef portSIM_USART0_CAPTURE
+	if( iCaptureFile < 0 )
+	{
+		iCaptureFile = open( portSIM_USART0_CAPTURE, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	}
+
+	if( iCaptureFile >= 0 )
+	{
+		( void ) write( iCaptureFile, &ucChar, 1 );
+	}
+#else
+	( void ) ucChar;
+#endif
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usAvrTCNT1( void )
+{
+struct timespec xNow;
+uint64_t ullSinceTick, ullCount;
+
+	/* Counts since the last tick, held at the compare value if the next tick
+	is late.  In virtual time this is still host time, so is only of use while
+	tasks are running. */
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	ullSinceTick = ( ( uint64_t ) ( xNow.tv_sec - xLastTickTime.tv_sec ) * 1000000000ULL ) + ( uint64_t ) ( xNow.tv_nsec - xLastTickTime.tv_nsec );
+	if( ullSinceTick > 1000000000ULL )
+	{
+		/* Before the first tick - and keeps the sum below in range. */
+		ullSinceTick = 1000000000ULL;
+	}
+
+	ullCount = ( ullSinceTick * ( uint64_t ) configCPU_CLOCK_HZ ) / ( avrioTIMER1_PRESCALER * 1000000000ULL );
+
+	if( ullCount > avrioTIMER1_OCR1A )
+	{
+		ullCount = avrioTIMER1_OCR1A;
+	}
+
+	return ( uint16_t ) ullCount;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t usAvrTCNT3( void )
+{
+struct timespec xNow;
+uint64_t ullCycles;
+uint16_t usPrescaler = usPrescalers[ ucAvrTCCR3B & avrioCLOCK_SELECT ];
+
+	if( usPrescaler == 0 )
+	{
+		return 0;
+	}
+
+	/* CPU cycles since the host clock's epoch.  Only the low 16 bits of the
+	count are kept, so where it starts does not matter. */
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	ullCycles = ( ( uint64_t ) xNow.tv_sec * ( uint64_t ) configCPU_CLOCK_HZ ) + ( ( ( uint64_t ) xNow.tv_nsec * ( uint64_t ) configCPU_CLOCK_HZ ) / 1000000000ULL );
+
+	return ( uint16_t ) ( ullCycles / usPrescaler );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xAvrIoBusy( void )
+{
+UBaseType_t uxUsart;
+BaseType_t xReturn = pdFALSE;
+
+	/* A transmitter with its UDRE interrupt enabled still has characters to
+	send, each of which loops back to the receiver. */
+	for( uxUsart = 0; uxUsart < avrNUM_USARTS; uxUsart++ )
+	{
+		if( ( xAvrUSART[ uxUsart ].ucUCSRB & ( avrioTXEN | avrioUDRIE ) ) == ( avrioTXEN | avrioUDRIE ) )
+		{
+			xReturn = pdTRUE;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vAvrIoReport( uint64_t ullTick )
+{
+char cLine[ avrioLINE_LENGTH ];
+UBaseType_t ux;
+int iLength;
+
+	prvCountEdges();
+
+	iLength = snprintf( cLine, sizeof( cLine ), "Simulated %llu ticks (%llu s)\n",
+						( unsigned long long ) ullTick,
+						( unsigned long long ) ( ullTick / configTICK_RATE_HZ ) );
+	prvPrint( cLine, iLength );
+
+	for( ux = 0; ux < avrioNUM_LEDS; ux++ )
+	{
+		iLength = snprintf( cLine, sizeof( cLine ), "LED %lu: %lu edges\n", ( unsigned long ) ux, ( unsigned long ) ulLEDEdges[ ux ] );
+		prvPrint( cLine, iLength );
+	}
+
+	for( ux = 0; ux < avrNUM_USARTS; ux++ )
+	{
+		if( ( ullTxChars[ ux ] != 0 ) || ( ullRxChars[ ux ] != 0 ) || ( ullRxDropped[ ux ] != 0 ) )
+		{
+			iLength = snprintf( cLine, sizeof( cLine ), "USART%lu: tx %llu rx %llu dropped %llu\n",
+								( unsigned long ) ux,
+								( unsigned long long ) ullTxChars[ ux ],
+								( unsigned long long ) ullRxChars[ ux ],
+								( unsigned long long ) ullRxDropped[ ux ] );
+			prvPrint( cLine, iLength );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrint( const char *pcLine, int iLength )
+{
+	if( iLength > 0 )
+	{
+		if( iLength >= avrioLINE_LENGTH )
+		{
+			iLength = avrioLINE_LENGTH - 1;
+		}
+
+		( void ) write( STDOUT_FILENO, pcLine, ( size_t ) iLength );
+	}
+}
@@ -0,0 +1,709 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Posix (host simulation) port.c
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: GCC (Linux host)
+ *
+ * Description:
+ * 	Runs the ATmega2560 demo on a workstation so it can be measured and
+ * 	regression tested without a board.
+ *
+ * 	Every task is given a host thread.  A thread only runs while its task is
+ * 	the one in pxCurrentTCB - all the others are parked on a semaphore, so
+ * 	switching context is a matter of releasing the next thread and parking
+ * 	the current one.
+ *
+ * 	The tick is SIGALRM from an interval timer.  Interrupts are simulated:
+ * 	portDISABLE_INTERRUPTS() only sets a flag, and a tick that arrives while
+ * 	it is set is held pending and serviced as soon as interrupts are enabled
+ * 	again.  The tick "ISR" runs the simulated peripherals (avrio.c) then
+ * 	increments the kernel tick, in the context of the interrupted task.
+ *
+ * 	Tasks must not call the host C library directly: a tick arriving in the
+ * 	middle of it could switch to another task that then needs the same lock.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "avrio.h"
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the Posix port.
+ *----------------------------------------------------------*/
+
+/* The signal used to generate the tick. */
+#define portTICK_SIGNAL					SIGALRM
+
+/* Period of the host interval timer.  In virtual time it is the quantum of
+host time tasks must run for to make a tick, and the timer is restarted after
+each tick so the time spent in the tick ISR itself is not counted. */
+#if( portSIM_VIRTUAL_TIME == 1 )
+	#define portTICK_PERIOD_US			( ( suseconds_t ) portSIM_VIRTUAL_QUANTUM_US )
+#else
+	#define portTICK_PERIOD_US			( ( suseconds_t ) ( 1000000UL / configTICK_RATE_HZ ) )
+#endif
+
+/* Critical nesting value used until the scheduler starts, so that the
+portEXIT_CRITICAL() calls made while creating tasks leave interrupts
+disabled. */
+#define portINITIAL_CRITICAL_NESTING	( ( UBaseType_t ) 0xaaaa )
+
+/* Run time counter resolution.  250 counts per tick matches timer 1 on the
+ATmega2560, where a count is 4us at the 1KHz tick rate. */
+#define portRUN_TIME_COUNTS_PER_TICK	( 250ULL )
+
+/*-----------------------------------------------------------*/
+
+/* The host thread behind each task. */
+typedef struct THREAD
+{
+	pthread_t xThread;
+	sem_t xRun;							/* Posted when the task is switched in. */
+	TaskFunction_t pxCode;
+	void *pvParameters;
+} Thread_t;
+
+/* We require the address of the pxCurrentTCB variable, but don't want to know
+any details of its type. */
+typedef void TCB_t;
+extern volatile TCB_t * volatile pxCurrentTCB;
+
+/* The first member of a TCB is the top of its stack, and the top of the stack
+holds the task's Thread_t in place of a saved context. */
+#define portTHREAD_FROM_TCB( pxTCB )	( *( Thread_t ** ) ( *( StackType_t ** ) ( pxTCB ) ) )
+
+/*-----------------------------------------------------------*/
+
+/* Simulated global interrupt flag - pdTRUE when interrupts are disabled. */
+static volatile BaseType_t xInterruptsDisabled = pdTRUE;
+
+/* Ticks signalled but not yet serviced.  Only changed with atomic operations
+as it is incremented from the signal handler. */
+static volatile UBaseType_t uxTicksPending = 0;
+
+/* pdTRUE while the tick ISR is running, so a yield from within it is only
+recorded in xSwitchRequired. */
+static volatile BaseType_t xInsideInterrupt = pdFALSE;
+static volatile BaseType_t xSwitchRequired = pdFALSE;
+
+/* Saved per task by prvSwitchContext(). */
+static volatile UBaseType_t uxCriticalNesting = portINITIAL_CRITICAL_NESTING;
+
+/* Ticks since the scheduler started, including those skipped in virtual
+time.  Does not wrap. */
+static uint64_t ullSimTicks = 0;
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+	/* Host time at which the last tick was serviced, to find how far into the
+	current tick period the run time counter is.  Timer 1 does not run until
+	the scheduler starts, so neither does the counter. */
+	static struct timespec xLastTickTime;
+	static BaseType_t xRunTimeStarted = pdFALSE;
+#endif
+
+#if( portSIM_VIRTUAL_TIME == 1 )
+	/* Number of times the clock jumped, and the ticks it jumped over. */
+	static uint64_t ullJumps = 0;
+	static uint64_t ullTicksJumped = 0;
+#endif
+
+/* Posted by vPortEndScheduler() to release the thread that started the
+scheduler. */
+static sem_t xSchedulerEnd;
+
+/* Contains only the tick signal. */
+static sigset_t xTickSignalSet;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Fill in xTickSignalSet.  Called by the first task creation.
+ */
+static void prvInitialiseTickSignalSet( void );
+
+/*
+ * Start the interval timer that generates the tick.
+ */
+static void prvSetupTimerInterrupt( void );
+
+/*
+ * SIGALRM handler.
+ */
+static void prvTickSignalHandler( int iSignal );
+
+/*
+ * The simulated tick ISR.  Services every pending tick, then performs a
+ * context switch if one was requested.
+ */
+static void prvServiceInterrupts( void );
+
+/*
+ * Select the next task and hand the processor over to its thread.  Must be
+ * called with interrupts disabled.
+ */
+static void prvSwitchContext( void );
+
+/*
+ * Park the calling thread until its task is switched in.
+ */
+static void prvWaitToRun( Thread_t *pxThread );
+
+/*
+ * Entry point of each task thread.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+sigset_t xOriginalMask;
+BaseType_t xWasDisabled = xInterruptsDisabled;
+
+	/* Keep the tick away while inside the C library. */
+	xInterruptsDisabled = pdTRUE;
+
+	prvInitialiseTickSignalSet();
+
+	pxThread = ( Thread_t * ) malloc( sizeof( Thread_t ) );
+	configASSERT( pxThread != NULL );
+
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	( void ) sem_init( &( pxThread->xRun ), 0, 0 );
+
+	/* The new thread inherits the signal mask, and must not take the tick
+	until its task is switched in. */
+	( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, &xOriginalMask );
+	if( pthread_create( &( pxThread->xThread ), NULL, prvThreadEntry, pxThread ) != 0 )
+	{
+		configASSERT( pdFALSE );
+	}
+	( void ) pthread_sigmask( SIG_SETMASK, &xOriginalMask, NULL );
+
+	if( xWasDisabled == pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+
+	/* The stack itself is never used, the thread has its own.  Just store the
+	thread where the context would go. */
+	pxTopOfStack = ( StackType_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack - sizeof( Thread_t * ) ) & ~( ( portPOINTER_SIZE_TYPE ) sizeof( Thread_t * ) - 1 ) );
+	*( ( Thread_t ** ) pxTopOfStack ) = pxThread;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct timespec xStart, xEnd;
+
+	( void ) sem_init( &xSchedulerEnd, 0, 0 );
+
+	/* This thread only waits from now on, it never takes the tick. */
+	prvInitialiseTickSignalSet();
+	( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignalHandler;
+	xAction.sa_flags = SA_RESTART;
+	( void ) sigemptyset( &xAction.sa_mask );
+	( void ) sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	/* Setup the hardware to generate the tick. */
+	( void ) clock_gettime( CLOCK_MONOTONIC, &xStart );
+	#if( configGENERATE_RUN_TIME_STATS == 1 )
+	{
+		xLastTickTime = xStart;
+		xRunTimeStarted = pdTRUE;
+	}
+	#endif
+	prvSetupTimerInterrupt();
+
+	/* Start the first task.  It enables interrupts as it starts. */
+	( void ) sem_post( &( portTHREAD_FROM_TCB( pxCurrentTCB )->xRun ) );
+
+	while( sem_wait( &xSchedulerEnd ) != 0 )
+	{
+		/* Interrupted - wait again. */
+	}
+
+	( void ) clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+	vAvrIoReport( ullSimTicks );
+
+	printf( "Host time %.3f s\n", ( double ) ( xEnd.tv_sec - xStart.tv_sec ) + ( ( double ) ( xEnd.tv_nsec - xStart.tv_nsec ) / 1e9 ) );
+	#if( portSIM_VIRTUAL_TIME == 1 )
+	{
+		printf( "Virtual time: %llu ticks skipped in %llu jumps\n", ( unsigned long long ) ullTicksJumped, ( unsigned long long ) ullJumps );
+	}
+	#endif
+	fflush( stdout );
+
+	/* Only reached once vPortEndScheduler() has been called. */
+	return pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	xInterruptsDisabled = pdTRUE;
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	( void ) setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	( void ) sem_post( &xSchedulerEnd );
+
+	/* The process exits from the thread that started the scheduler, park this
+	one until then. */
+	( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+	for( ;; )
+	{
+		( void ) pause();
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Manual context switch.  From within the tick ISR the switch is left until
+ * the ISR completes.
+ */
+void vPortYield( void )
+{
+BaseType_t xWasDisabled;
+
+	if( xInsideInterrupt != pdFALSE )
+	{
+		xSwitchRequired = pdTRUE;
+	}
+	else
+	{
+		xWasDisabled = xInterruptsDisabled;
+		xInterruptsDisabled = pdTRUE;
+
+		prvSwitchContext();
+
+		/* Back in this task, with the interrupt state it had. */
+		if( xWasDisabled == pdFALSE )
+		{
+			vPortEnableInterrupts();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( portSIM_VIRTUAL_TIME == 1 )
+
+	/*
+	 * Called by the idle task, with the scheduler suspended, when no task will
+	 * unblock for at least xExpectedIdleTime ticks.  Nothing can run until then,
+	 * so the clock jumps to the tick before and the tick that unblocks the
+	 * task is raised immediately.  If a peripheral is still busy its
+	 * interrupts must not be skipped - the tick is raised immediately but the
+	 * clock does not jump.
+	 */
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
+	{
+	TickType_t xTicksToJump;
+
+		vPortDisableInterrupts();
+
+		/* A task may have been readied since the scheduler was suspended. */
+		if( eTaskConfirmSleepModeStatus() != eAbortSleep )
+		{
+			if( xAvrIoBusy() == pdFALSE )
+			{
+				xTicksToJump = xExpectedIdleTime - ( TickType_t ) 1;
+			}
+			else
+			{
+				xTicksToJump = 0;
+			}
+
+			#if( portSIM_RUN_TICKS > 0 )
+			{
+				if( ( ullSimTicks + xTicksToJump ) >= ( uint64_t ) portSIM_RUN_TICKS )
+				{
+					xTicksToJump = ( TickType_t ) ( ( uint64_t ) portSIM_RUN_TICKS - ullSimTicks - 1ULL );
+				}
+			}
+			#endif
+
+			if( xTicksToJump > 0 )
+			{
+				vTaskStepTick( xTicksToJump );
+				ullSimTicks += xTicksToJump;
+				ullTicksJumped += xTicksToJump;
+				ullJumps++;
+			}
+
+			( void ) __atomic_add_fetch( &uxTicksPending, 1, __ATOMIC_SEQ_CST );
+		}
+
+		vPortEnableInterrupts();
+	}
+
+#endif /* portSIM_VIRTUAL_TIME */
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	xInterruptsDisabled = pdTRUE;
+	__asm volatile ( "" ::: "memory" );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	__asm volatile ( "" ::: "memory" );
+	xInterruptsDisabled = pdFALSE;
+
+	/* Take any tick that arrived while interrupts were disabled. */
+	if( uxTicksPending != 0 )
+	{
+		prvServiceInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+UBaseType_t uxSavedStatus = ( UBaseType_t ) xInterruptsDisabled;
+
+	vPortDisableInterrupts();
+
+	return uxSavedStatus;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxSavedStatus )
+{
+	if( uxSavedStatus == ( UBaseType_t ) pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+	/*
+	 * Simulated ticks scaled to portRUN_TIME_COUNTS_PER_TICK, plus the host
+	 * time since the last tick as a fraction of the tick period.  In virtual
+	 * time that period is the quantum, so the counter follows simulated time,
+	 * although the ticks skipped while every task was blocked are all charged
+	 * to the idle task.
+	 */
+	uint32_t ulPortGetRunTimeCounterValue( void )
+	{
+	struct timespec xNow;
+	uint64_t ullSinceTick, ullFraction = 0ULL;
+
+		if( xRunTimeStarted != pdFALSE )
+		{
+			( void ) clock_gettime( CLOCK_MONOTONIC, &xNow );
+			ullSinceTick = ( ( uint64_t ) ( xNow.tv_sec - xLastTickTime.tv_sec ) * 1000000000ULL ) + ( uint64_t ) ( xNow.tv_nsec - xLastTickTime.tv_nsec );
+			ullFraction = ( ullSinceTick * portRUN_TIME_COUNTS_PER_TICK ) / ( ( uint64_t ) portTICK_PERIOD_US * 1000ULL );
+
+			if( ullFraction >= portRUN_TIME_COUNTS_PER_TICK )
+			{
+				ullFraction = portRUN_TIME_COUNTS_PER_TICK - 1ULL;
+			}
+		}
+
+		return ( uint32_t ) ( ( ullSimTicks * portRUN_TIME_COUNTS_PER_TICK ) + ullFraction );
+	}
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTCB( void *pxTCB )
+{
+Thread_t *pxThread = portTHREAD_FROM_TCB( pxTCB );
+BaseType_t xWasDisabled = xInterruptsDisabled;
+
+	/* The thread of a deleted task is parked in prvWaitToRun(), which is a
+	cancellation point. */
+	xInterruptsDisabled = pdTRUE;
+	( void ) pthread_cancel( pxThread->xThread );
+	( void ) pthread_join( pxThread->xThread, NULL );
+	( void ) sem_destroy( &( pxThread->xRun ) );
+	free( pxThread );
+
+	if( xWasDisabled == pdFALSE )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseTickSignalSet( void )
+{
+static BaseType_t xInitialised = pdFALSE;
+
+	if( xInitialised == pdFALSE )
+	{
+		( void ) sigemptyset( &xTickSignalSet );
+		( void ) sigaddset( &xTickSignalSet, portTICK_SIGNAL );
+		xInitialised = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTimerInterrupt( void )
+{
+struct itimerval xTimer;
+
+	xTimer.it_value.tv_sec = 0;
+	xTimer.it_value.tv_usec = portTICK_PERIOD_US;
+
+	#if( portSIM_VIRTUAL_TIME == 1 )
+	{
+		/* One shot, restarted by each tick. */
+		xTimer.it_interval.tv_sec = 0;
+		xTimer.it_interval.tv_usec = 0;
+	}
+	#else
+	{
+		xTimer.it_interval = xTimer.it_value;
+	}
+	#endif
+	( void ) setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+	( void ) iSignal;
+
+	( void ) __atomic_add_fetch( &uxTicksPending, 1, __ATOMIC_SEQ_CST );
+
+	if( xInterruptsDisabled == pdFALSE )
+	{
+		prvServiceInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvServiceInterrupts( void )
+{
+	/* As on the AVR, interrupts are disabled while the ISR runs. */
+	xInterruptsDisabled = pdTRUE;
+
+	while( uxTicksPending != 0 )
+	{
+		( void ) __atomic_sub_fetch( &uxTicksPending, 1, __ATOMIC_SEQ_CST );
+
+		xInsideInterrupt = pdTRUE;
+		{
+			ullSimTicks++;
+			vAvrIoTick( ullSimTicks );
+
+			#if( configGENERATE_RUN_TIME_STATS == 1 )
+			{
+				( void ) clock_gettime( CLOCK_MONOTONIC, &xLastTickTime );
+			}
+			#endif
+
+			if( xTaskIncrementTick() != pdFALSE )
+			{
+				xSwitchRequired = pdTRUE;
+			}
+		}
+		xInsideInterrupt = pdFALSE;
+
+		#if( portSIM_VIRTUAL_TIME == 1 )
+		{
+			prvSetupTimerInterrupt();
+		}
+		#endif
+
+		#if( portSIM_RUN_TICKS > 0 )
+		{
+			if( ullSimTicks >= ( uint64_t ) portSIM_RUN_TICKS )
+			{
+				vPortEndScheduler();
+			}
+		}
+		#endif
+
+		#if( configUSE_PREEMPTION == 1 )
+		{
+			if( xSwitchRequired != pdFALSE )
+			{
+				xSwitchRequired = pdFALSE;
+				prvSwitchContext();
+			}
+		}
+		#else
+		{
+			/* Switches requested from the ISR are left to the next
+			taskYIELD(). */
+			xSwitchRequired = pdFALSE;
+		}
+		#endif
+	}
+
+	xInterruptsDisabled = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchContext( void )
+{
+Thread_t *pxCurrentThread = portTHREAD_FROM_TCB( pxCurrentTCB );
+Thread_t *pxNextThread;
+UBaseType_t uxSavedCriticalNesting = uxCriticalNesting;
+
+	vTaskSwitchContext();
+	pxNextThread = portTHREAD_FROM_TCB( pxCurrentTCB );
+
+	if( pxNextThread != pxCurrentThread )
+	{
+		/* Only the running thread may take the tick. */
+		( void ) pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+
+		( void ) sem_post( &( pxNextThread->xRun ) );
+		prvWaitToRun( pxCurrentThread );
+
+		( void ) pthread_sigmask( SIG_UNBLOCK, &xTickSignalSet, NULL );
+	}
+
+	uxCriticalNesting = uxSavedCriticalNesting;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitToRun( Thread_t *pxThread )
+{
+	while( sem_wait( &( pxThread->xRun ) ) != 0 )
+	{
+		/* Interrupted - wait again. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParameters;
+
+	prvWaitToRun( pxThread );
+
+	/* Tasks start with interrupts enabled, as on the AVR. */
+	uxCriticalNesting = 0;
+	( void ) pthread_sigmask( SIG_UNBLOCK, &xTickSignalSet, NULL );
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks must not return. */
+	vPortDisableInterrupts();
+	fprintf( stderr, "Task returned from its implementing function\n" );
+	abort();
+
+	return NULL;
+}
@@ -87,9 +87,9 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
-#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
-	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
-#endif
+/* heap_coalesce.c is used instead when configUSE_COALESCING_HEAP is 1, and
+neither is built when configSUPPORT_DYNAMIC_ALLOCATION is 0. */
+#if( ( configUSE_COALESCING_HEAP == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 
 /* A few bytes might be lost to byte aligning the heap start address. */
 #define configADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT )
@@ -113,6 +113,17 @@ void *pvPortMalloc( size_t xWantedSize )
 void *pvReturn = NULL;
 static uint8_t *pucAlignedHeap = NULL;
 
+	#if( configUSE_BLOCK_POOLS == 1 )
+	{
+		/* A block from a pool, if one of the right size is free. */
+		pvReturn = pvPortPoolMalloc( xWantedSize );
+		if( pvReturn != NULL )
+		{
+			return pvReturn;
+		}
+	}
+	#endif
+
 	/* Ensure that blocks are always aligned to the required number of bytes. */
 	#if( portBYTE_ALIGNMENT != 1 )
 	{
@@ -164,7 +175,17 @@ void vPortFree( void *pv )
 {
 	/* Memory cannot be freed using this scheme.  See heap_2.c, heap_3.c and
 	heap_4.c for alternative implementations, and the memory management pages of
-	http://www.FreeRTOS.org for more information. */
+	http://www.FreeRTOS.org for more information.  Blocks from the pools can
+	though. */
+	#if( configUSE_BLOCK_POOLS == 1 )
+	{
+		if( xPortPoolFree( pv ) != pdFALSE )
+		{
+			return;
+		}
+	}
+	#endif
+
 	( void ) pv;
 
 	/* Force an assert as it is invalid to call this function. */
@@ -183,6 +204,25 @@ size_t xPortGetFreeHeapSize( void )
 {
 	return ( configADJUSTED_HEAP_SIZE - xNextFreeByte );
 }
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	/* Nothing is ever returned to the heap. */
+	return xPortGetFreeHeapSize();
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+size_t xFree = xPortGetFreeHeapSize();
+
+	/* pvPortMalloc() leaves at least one byte unused. */
+	return ( xFree > ( size_t ) 0 ) ? ( xFree - ( size_t ) 1 ) : ( size_t ) 0;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_COALESCING_HEAP && configSUPPORT_DYNAMIC_ALLOCATION */
 
 
 
@@ -0,0 +1,418 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+
+/*
+ * A first fit implementation of pvPortMalloc() and vPortFree() that merges
+ * neighbouring free blocks, for 8 bit targets with little RAM.
+ *
+ * The heap is divided into blocks, each starting with a 2 byte header that
+ * holds the size of the block, header included, with the top bit set while
+ * the block is allocated.  A free block also holds the offset of the next free
+ * block in the 2 bytes after its header, so the free list takes no room in
+ * allocated blocks and no block is smaller than 4 bytes.  The free list is
+ * kept in address order, so a block that is freed is merged with the free
+ * blocks either side of it.
+ *
+ * Offsets into the heap are used rather than pointers so the header is 2 bytes
+ * on any target, which limits configTOTAL_HEAP_SIZE to 32767 bytes.  Where
+ * portBYTE_ALIGNMENT is above 1, as in the host simulation, the header is
+ * padded and sizes rounded up so every block stays aligned.
+ *
+ * pvPortMalloc() and vPortFree() walk the free list, so take time in
+ * proportion to the number of free blocks.  HeapBench/heapbench.c measures
+ * them against heap_1.c.
+ *
+ * Both this file and heap_1.c are built, configUSE_COALESCING_HEAP selects
+ * which one is used, and neither when configSUPPORT_DYNAMIC_ALLOCATION is 0.
+ * Either takes blocks from the pools in heap_pools.c first when
+ * configUSE_BLOCK_POOLS is 1.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Nothing is built when everything is statically allocated. */
+#if( ( configUSE_COALESCING_HEAP == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
+
+/* A size or offset rounded up to a multiple of portBYTE_ALIGNMENT. */
+#define heapALIGN_UP( x )			( ( ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* The block header, and the smallest block - a header followed by the offset
+of the next free block. */
+#define heapHEADER_SIZE				( heapALIGN_UP( sizeof( uint16_t ) ) )
+#define heapMINIMUM_BLOCK_SIZE		( heapHEADER_SIZE + heapALIGN_UP( sizeof( uint16_t ) ) )
+
+/* Set in the header of an allocated block. */
+#define heapALLOCATED_BIT			( ( uint16_t ) 0x8000 )
+
+/* Offset used to end the free list. */
+#define heapEND_OF_LIST				( ( uint16_t ) 0xffff )
+
+/* The largest heap, and block, the header can describe. */
+#define heapMAXIMUM_SIZE			( ( size_t ) 0x7fff )
+
+/* A few bytes might be lost to aligning the heap start address. */
+#if( portBYTE_ALIGNMENT == 1 )
+	#define heapADJUSTED_HEAP_SIZE	( configTOTAL_HEAP_SIZE )
+#else
+	#define heapADJUSTED_HEAP_SIZE	( ( configTOTAL_HEAP_SIZE - portBYTE_ALIGNMENT ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#endif
+
+/* The size of the block at an offset, and the next free block after a free
+block. */
+#define heapBLOCK_SIZE( usBlock )	( *( uint16_t * ) &( pucHeap[ ( usBlock ) ] ) )
+#define heapNEXT_FREE( usBlock )	( *( uint16_t * ) &( pucHeap[ ( usBlock ) + heapHEADER_SIZE ] ) )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Makes the whole heap one free block.  Called by the first allocation.
+ */
+static void prvHeapInit( void );
+
+/*-----------------------------------------------------------*/
+
+/* The aligned start of the heap, NULL until the first allocation. */
+static uint8_t *pucHeap = NULL;
+
+/* Offset of the free block with the lowest address. */
+static uint16_t usFirstFree = heapEND_OF_LIST;
+
+static size_t xFreeBytesRemaining = ( size_t ) 0;
+static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+void *pvReturn = NULL;
+uint16_t usBlock, usPrevious = heapEND_OF_LIST;
+size_t xBlockSize;
+
+	#if( configUSE_BLOCK_POOLS == 1 )
+	{
+		/* A block from a pool, if one of the right size is free. */
+		pvReturn = pvPortPoolMalloc( xWantedSize );
+		if( pvReturn != NULL )
+		{
+			return pvReturn;
+		}
+	}
+	#endif
+
+	vTaskSuspendAll();
+	{
+		if( pucHeap == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* Check the block size, header and alignment included, cannot
+		overflow. */
+		if( ( xWantedSize > ( size_t ) 0 ) && ( xWantedSize <= ( heapMAXIMUM_SIZE - heapHEADER_SIZE - portBYTE_ALIGNMENT_MASK ) ) )
+		{
+			xBlockSize = heapALIGN_UP( xWantedSize + heapHEADER_SIZE );
+
+			if( xBlockSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xBlockSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			/* Take the first free block that is large enough. */
+			usBlock = usFirstFree;
+			while( ( usBlock != heapEND_OF_LIST ) && ( heapBLOCK_SIZE( usBlock ) < xBlockSize ) )
+			{
+				usPrevious = usBlock;
+				usBlock = heapNEXT_FREE( usBlock );
+			}
+
+			if( usBlock != heapEND_OF_LIST )
+			{
+				if( ( heapBLOCK_SIZE( usBlock ) - xBlockSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					/* Allocate the end of the block.  The start stays free, in
+					the same place in the list. */
+					heapBLOCK_SIZE( usBlock ) -= ( uint16_t ) xBlockSize;
+					usBlock += heapBLOCK_SIZE( usBlock );
+				}
+				else
+				{
+					/* Too little would be left to make a block, so take all of
+					it out of the list. */
+					xBlockSize = heapBLOCK_SIZE( usBlock );
+
+					if( usPrevious == heapEND_OF_LIST )
+					{
+						usFirstFree = heapNEXT_FREE( usBlock );
+					}
+					else
+					{
+						heapNEXT_FREE( usPrevious ) = heapNEXT_FREE( usBlock );
+					}
+				}
+
+				heapBLOCK_SIZE( usBlock ) = ( uint16_t ) xBlockSize | heapALLOCATED_BIT;
+				xFreeBytesRemaining -= xBlockSize;
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				pvReturn = &( pucHeap[ usBlock + heapHEADER_SIZE ] );
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint16_t usBlock, usPrevious = heapEND_OF_LIST, usNext;
+size_t xBlockSize;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	#if( configUSE_BLOCK_POOLS == 1 )
+	{
+		if( xPortPoolFree( pv ) != pdFALSE )
+		{
+			return;
+		}
+	}
+	#endif
+
+	usBlock = ( uint16_t ) ( ( ( uint8_t * ) pv - pucHeap ) - heapHEADER_SIZE );
+
+	/* The block must have been allocated, and not freed since. */
+	configASSERT( ( heapBLOCK_SIZE( usBlock ) & heapALLOCATED_BIT ) != 0 );
+
+	if( ( heapBLOCK_SIZE( usBlock ) & heapALLOCATED_BIT ) != 0 )
+	{
+		vTaskSuspendAll();
+		{
+			xBlockSize = heapBLOCK_SIZE( usBlock ) & ( uint16_t ) ~heapALLOCATED_BIT;
+			heapBLOCK_SIZE( usBlock ) = ( uint16_t ) xBlockSize;
+			xFreeBytesRemaining += xBlockSize;
+			traceFREE( pv, xBlockSize );
+
+			/* Find the free blocks either side.  heapEND_OF_LIST is above any
+			offset, so ends the search. */
+			usNext = usFirstFree;
+			while( usNext < usBlock )
+			{
+				usPrevious = usNext;
+				usNext = heapNEXT_FREE( usNext );
+			}
+
+			/* Merge with the block after if it is free... */
+			if( ( ( size_t ) usBlock + xBlockSize ) == ( size_t ) usNext )
+			{
+				heapBLOCK_SIZE( usBlock ) += heapBLOCK_SIZE( usNext );
+				usNext = heapNEXT_FREE( usNext );
+			}
+			heapNEXT_FREE( usBlock ) = usNext;
+
+			/* ...and with the block before. */
+			if( usPrevious == heapEND_OF_LIST )
+			{
+				usFirstFree = usBlock;
+			}
+			else if( ( ( size_t ) usPrevious + heapBLOCK_SIZE( usPrevious ) ) == ( size_t ) usBlock )
+			{
+				heapBLOCK_SIZE( usPrevious ) += heapBLOCK_SIZE( usBlock );
+				heapNEXT_FREE( usPrevious ) = usNext;
+			}
+			else
+			{
+				heapNEXT_FREE( usPrevious ) = usBlock;
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	/* Headers included, so the heap cannot be made smaller than
+	configTOTAL_HEAP_SIZE less this without an allocation failing. */
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlockSize( void )
+{
+uint16_t usBlock;
+size_t xLargest = 0;
+
+	vTaskSuspendAll();
+	{
+		if( pucHeap == NULL )
+		{
+			prvHeapInit();
+		}
+
+		for( usBlock = usFirstFree; usBlock != heapEND_OF_LIST; usBlock = heapNEXT_FREE( usBlock ) )
+		{
+			if( heapBLOCK_SIZE( usBlock ) > xLargest )
+			{
+				xLargest = heapBLOCK_SIZE( usBlock );
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	/* What can be asked for, rather than the size of the block. */
+	if( xLargest > heapHEADER_SIZE )
+	{
+		xLargest -= heapHEADER_SIZE;
+	}
+	else
+	{
+		xLargest = 0;
+	}
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+	/* The header cannot hold a larger size. */
+	configASSERT( heapADJUSTED_HEAP_SIZE <= heapMAXIMUM_SIZE );
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	#if( portBYTE_ALIGNMENT == 1 )
+	{
+		pucHeap = ucHeap;
+	}
+	#else
+	{
+		pucHeap = ( uint8_t * ) ( ( ( portPOINTER_SIZE_TYPE ) &ucHeap[ portBYTE_ALIGNMENT ] ) & ( ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) ) );
+	}
+	#endif
+
+	heapBLOCK_SIZE( 0 ) = ( uint16_t ) heapADJUSTED_HEAP_SIZE;
+	heapNEXT_FREE( 0 ) = heapEND_OF_LIST;
+	usFirstFree = 0;
+	xFreeBytesRemaining = heapADJUSTED_HEAP_SIZE;
+	xMinimumEverFreeBytesRemaining = heapADJUSTED_HEAP_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_COALESCING_HEAP && configSUPPORT_DYNAMIC_ALLOCATION */
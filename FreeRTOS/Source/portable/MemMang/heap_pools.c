@@ -0,0 +1,319 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+
+/*
+ * Fixed size block pools, used by pvPortMalloc() and vPortFree() in heap_1.c
+ * and heap_coalesce.c when configUSE_BLOCK_POOLS is 1.
+ *
+ * configBLOCK_POOLS() in FreeRTOSConfig.h lists the pools, as the block size
+ * and the number of blocks of each, for example:
+ *
+ *     #define configBLOCK_POOLS( X )	X( sizeof( StaticTask_t ), 8 ) X( configMINIMAL_STACK_SIZE, 8 )
+ *
+ * A request is served from the pool with the smallest blocks it fits in.  If
+ * that pool has no free block, or no pool has blocks large enough, it is
+ * served from the heap as before.  The blocks of a pool are one static array
+ * and the free ones are linked through their first bytes, so allocating and
+ * freeing take the same short time whatever has happened before, and the
+ * pools can never fragment.  The pool storage is not part of
+ * configTOTAL_HEAP_SIZE.
+ *
+ * Each pool counts the blocks in use, the most ever in use and the requests
+ * it had to pass on to the heap - see vPortGetBlockPoolStats().
+ */
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_BLOCK_POOLS == 1 )
+
+#ifndef configBLOCK_POOLS
+	#error configBLOCK_POOLS must be defined in FreeRTOSConfig.h when configUSE_BLOCK_POOLS is 1.
+#endif
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error The block pools serve pvPortMalloc(), so cannot be used if configSUPPORT_DYNAMIC_ALLOCATION is 0.
+#endif
+
+/* The block size actually used for a requested size - large enough to hold
+the free list link, and a multiple of portBYTE_ALIGNMENT. */
+#define poolBLOCK_SIZE( xSize )		( ( ( ( ( xSize ) < sizeof( void * ) ) ? sizeof( void * ) : ( xSize ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* configBLOCK_POOLS() expanded to add up the storage, and to describe each
+pool. */
+#define poolSTORAGE( xSize, uxBlocks )	+ ( poolBLOCK_SIZE( xSize ) * ( size_t ) ( uxBlocks ) )
+#define poolCLASS( xSize, uxBlocks )	{ poolBLOCK_SIZE( xSize ), ( uxBlocks ) },
+
+#define poolTOTAL_STORAGE			( ( size_t ) 0 configBLOCK_POOLS( poolSTORAGE ) )
+
+/* The size and number of the blocks of a pool. */
+typedef struct BLOCK_POOL_CLASS
+{
+	size_t xBlockSize;
+	UBaseType_t uxBlocks;
+} BlockPoolClass_t;
+
+/* The state of a pool. */
+typedef struct BLOCK_POOL
+{
+	uint8_t *pucStart;					/* The first block. */
+	uint8_t *pucEnd;					/* Just past the last block. */
+	void *pvFreeList;					/* The first free block, which holds a pointer to the next. */
+	UBaseType_t uxInUse;
+	UBaseType_t uxMaxInUse;
+	uint32_t ulFallbacks;
+} BlockPool_t;
+
+static const BlockPoolClass_t xClasses[] = { configBLOCK_POOLS( poolCLASS ) };
+
+#define poolNUM_POOLS				( sizeof( xClasses ) / sizeof( xClasses[ 0 ] ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Divides the storage into the pools and links the blocks of each.  Called
+ * by the first allocation.
+ */
+static void prvPoolsInit( void );
+
+/*-----------------------------------------------------------*/
+
+/* The blocks of every pool, one pool after another.  A union with a pointer
+aligns it for the free list links. */
+static union
+{
+	void *pvAlign;
+	uint8_t ucBytes[ poolTOTAL_STORAGE ];
+} xStorage;
+
+static BlockPool_t xPools[ poolNUM_POOLS ];
+
+static BaseType_t xPoolsInitialised = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortPoolMalloc( size_t xWantedSize )
+{
+void *pvReturn = NULL;
+BlockPool_t *pxPool = NULL;
+UBaseType_t uxPool;
+size_t xBestSize = ( size_t ) ~( size_t ) 0;
+
+	vTaskSuspendAll();
+	{
+		if( xPoolsInitialised == pdFALSE )
+		{
+			prvPoolsInit();
+		}
+
+		/* The pool with the smallest blocks the request fits in.  The number
+		of pools is fixed, so this takes the same time for every request. */
+		for( uxPool = 0; uxPool < poolNUM_POOLS; uxPool++ )
+		{
+			if( ( xClasses[ uxPool ].xBlockSize >= xWantedSize ) && ( xClasses[ uxPool ].xBlockSize < xBestSize ) )
+			{
+				xBestSize = xClasses[ uxPool ].xBlockSize;
+				pxPool = &( xPools[ uxPool ] );
+			}
+		}
+
+		if( ( pxPool != NULL ) && ( xWantedSize > ( size_t ) 0 ) )
+		{
+			if( pxPool->pvFreeList != NULL )
+			{
+				pvReturn = pxPool->pvFreeList;
+				pxPool->pvFreeList = *( void ** ) pvReturn;
+				pxPool->uxInUse++;
+
+				if( pxPool->uxInUse > pxPool->uxMaxInUse )
+				{
+					pxPool->uxMaxInUse = pxPool->uxInUse;
+				}
+
+				/* Traced here, rather than by pvPortMalloc(), so the trace
+				macro is called with the scheduler suspended whichever way the
+				block is allocated. */
+				traceMALLOC( pvReturn, xWantedSize );
+			}
+			else
+			{
+				/* Left to the heap. */
+				pxPool->ulFallbacks++;
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortPoolFree( void *pv )
+{
+BlockPool_t *pxPool;
+UBaseType_t uxPool;
+BaseType_t xReturn = pdFALSE;
+
+	/* Nothing is in a pool until the pools have been set up. */
+	if( ( pv != NULL ) && ( xPoolsInitialised != pdFALSE ) )
+	{
+		for( uxPool = 0; uxPool < poolNUM_POOLS; uxPool++ )
+		{
+			pxPool = &( xPools[ uxPool ] );
+
+			if( ( ( uint8_t * ) pv >= pxPool->pucStart ) && ( ( uint8_t * ) pv < pxPool->pucEnd ) )
+			{
+				/* Must be the start of a block in use. */
+				configASSERT( ( ( size_t ) ( ( uint8_t * ) pv - pxPool->pucStart ) % xClasses[ uxPool ].xBlockSize ) == 0 );
+				configASSERT( pxPool->uxInUse > 0 );
+
+				vTaskSuspendAll();
+				{
+					*( void ** ) pv = pxPool->pvFreeList;
+					pxPool->pvFreeList = pv;
+					pxPool->uxInUse--;
+					traceFREE( pv, xClasses[ uxPool ].xBlockSize );
+				}
+				( void ) xTaskResumeAll();
+
+				xReturn = pdTRUE;
+				break;
+			}
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetBlockPoolCount( void )
+{
+	return ( UBaseType_t ) poolNUM_POOLS;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetBlockPoolStats( UBaseType_t uxPool, BlockPoolStats_t *pxStats )
+{
+	configASSERT( uxPool < poolNUM_POOLS );
+
+	vTaskSuspendAll();
+	{
+		pxStats->xBlockSize = xClasses[ uxPool ].xBlockSize;
+		pxStats->uxBlocks = xClasses[ uxPool ].uxBlocks;
+		pxStats->uxInUse = xPools[ uxPool ].uxInUse;
+		pxStats->uxMaxInUse = xPools[ uxPool ].uxMaxInUse;
+		pxStats->ulFallbacks = xPools[ uxPool ].ulFallbacks;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolsInit( void )
+{
+uint8_t *pucBlock = xStorage.ucBytes;
+UBaseType_t uxPool, uxBlock;
+BlockPool_t *pxPool;
+void *pvBlock;
+
+	for( uxPool = 0; uxPool < poolNUM_POOLS; uxPool++ )
+	{
+		pxPool = &( xPools[ uxPool ] );
+		pxPool->pucStart = pucBlock;
+		pxPool->pvFreeList = NULL;
+
+		/* Link the blocks last to first, so the first block is taken first. */
+		pucBlock += xClasses[ uxPool ].xBlockSize * ( size_t ) xClasses[ uxPool ].uxBlocks;
+		pxPool->pucEnd = pucBlock;
+
+		for( uxBlock = xClasses[ uxPool ].uxBlocks; uxBlock > 0; uxBlock-- )
+		{
+			pvBlock = pxPool->pucStart + ( ( size_t ) ( uxBlock - 1 ) * xClasses[ uxPool ].xBlockSize );
+
+			*( void ** ) pvBlock = pxPool->pvFreeList;
+			pxPool->pvFreeList = pvBlock;
+		}
+
+		pxPool->uxInUse = 0;
+		pxPool->uxMaxInUse = 0;
+		pxPool->ulFallbacks = 0;
+	}
+
+	xPoolsInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_BLOCK_POOLS */
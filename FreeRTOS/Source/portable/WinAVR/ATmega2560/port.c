@@ -85,6 +85,7 @@
 #include <stdlib.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/sleep.h>
 
 #include "FreeRTOS.h"
 #include "task.h"
@@ -102,6 +103,12 @@
 #define portPRESCALE_64							( ( uint8_t ) 0b00000011 )
 #define portCLOCK_PRESCALER						( ( uint32_t ) 64 )
 #define portCOMPARE_MATCH_A_INTERRUPT_ENABLE	( ( uint8_t ) 0b00000010 ) //( ( uint8_t ) 0x10 )
+#define portCOMPARE_MATCH_A_FLAG				( ( uint8_t ) 0b00000010 )
+
+/* Timer 1 counts in one tick period, and the most tick periods that fit in its
+16 bit compare register (262 with a 16MHz clock and a 1KHz tick). */
+#define portTIMER_COUNTS_PER_TICK				( ( uint16_t ) ( configCPU_CLOCK_HZ / configTICK_RATE_HZ / portCLOCK_PRESCALER ) )
+#define portMAX_SUPPRESSED_TICKS				( ( TickType_t ) ( 0xffffUL / portTIMER_COUNTS_PER_TICK ) )
 
 /*-----------------------------------------------------------*/
 
@@ -112,6 +119,35 @@ extern volatile TCB_t * volatile pxCurrentTCB;
 
 /*-----------------------------------------------------------*/
 
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* Index of the highest set bit of each value of the ready priority bit
+	map, used by portGET_HIGHEST_PRIORITY().  The idle task is always ready, so
+	the entry for 0 is never used. */
+	const uint8_t ucPortHighestBit[ 256 ] PROGMEM =
+	{
+		0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+		4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+		5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+		5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+		6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+		6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+		6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+		6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+	};
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+
+/*-----------------------------------------------------------*/
+
 /* 
  * Macro to save all the general purpose registers, the save the stack pointer
  * into the TCB.  
@@ -236,6 +272,28 @@ extern volatile TCB_t * volatile pxCurrentTCB;
 static void prvSetupTimerInterrupt( void );
 /*-----------------------------------------------------------*/
 
+#if configUSE_TICKLESS_IDLE == 1
+
+	/* Set by the tick interrupt so vPortSuppressTicksAndSleep() can tell
+	whether the sleep ran to the end of the expected idle time. */
+	static volatile uint8_t ucTickDuringSleep = pdFALSE;
+
+	/* Idle time and drift accounting, see vPortGetTicklessStats(). */
+	static PortTicklessStats_t xTicklessStats = { 0 };
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	/* Tick periods since the scheduler started, counted on entry to the tick
+	interrupt.  The kernel tick count can't be used as it is only incremented
+	part way through the interrupt, is held while the scheduler is suspended,
+	and is 16 bits. */
+	static volatile uint32_t ulRunTimeTicks = 0;
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
 /* 
  * See header file for description. 
  */
@@ -414,6 +472,12 @@ void vPortYieldFromTick( void ) __attribute__ ( ( naked ) );
 void vPortYieldFromTick( void )
 {
 	portSAVE_CONTEXT();
+	#if configUSE_TICKLESS_IDLE == 1
+		ucTickDuringSleep = pdTRUE;
+	#endif
+	#if configGENERATE_RUN_TIME_STATS == 1
+		ulRunTimeTicks++;
+	#endif
 	if( xTaskIncrementTick() != pdFALSE )
 	{
 		vTaskSwitchContext();
@@ -466,19 +530,298 @@ unsigned portCHAR ucHighByte, ucLowByte;
 }
 /*-----------------------------------------------------------*/
 
-#if configUSE_PREEMPTION == 1
+#if configUSE_TICKLESS_IDLE == 1
 
 	/*
-	 * Tick ISR for preemptive scheduler.  We can use a naked attribute as
-	 * the context is saved at the start of vPortYieldFromTick().  The tick
-	 * count is incremented after the context is saved.
+	 * Called from the idle task, with the scheduler suspended, when every other
+	 * task is blocked for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks.
+	 *
+	 * Timer 1 keeps running throughout.  Its compare value is moved out to the
+	 * end of the last idle tick period and the CPU is put into idle sleep, so
+	 * the only interrupt taken is the one that ends the sleep.  Timer 1 is
+	 * clocked from clkIO, which the deeper sleep modes stop, and the Arduino
+	 * MEGA has no watch crystal on TOSC1/2 to run timer 2 asynchronously, so
+	 * idle is the deepest mode that still keeps time.  Peripherals can be
+	 * powered down from configPRE_SLEEP_PROCESSING().
 	 */
-	ISR(TIMER1_COMPA_vect) __attribute__ ( ( signal, naked ) );
-	ISR(TIMER1_COMPA_vect)
+	void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime )
 	{
-		vPortYieldFromTick();
-		asm volatile ( "reti" );
+	TickType_t xModifiableIdleTime, xCompleteTickPeriods;
+	uint16_t usEntryCount, usCount, usElapsed;
+
+		if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+		{
+			xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+		}
+
+		portDISABLE_INTERRUPTS();
+
+		/* Don't sleep if a task was readied while the scheduler was suspended,
+		or if a tick is already waiting to be serviced. */
+		if( ( eTaskConfirmSleepModeStatus() == eAbortSleep ) || ( ( TIFR1 & portCOMPARE_MATCH_A_FLAG ) != 0 ) )
+		{
+			portENABLE_INTERRUPTS();
+			return;
+		}
+
+		/* TCNT1 holds the count into the current tick period, so the next
+		compare match is made to happen at the end of the last idle period. */
+		ucTickDuringSleep = pdFALSE;
+		usEntryCount = TCNT1;
+		OCR1A = ( uint16_t ) ( ( ( uint32_t ) portTIMER_COUNTS_PER_TICK * xExpectedIdleTime ) - 1UL );
+
+		if( ( TIFR1 & portCOMPARE_MATCH_A_FLAG ) != 0 )
+		{
+			/* The current period ended before the new compare value was
+			written.  The counter has already restarted, so put the tick
+			period back and let the pending interrupt run. */
+			OCR1A = portTIMER_COUNTS_PER_TICK - 1;
+			portENABLE_INTERRUPTS();
+			return;
+		}
+
+		xModifiableIdleTime = xExpectedIdleTime;
+		configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+		if( xModifiableIdleTime > 0 )
+		{
+			set_sleep_mode( SLEEP_MODE_IDLE );
+			sleep_enable();
+
+			/* The instruction following sei is always executed before any
+			pending interrupt, so a wake up cannot slip in between the two. */
+			asm volatile (	"sei		\n\t"
+							"sleep		\n\t" ::: "memory" );
+
+			sleep_disable();
+			portDISABLE_INTERRUPTS();
+		}
+		configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+		/* Work out how many whole tick periods passed.  If the compare match
+		ended the sleep the tick interrupt has already counted the last one.
+		The division is done while the timer is still running so it is only
+		stopped for the few instructions that put it back on the tick period. */
+		if( ucTickDuringSleep != pdFALSE )
+		{
+			xCompleteTickPeriods = xExpectedIdleTime - 1;
+			usElapsed = 0;
+		}
+		else
+		{
+			xCompleteTickPeriods = TCNT1 / portTIMER_COUNTS_PER_TICK;
+			usElapsed = xCompleteTickPeriods * portTIMER_COUNTS_PER_TICK;
+		}
+
+		TCCR1B = portCLEAR_COUNTER_ON_MATCH_TCCR1B;
+
+		if( ( ucTickDuringSleep == pdFALSE ) && ( ( TIFR1 & portCOMPARE_MATCH_A_FLAG ) != 0 ) )
+		{
+			/* The compare matched after TCNT1 was read.  The counter has
+			restarted and the pending interrupt will count the last period. */
+			xCompleteTickPeriods = xExpectedIdleTime - 1;
+			usElapsed = 0;
+		}
+
+		/* The period may have ended since TCNT1 was read.  A count left on the
+		compare value would not match, as writing TCNT1 blocks the next compare,
+		so that one is rounded into the next period a count early. */
+		usCount = TCNT1 - usElapsed;
+		if( usCount >= portTIMER_COUNTS_PER_TICK )
+		{
+			usCount -= portTIMER_COUNTS_PER_TICK;
+			xCompleteTickPeriods++;
+		}
+		else if( usCount == ( uint16_t ) ( portTIMER_COUNTS_PER_TICK - 1 ) )
+		{
+			usCount = 0;
+			xCompleteTickPeriods++;
+			xTicklessStats.ulDriftCounts++;
+		}
+		TCNT1 = usCount;
+		OCR1A = portTIMER_COUNTS_PER_TICK - 1;
+		TCCR1B = portCLEAR_COUNTER_ON_MATCH_TCCR1B | portPRESCALE_64;
+
+		/* Stopping the timer loses at most one count. */
+		xTicklessStats.ulDriftCounts++;
+		xTicklessStats.ulSleeps++;
+		if( ucTickDuringSleep == pdFALSE )
+		{
+			xTicklessStats.ulEarlyWakes++;
+		}
+		xTicklessStats.ulTicksSuppressed += xCompleteTickPeriods;
+		xTicklessStats.ulSleepCounts += ( ( uint32_t ) xCompleteTickPeriods * portTIMER_COUNTS_PER_TICK ) + usCount - usEntryCount;
+		if( ucTickDuringSleep != pdFALSE )
+		{
+			xTicklessStats.ulSleepCounts += portTIMER_COUNTS_PER_TICK;
+		}
+
+		#if configGENERATE_RUN_TIME_STATS == 1
+			ulRunTimeTicks += xCompleteTickPeriods;
+		#endif
+
+		vTaskStepTick( xCompleteTickPeriods );
+		portENABLE_INTERRUPTS();
 	}
+	/*-----------------------------------------------------------*/
+
+	void vPortGetTicklessStats( PortTicklessStats_t *pxStats )
+	{
+		portENTER_CRITICAL();
+		{
+			*pxStats = xTicklessStats;
+		}
+		portEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	/*
+	 * Called by the kernel on every context switch.  ulRunTimeTicks gives
+	 * whole tick periods and TCNT1 the time into the current one.  A compare
+	 * match that has not been serviced yet means TCNT1 has already restarted
+	 * from 0 but ulRunTimeTicks has not been incremented.
+	 */
+	uint32_t ulPortGetRunTimeCounterValue( void )
+	{
+	uint16_t usCount;
+	uint32_t ulTicks;
+
+		portENTER_CRITICAL();
+		{
+			usCount = TCNT1;
+			ulTicks = ulRunTimeTicks;
+
+			if( ( TIFR1 & portCOMPARE_MATCH_A_FLAG ) != 0 )
+			{
+				usCount = TCNT1;
+				ulTicks++;
+			}
+		}
+		portEXIT_CRITICAL();
+
+		return ( ulTicks * portTIMER_COUNTS_PER_TICK ) + usCount;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
+#if configUSE_PREEMPTION == 1
+
+	#if portUSE_FAST_TICK_ISR == 1
+
+		/*
+		 * Save and restore only the registers the compiler allows a called
+		 * function to change (plus r0, SREG and RAMPZ), in the order
+		 * portSAVE_CONTEXT() would push them.
+		 */
+		#define portSAVE_TICK_CLOBBERED				\
+						"push	r0				\n\t"	\
+						"in		r0, __SREG__	\n\t"	\
+						"push	r0				\n\t"	\
+						"in		r0, 0x3b		\n\t"	\
+						"push	r0				\n\t"	\
+						"push	r1				\n\t"	\
+						"clr	r1				\n\t"	\
+						"push	r18				\n\t"	\
+						"push	r19				\n\t"	\
+						"push	r20				\n\t"	\
+						"push	r21				\n\t"	\
+						"push	r22				\n\t"	\
+						"push	r23				\n\t"	\
+						"push	r24				\n\t"	\
+						"push	r25				\n\t"	\
+						"push	r26				\n\t"	\
+						"push	r27				\n\t"	\
+						"push	r30				\n\t"	\
+						"push	r31				\n\t"
+
+		#define portRESTORE_TICK_CLOBBERED			\
+						"pop	r31				\n\t"	\
+						"pop	r30				\n\t"	\
+						"pop	r27				\n\t"	\
+						"pop	r26				\n\t"	\
+						"pop	r25				\n\t"	\
+						"pop	r24				\n\t"	\
+						"pop	r23				\n\t"	\
+						"pop	r22				\n\t"	\
+						"pop	r21				\n\t"	\
+						"pop	r20				\n\t"	\
+						"pop	r19				\n\t"	\
+						"pop	r18				\n\t"	\
+						"pop	r1				\n\t"	\
+						"pop	r0				\n\t"	\
+						"out	0x3b, r0		\n\t"	\
+						"pop	r0				\n\t"	\
+						"out	__SREG__, r0	\n\t"	\
+						"pop	r0				\n\t"
+
+		/*
+		 * Tick ISR for preemptive scheduler.  Most ticks don't switch context,
+		 * so only the call clobbered registers are saved around the call to
+		 * xTaskIncrementTick().  When a switch is required that partial frame
+		 * is unwound again and the full context saved exactly as
+		 * vPortYieldFromTick() would have saved it, so every task stack holds
+		 * the same frame layout.
+		 */
+		ISR(TIMER1_COMPA_vect) __attribute__ ( ( signal, naked ) );
+		ISR(TIMER1_COMPA_vect)
+		{
+			asm volatile (	portSAVE_TICK_CLOBBERED );
+
+			#if configUSE_TICKLESS_IDLE == 1
+				asm volatile (	"ldi	r24, 1			\n\t"
+								"sts	%0, r24			\n\t"
+								:: "i" ( &ucTickDuringSleep ) );
+			#endif
+
+			#if configGENERATE_RUN_TIME_STATS == 1
+				asm volatile (	"lds	r24, %0			\n\t"
+								"lds	r25, %0+1		\n\t"
+								"lds	r26, %0+2		\n\t"
+								"lds	r27, %0+3		\n\t"
+								"adiw	r24, 1			\n\t"
+								"adc	r26, r1			\n\t"
+								"adc	r27, r1			\n\t"
+								"sts	%0, r24			\n\t"
+								"sts	%0+1, r25		\n\t"
+								"sts	%0+2, r26		\n\t"
+								"sts	%0+3, r27		\n\t"
+								:: "i" ( &ulRunTimeTicks ) );
+			#endif
+
+			asm volatile (	"call	xTaskIncrementTick	\n\t"
+							"tst	r24				\n\t"
+							"brne	1f				\n\t"
+							portRESTORE_TICK_CLOBBERED
+							"reti					\n\t"
+							"1:						\n\t"
+							portRESTORE_TICK_CLOBBERED );
+
+			portSAVE_CONTEXT();
+			vTaskSwitchContext();
+			portRESTORE_CONTEXT();
+
+			asm volatile ( "reti" );
+		}
+
+	#else
+
+		/*
+		 * Tick ISR for preemptive scheduler.  We can use a naked attribute as
+		 * the context is saved at the start of vPortYieldFromTick().  The tick
+		 * count is incremented after the context is saved.
+		 */
+		ISR(TIMER1_COMPA_vect) __attribute__ ( ( signal, naked ) );
+		ISR(TIMER1_COMPA_vect)
+		{
+			vPortYieldFromTick();
+			asm volatile ( "reti" );
+		}
+
+	#endif /* portUSE_FAST_TICK_ISR */
 #else
 
 	/*
@@ -489,6 +832,12 @@ unsigned portCHAR ucHighByte, ucLowByte;
 	void SIG_OUTPUT_COMPARE1A( void ) __attribute__ ( ( signal ) );
 	void SIG_OUTPUT_COMPARE1A( void )
 	{
+		#if configUSE_TICKLESS_IDLE == 1
+			ucTickDuringSleep = pdTRUE;
+		#endif
+		#if configGENERATE_RUN_TIME_STATS == 1
+			ulRunTimeTicks++;
+		#endif
 		xTaskIncrementTick();
 	}
 #endif
@@ -134,6 +134,11 @@ typedef unsigned char UBaseType_t;
 
 #define portDISABLE_INTERRUPTS()	cli(); //asm volatile ( "cli" :: );
 #define portENABLE_INTERRUPTS()		sei(); //asm volatile ( "sei" :: );
+
+/* Save SREG and disable interrupts, for code that can run either in a task or
+in an interrupt. */
+#define portSET_INTERRUPT_MASK_FROM_ISR()	__extension__ ( { UBaseType_t uxSavedSREG = SREG; cli(); uxSavedSREG; } )
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedStatusValue )	do { asm volatile ( "" ::: "memory" ); SREG = ( uxSavedStatusValue ); } while( 0 )
 /*-----------------------------------------------------------*/
 
 /* Architecture specifics. */
@@ -148,6 +153,74 @@ extern void vPortYield( void ) __attribute__ ( ( naked ) );
 #define portYIELD()					vPortYield()
 /*-----------------------------------------------------------*/
 
+/* Set to 0 to save the full context on every tick interrupt rather than only
+when the tick causes a context switch. */
+#ifndef portUSE_FAST_TICK_ISR
+	#define portUSE_FAST_TICK_ISR		1
+#endif
+/*-----------------------------------------------------------*/
+
+/* Run time stats.  The counter is the tick count in units of timer 1 counts
+(4us at 16MHz) plus the current timer 1 count. */
+#if configGENERATE_RUN_TIME_STATS == 1
+
+	extern uint32_t ulPortGetRunTimeCounterValue( void );
+	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+	#define portGET_RUN_TIME_COUNTER_VALUE()		ulPortGetRunTimeCounterValue()
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+/*-----------------------------------------------------------*/
+
+/* Tickless idle/low power functionality. */
+#if configUSE_TICKLESS_IDLE == 1
+
+	/* Counters kept by vPortSuppressTicksAndSleep().  Timer 1 counts are
+	portCLOCK_PRESCALER (64) CPU cycles long. */
+	typedef struct xPORT_TICKLESS_STATS
+	{
+		uint32_t ulSleeps;			/* Times the tick was suppressed. */
+		uint32_t ulEarlyWakes;		/* Sleeps ended by an interrupt other than the tick. */
+		uint32_t ulTicksSuppressed;	/* Tick interrupts that were not taken. */
+		uint32_t ulSleepCounts;		/* Timer 1 counts spent asleep. */
+		uint32_t ulDriftCounts;		/* Upper bound on the timer 1 counts lost, and so on the drift of the tick count. */
+	} PortTicklessStats_t;
+
+	extern void vPortSuppressTicksAndSleep( TickType_t xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+
+	void vPortGetTicklessStats( PortTicklessStats_t *pxStats );
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+/* Architecture specific optimisations. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#endif
+
+#if configUSE_PORT_OPTIMISED_TASK_SELECTION == 1
+
+	/* The ready priorities are kept as a bit map in the 8 bit
+	uxTopReadyPriority. */
+	#if( configMAX_PRIORITIES > 8 )
+		#error configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when configMAX_PRIORITIES is less than or equal to 8.
+	#endif
+
+	#include <avr/pgmspace.h>
+
+	/* The AVR has no count leading zeros instruction, so the highest set bit
+	is looked up in a table held in flash (see port.c). */
+	extern const uint8_t ucPortHighestBit[ 256 ] PROGMEM;
+
+	/* Store/clear the ready priorities in a bit map. */
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( UBaseType_t ) ( 1U << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ( UBaseType_t ) ~( 1U << ( uxPriority ) )
+
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = pgm_read_byte( &( ucPortHighestBit[ ( uxReadyPriorities ) ] ) )
+
+#endif /* configUSE_PORT_OPTIMISED_TASK_SELECTION */
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
@@ -94,6 +94,15 @@ privileged Vs unprivileged linkage and placement. */
 #define queueUNLOCKED					( ( int8_t ) -1 )
 #define queueLOCKED_UNMODIFIED			( ( int8_t ) 0 )
 
+/* Bits of the ucSlotsHeld structure member.  While a slot is acquired the
+queue is full to every sender, as the next item posted has to go in that slot.
+While an item is borrowed the queue is empty to every receiver, and full to
+sends to the front and overwrites, which would move the read position or write
+over the item. */
+#define queueSLOT_ACQUIRED				( ( uint8_t ) 0x01 )
+#define queueSLOT_BORROWED				( ( uint8_t ) 0x02 )
+#define queueSLOTS_STOPPING_SEND( xCopyPosition )	( ( ( xCopyPosition ) == queueSEND_TO_BACK ) ? queueSLOT_ACQUIRED : ( uint8_t ) ( queueSLOT_ACQUIRED | queueSLOT_BORROWED ) )
+
 /* When the Queue_t structure is used to represent a base queue its pcHead and
 pcTail members are used as pointers into the queue storage area.  When the
 Queue_t structure is used to represent a mutex pcHead and pcTail pointers are
@@ -105,7 +114,7 @@ alternative implementation would be to use a union, but use of a union is
 against the coding standard (although an exception to the standard has been
 permitted where the dual use also significantly changes the type of the
 structure member). */
-#define pxMutexHolder					pcTail
+#define pxMutexHolder					t.pcTail
 #define uxQueueType						pcHead
 #define queueQUEUE_IS_MUTEX				NULL
 
@@ -130,14 +139,15 @@ zero. */
 typedef struct QueueDefinition
 {
 	int8_t *pcHead;					/*< Points to the beginning of the queue storage area. */
-	int8_t *pcTail;					/*< Points to the byte at the end of the queue storage area.  Once more byte is allocated than necessary to store the queue items, this is used as a marker. */
-	int8_t *pcWriteTo;				/*< Points to the free next place in the storage area. */
-
-	union							/* Use of a union is an exception to the coding standard to ensure two mutually exclusive structure members don't appear simultaneously (wasting RAM). */
+	union							/* Use of a union is an exception to the coding standard, as a queue that uses indices has no pcTail. */
 	{
-		int8_t *pcReadFrom;			/*< Points to the last place that a queued item was read from when the structure is used as a queue. */
-		UBaseType_t uxRecursiveCallCount;/*< Maintains a count of the number of times a recursive mutex has been recursively 'taken' when the structure is used as a mutex. */
-	} u;
+		int8_t *pcTail;				/*< Points to the byte at the end of the queue storage area.  Once more byte is allocated than necessary to store the queue items, this is used as a marker. */
+		struct
+		{
+			uint8_t ucWriteIndex;	/*< The item the next send to the back writes to, in a queue that uses indices. */
+			uint8_t ucReadIndex;	/*< The item last read from, in a queue that uses indices. */
+		} xIndices;
+	} t;
 
 	List_t xTasksWaitingToSend;		/*< List of tasks that are blocked waiting to post onto this queue.  Stored in priority order. */
 	List_t xTasksWaitingToReceive;	/*< List of tasks that are blocked waiting to read from this queue.  Stored in priority order. */
@@ -148,6 +158,7 @@ typedef struct QueueDefinition
 
 	volatile int8_t cRxLock;		/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	volatile int8_t cTxLock;		/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
+	volatile uint8_t ucSlotsHeld;	/*< queueSLOT_ACQUIRED while a slot returned by pvQueueAcquireSlot() is not yet committed, and queueSLOT_BORROWED while an item returned by pvQueueBorrowSlot() is not yet released. */
 
 	#if( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) )
 		uint8_t ucStaticallyAllocated;	/*< Set to pdTRUE if the memory used by the queue was statically allocated to ensure no attempt is made to free the memory. */
@@ -162,12 +173,90 @@ typedef struct QueueDefinition
 		uint8_t ucQueueType;
 	#endif
 
+	#if( configUSE_QUEUE_INDICES == 0 )
+		/* The members below are left out of a byte queue, so must stay last. */
+		int8_t *pcWriteTo;				/*< Points to the free next place in the storage area. */
+
+		union							/* Use of a union is an exception to the coding standard to ensure two mutually exclusive structure members don't appear simultaneously (wasting RAM). */
+		{
+			int8_t *pcReadFrom;			/*< Points to the last place that a queued item was read from when the structure is used as a queue. */
+			UBaseType_t uxRecursiveCallCount;/*< Maintains a count of the number of times a recursive mutex has been recursively 'taken' when the structure is used as a mutex. */
+		} u;
+	#elif( configUSE_RECURSIVE_MUTEXES == 1 )
+		union
+		{
+			UBaseType_t uxRecursiveCallCount;/*< Maintains a count of the number of times a recursive mutex has been recursively 'taken' when the structure is used as a mutex. */
+		} u;
+	#endif
+
 } xQUEUE;
 
 /* The old xQUEUE name is maintained above then typedefed to the new Queue_t
 name below to enable the use of older kernel aware debuggers. */
 typedef xQUEUE Queue_t;
 
+/* A queue that uses indices keeps the positions it writes to and last read
+from as item indices, in t.xIndices in place of pcTail, rather than as the
+pcWriteTo and pcReadFrom pointers, and derives pointers from pcHead when it
+needs them - which limits it to 255 items.  The paths taken by every item
+(prvCopyDataToQueue() to the back, prvCopyDataFromQueue() and the ISR versions
+of both) move the indices directly, and the others use queueGET_TAIL(),
+queueGET_WRITE_TO(), prvNextReadSlot() and prvAdvanceWriteTo() or
+prvAdvanceReadFrom(), which work for both kinds of queue.
+
+With configUSE_QUEUE_INDICES set to 1 every queue uses indices, and Queue_t
+has no pcWriteTo or pcReadFrom.  Otherwise, with configUSE_BYTE_QUEUES set to 1,
+only byte queues (queues of 1 byte items) do, and a byte queue is a Queue_t
+that stops short of pcWriteTo, so is allocated without the two pointers.
+
+Byte queues also copy their items by assignment rather than memcpy(). */
+#if( configUSE_BYTE_QUEUES == 1 )
+	#define queueIS_BYTE_QUEUE( pxQueue )	( ( pxQueue )->uxItemSize == ( UBaseType_t ) 1U )
+#else
+	#define queueIS_BYTE_QUEUE( pxQueue )	( pdFALSE )
+#endif
+
+#define queueWRITE_INDEX( pxQueue )			( ( pxQueue )->t.xIndices.ucWriteIndex )
+#define queueREAD_INDEX( pxQueue )			( ( pxQueue )->t.xIndices.ucReadIndex )
+#define queueNEXT_INDEX( pxQueue, ucIndex )	( ( ( UBaseType_t ) ( ucIndex ) >= ( ( pxQueue )->uxLength - ( UBaseType_t ) 1U ) ) ? ( uint8_t ) 0U : ( uint8_t ) ( ( ucIndex ) + 1U ) )
+#define queueINDEX_TO_ITEM( pxQueue, uxIndex )	( ( pxQueue )->pcHead + ( ( size_t ) ( uxIndex ) * ( size_t ) ( pxQueue )->uxItemSize ) )
+
+#if( configUSE_QUEUE_INDICES == 1 )
+	#define queueUSES_INDICES( pxQueue )	( pdTRUE )
+	#define queueBYTE_QUEUE_SIZE			( sizeof( Queue_t ) )
+	#define queueGET_TAIL( pxQueue )		queueINDEX_TO_ITEM( ( pxQueue ), ( pxQueue )->uxLength )
+	#define queueGET_WRITE_TO( pxQueue )	queueINDEX_TO_ITEM( ( pxQueue ), queueWRITE_INDEX( pxQueue ) )
+
+	/* The size Queue_t would be with pcWriteTo and pcReadFrom. */
+	#if( configUSE_RECURSIVE_MUTEXES == 1 )
+		#define queuePOINTER_QUEUE_SIZE		( sizeof( Queue_t ) + ( 2U * sizeof( int8_t * ) ) - sizeof( UBaseType_t ) )
+	#else
+		#define queuePOINTER_QUEUE_SIZE		( sizeof( Queue_t ) + ( 2U * sizeof( int8_t * ) ) )
+	#endif
+#else
+	#define queueUSES_INDICES( pxQueue )	queueIS_BYTE_QUEUE( pxQueue )
+	#define queueBYTE_QUEUE_SIZE			( offsetof( Queue_t, pcWriteTo ) )
+	#define queueGET_TAIL( pxQueue )		( queueIS_BYTE_QUEUE( pxQueue ) ? ( ( pxQueue )->pcHead + ( pxQueue )->uxLength ) : ( pxQueue )->t.pcTail )
+	#define queueGET_WRITE_TO( pxQueue )	( queueIS_BYTE_QUEUE( pxQueue ) ? ( ( pxQueue )->pcHead + queueWRITE_INDEX( pxQueue ) ) : ( pxQueue )->pcWriteTo )
+	#define queuePOINTER_QUEUE_SIZE			( sizeof( Queue_t ) )
+#endif
+
+/* Copy one byte to the back of, or from the front of, a byte queue that is
+known to have space or data.  Neither updates uxMessagesWaiting. */
+#define queueBYTE_QUEUE_SEND( pxQueue, pvItemToQueue )								\
+	{																				\
+	uint8_t ucWriteTo = queueWRITE_INDEX( pxQueue );								\
+		( pxQueue )->pcHead[ ucWriteTo ] = *( ( const int8_t * ) ( pvItemToQueue ) );	\
+		queueWRITE_INDEX( pxQueue ) = queueNEXT_INDEX( ( pxQueue ), ucWriteTo );	\
+	}
+
+#define queueBYTE_QUEUE_RECEIVE( pxQueue, pvBuffer )								\
+	{																				\
+	uint8_t ucReadFrom = queueNEXT_INDEX( ( pxQueue ), queueREAD_INDEX( pxQueue ) );	\
+		queueREAD_INDEX( pxQueue ) = ucReadFrom;									\
+		*( ( int8_t * ) ( pvBuffer ) ) = ( pxQueue )->pcHead[ ucReadFrom ];			\
+	}
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -197,6 +286,20 @@ typedef xQUEUE Queue_t;
 
 #endif /* configQUEUE_REGISTRY_SIZE */
 
+#if( configUSE_QUEUE_RAM_STATS == 1 )
+
+	/* The RAM used by the queues, semaphores and mutexes that exist, as
+	returned by vQueueGetRAMStats(). */
+	PRIVILEGED_DATA static QueueRAMStats_t xQueueRAMStats = { ( UBaseType_t ) 0U, ( size_t ) 0U, ( size_t ) 0U, ( size_t ) 0U };
+
+	/*
+	 * Add a queue being created to xQueueRAMStats, or take one being deleted
+	 * out.
+	 */
+	static void prvUpdateRAMStats( const Queue_t * const pxQueue, const BaseType_t xCreated ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_QUEUE_RAM_STATS */
+
 /*
  * Unlocks a queue locked by a call to prvLockQueue.  Locking a queue does not
  * prevent an ISR from adding or removing items to the queue, but does prevent
@@ -232,6 +335,62 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Copies the next item out of a queue without removing it.
+ */
+static void prvPeekDataFromQueue( const Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy uxItems items to the back of a queue, or out of the front of a queue,
+ * with at most two calls to memcpy() - the second only where the items wrap
+ * round the end of the storage area.  The caller has checked they fit.
+ */
+static void prvCopyItemsToQueue( Queue_t * const pxQueue, const void *pvItemsToQueue, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+static void prvCopyItemsFromQueue( Queue_t * const pxQueue, void * const pvBuffer, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+
+/*
+ * The blocking step of xQueueGenericSend() (xSending pdTRUE) and
+ * xQueueGenericReceive() (xSending pdFALSE), for the calls added alongside
+ * them: block on the queue if it is still full (or empty) and the timeout has
+ * not expired.  Returns pdFALSE if the timeout has expired with the queue
+ * still full (or empty), otherwise pdTRUE to try again.
+ */
+static BaseType_t prvWaitOnQueue( Queue_t * const pxQueue, const BaseType_t xSending, TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * The slot at the write position is filled in place, or the slot after the
+ * read position has been used in place - move past it.
+ */
+static void prvCommitSlot( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+static void prvReleaseSlot( Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called once a slot is committed or released, to unblock a task that was
+ * kept waiting on pxEventList only because the slot was held - a sender after
+ * a commit, or a receiver after a release.  If the queue is locked *pcLock
+ * (cRxLock for senders, cTxLock for receivers) is incremented instead, so the
+ * task that unlocks the queue unblocks one.  Returns pdTRUE if the task
+ * unblocked has a higher priority than the running task.
+ */
+static BaseType_t prvUnblockHeldBack( List_t * const pxEventList, volatile int8_t * const pcLock ) PRIVILEGED_FUNCTION;
+
+/*
+ * The slot the next item will be read from.
+ */
+static int8_t *prvNextReadSlot( const Queue_t * const pxQueue ) PRIVILEGED_FUNCTION;
+
+/*
+ * Move the write position, or the read position, of a queue on by uxItems
+ * items, which is no more than the length of the queue.
+ */
+static void prvAdvanceWriteTo( Queue_t * const pxQueue, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+static void prvAdvanceReadFrom( Queue_t * const pxQueue, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+
+/*
+ * ucIndex moved on by uxItems items in a queue that uses indices.
+ */
+static uint8_t prvAdvanceIndex( const Queue_t * const pxQueue, const uint8_t ucIndex, const UBaseType_t uxItems ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -284,12 +443,25 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 	taskENTER_CRITICAL();
 	{
-		pxQueue->pcTail = pxQueue->pcHead + ( pxQueue->uxLength * pxQueue->uxItemSize );
+		if( queueUSES_INDICES( pxQueue ) )
+		{
+			queueWRITE_INDEX( pxQueue ) = ( uint8_t ) 0U;
+			queueREAD_INDEX( pxQueue ) = ( uint8_t ) ( pxQueue->uxLength - ( UBaseType_t ) 1U );
+		}
+		else
+		{
+			#if( configUSE_QUEUE_INDICES == 0 )
+			{
+				pxQueue->t.pcTail = pxQueue->pcHead + ( pxQueue->uxLength * pxQueue->uxItemSize );
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+				pxQueue->u.pcReadFrom = pxQueue->pcHead + ( ( pxQueue->uxLength - ( UBaseType_t ) 1U ) * pxQueue->uxItemSize );
+			}
+			#endif
+		}
 		pxQueue->uxMessagesWaiting = ( UBaseType_t ) 0U;
-		pxQueue->pcWriteTo = pxQueue->pcHead;
-		pxQueue->u.pcReadFrom = pxQueue->pcHead + ( ( pxQueue->uxLength - ( UBaseType_t ) 1U ) * pxQueue->uxItemSize );
 		pxQueue->cRxLock = queueUNLOCKED;
 		pxQueue->cTxLock = queueUNLOCKED;
+		pxQueue->ucSlotsHeld = ( uint8_t ) 0U;
 
 		if( xNewQueue == pdFALSE )
 		{
@@ -353,6 +525,15 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			the real queue and semaphore structures. */
 			volatile size_t xSize = sizeof( StaticQueue_t );
 			configASSERT( xSize == sizeof( Queue_t ) );
+
+			#if( configUSE_BYTE_QUEUES == 1 )
+			{
+				/* The same for StaticByteQueue_t, which is only big enough for
+				a byte queue. */
+				xSize = sizeof( StaticByteQueue_t );
+				configASSERT( xSize == queueBYTE_QUEUE_SIZE );
+			}
+			#endif
 		}
 		#endif /* configASSERT_DEFINED */
 
@@ -386,7 +567,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	QueueHandle_t xQueueGenericCreate( const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, const uint8_t ucQueueType )
 	{
 	Queue_t *pxNewQueue;
-	size_t xQueueSizeInBytes;
+	size_t xQueueSizeInBytes, xStructureSize;
 	uint8_t *pucQueueStorage;
 
 		configASSERT( uxQueueLength > ( UBaseType_t ) 0 );
@@ -403,13 +584,23 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			xQueueSizeInBytes = ( size_t ) ( uxQueueLength * uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
 		}
 
-		pxNewQueue = ( Queue_t * ) pvPortMalloc( sizeof( Queue_t ) + xQueueSizeInBytes );
+		if( ( configUSE_BYTE_QUEUES == 1 ) && ( uxItemSize == ( UBaseType_t ) 1U ) )
+		{
+			/* A byte queue leaves out the end of the queue structure. */
+			xStructureSize = queueBYTE_QUEUE_SIZE;
+		}
+		else
+		{
+			xStructureSize = sizeof( Queue_t );
+		}
+
+		pxNewQueue = ( Queue_t * ) pvPortMalloc( xStructureSize + xQueueSizeInBytes );
 
 		if( pxNewQueue != NULL )
 		{
 			/* Jump past the queue structure to find the location of the queue
 			storage area. */
-			pucQueueStorage = ( ( uint8_t * ) pxNewQueue ) + sizeof( Queue_t );
+			pucQueueStorage = ( ( uint8_t * ) pxNewQueue ) + xStructureSize;
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -453,8 +644,23 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 	defined. */
 	pxNewQueue->uxLength = uxQueueLength;
 	pxNewQueue->uxItemSize = uxItemSize;
+
+	#if( ( configUSE_BYTE_QUEUES == 1 ) || ( configUSE_QUEUE_INDICES == 1 ) )
+	{
+		/* Indices are 8 bit, so check before xQueueGenericReset() sets them.
+		Semaphores and mutexes do not use theirs. */
+		configASSERT( !( queueUSES_INDICES( pxNewQueue ) && ( uxItemSize != ( UBaseType_t ) 0U ) && ( uxQueueLength > ( UBaseType_t ) 255U ) ) );
+	}
+	#endif
+
 	( void ) xQueueGenericReset( pxNewQueue, pdTRUE );
 
+	#if( configUSE_QUEUE_RAM_STATS == 1 )
+	{
+		prvUpdateRAMStats( pxNewQueue, pdTRUE );
+	}
+	#endif
+
 	#if ( configUSE_TRACE_FACILITY == 1 )
 	{
 		pxNewQueue->ucQueueType = ucQueueType;
@@ -484,8 +690,13 @@ static void prvInitialiseNewQueue( const UBaseType_t uxQueueLength, const UBaseT
 			pxNewQueue->pxMutexHolder = NULL;
 			pxNewQueue->uxQueueType = queueQUEUE_IS_MUTEX;
 
-			/* In case this is a recursive mutex. */
-			pxNewQueue->u.uxRecursiveCallCount = 0;
+			/* In case this is a recursive mutex.  Without recursive mutexes
+			a queue that uses indices has no u. */
+			#if( configUSE_RECURSIVE_MUTEXES == 1 )
+			{
+				pxNewQueue->u.uxRecursiveCallCount = 0;
+			}
+			#endif
 
 			traceCREATE_MUTEX( pxNewQueue );
 
@@ -746,8 +957,8 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			/* Is there room on the queue now?  The running task must be the
 			highest priority task wanting to access the queue.  If the head item
 			in the queue is to be overwritten then it does not matter if the
-			queue is full. */
-			if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
+			queue is full.  Nothing is posted over a slot that is held. */
+			if( ( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) ) && ( ( pxQueue->ucSlotsHeld & queueSLOTS_STOPPING_SEND( xCopyPosition ) ) == 0U ) )
 			{
 				traceQUEUE_SEND( pxQueue );
 				xYieldRequired = prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
@@ -876,7 +1087,7 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		/* Update the timeout state to see if it has expired yet. */
 		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
-			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			if( ( prvIsQueueFull( pxQueue ) != pdFALSE ) || ( ( pxQueue->ucSlotsHeld & queueSLOTS_STOPPING_SEND( xCopyPosition ) ) != 0U ) )
 			{
 				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
@@ -918,158 +1129,496 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xQueueGenericSendFromISR( QueueHandle_t xQueue, const void * const pvItemToQueue, BaseType_t * const pxHigherPriorityTaskWoken, const BaseType_t xCopyPosition )
+UBaseType_t xQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItemsToQueue, UBaseType_t uxItems, TickType_t xTicksToWait )
 {
-BaseType_t xReturn;
-UBaseType_t uxSavedInterruptStatus;
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxSpaces;
 Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 	configASSERT( pxQueue );
-	configASSERT( !( ( pvItemToQueue == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
-	configASSERT( !( ( xCopyPosition == queueOVERWRITE ) && ( pxQueue->uxLength != 1 ) ) );
-
-	/* RTOS ports that support interrupt nesting have the concept of a maximum
-	system call (or maximum API call) interrupt priority.  Interrupts that are
-	above the maximum system call priority are kept permanently enabled, even
-	when the RTOS kernel is in a critical section, but cannot make any calls to
-	FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
-	then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
-	failure if a FreeRTOS API function is called from an interrupt that has been
-	assigned a priority above the configured maximum system call priority.
-	Only FreeRTOS functions that end in FromISR can be called from interrupts
-	that have been assigned a priority at or (logically) below the maximum
-	system call	interrupt priority.  FreeRTOS maintains a separate interrupt
-	safe API to ensure interrupt entry is as fast and as simple as possible.
-	More information (albeit Cortex-M specific) is provided on the following
-	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
-	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+	configASSERT( !( ( pvItemsToQueue == NULL ) && ( uxItems != ( UBaseType_t ) 0U ) ) );
 
-	/* Similar to xQueueGenericSend, except without blocking if there is no room
-	in the queue.  Also don't directly wake a task that was blocked on a queue
-	read, instead return a flag to say whether a context switch is required or
-	not (i.e. has a task with a higher priority than us been woken by this
-	post). */
-	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	/* Semaphores and mutexes hold no data, and a queue set would have to be
+	told about every item. */
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( configUSE_QUEUE_SETS == 1 )
 	{
-		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) )
-		{
-			const int8_t cTxLock = pxQueue->cTxLock;
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
+	}
+	#endif
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
 
-			traceQUEUE_SEND_FROM_ISR( pxQueue );
+	if( uxItems == ( UBaseType_t ) 0U )
+	{
+		return 0;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-			/* Semaphores use xQueueGiveFromISR(), so pxQueue will not be a
-			semaphore or mutex.  That means prvCopyDataToQueue() cannot result
-			in a task disinheriting a priority and prvCopyDataToQueue() can be
-			called here even though the disinherit function does not check if
-			the scheduler is suspended before accessing the ready lists. */
-			( void ) prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
+	/* As xQueueGenericSend(), but posting as many of the items as there is
+	space for in one go. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) == 0U )
+			{
+				uxSpaces = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+			}
+			else
+			{
+				/* The next item has to go in the acquired slot. */
+				uxSpaces = 0;
+			}
 
-			/* The event list is not altered if the queue is locked.  This will
-			be done when the queue is unlocked later. */
-			if( cTxLock == queueUNLOCKED )
+			if( uxSpaces > ( UBaseType_t ) 0 )
 			{
-				#if ( configUSE_QUEUE_SETS == 1 )
+				if( uxItems < uxSpaces )
 				{
-					if( pxQueue->pxQueueSetContainer != NULL )
-					{
-						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
-						{
-							/* The queue is a member of a queue set, and posting
-							to the queue set caused a higher priority task to
-							unblock.  A context switch is required. */
-							if( pxHigherPriorityTaskWoken != NULL )
-							{
-								*pxHigherPriorityTaskWoken = pdTRUE;
-							}
-							else
-							{
-								mtCOVERAGE_TEST_MARKER();
-							}
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
-					}
-					else
-					{
-						if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
-						{
-							if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
-							{
-								/* The task waiting has a higher priority so
-								record that a context switch is required. */
-								if( pxHigherPriorityTaskWoken != NULL )
-								{
-									*pxHigherPriorityTaskWoken = pdTRUE;
-								}
-								else
-								{
-									mtCOVERAGE_TEST_MARKER();
-								}
-							}
-							else
-							{
-								mtCOVERAGE_TEST_MARKER();
-							}
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
-					}
+					uxSpaces = uxItems;
 				}
-				#else /* configUSE_QUEUE_SETS */
+				else
 				{
-					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				traceQUEUE_SEND( pxQueue );
+				prvCopyItemsToQueue( pxQueue, pvItemsToQueue, uxSpaces );
+
+				/* Only the highest priority task waiting for data is woken,
+				however many items were posted. */
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
 					{
-						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
-						{
-							/* The task waiting has a higher priority so record that a
-							context	switch is required. */
-							if( pxHigherPriorityTaskWoken != NULL )
-							{
-								*pxHigherPriorityTaskWoken = pdTRUE;
-							}
-							else
-							{
-								mtCOVERAGE_TEST_MARKER();
-							}
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
+						queueYIELD_IF_USING_PREEMPTION();
 					}
 					else
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
-				#endif /* configUSE_QUEUE_SETS */
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return uxSpaces;
 			}
 			else
 			{
-				/* Increment the lock count so the task that unlocks the queue
-				knows that data was posted while it was locked. */
-				pxQueue->cTxLock = ( int8_t ) ( cTxLock + 1 );
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					taskEXIT_CRITICAL();
+					traceQUEUE_SEND_FAILED( pxQueue );
+					return 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					vTaskSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
-
-			xReturn = pdPASS;
 		}
-		else
+		taskEXIT_CRITICAL();
+
+		if( prvWaitOnQueue( pxQueue, pdTRUE, &xTimeOut, &xTicksToWait ) == pdFALSE )
 		{
-			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
-			xReturn = errQUEUE_FULL;
+			traceQUEUE_SEND_FAILED( pxQueue );
+			return 0;
 		}
 	}
-	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
-
-	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
+void *pvQueueAcquireSlot( QueueHandle_t xQueue, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( configUSE_QUEUE_SETS == 1 )
+	{
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
+	}
+	#endif
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) == 0U ) )
+			{
+				/* Nothing else posts to the queue until the slot is
+				committed, so the space cannot be taken meanwhile. */
+				pxQueue->ucSlotsHeld |= queueSLOT_ACQUIRED;
+				taskEXIT_CRITICAL();
+
+				return ( void * ) queueGET_WRITE_TO( pxQueue );
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				taskEXIT_CRITICAL();
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return NULL;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( prvWaitOnQueue( pxQueue, pdTRUE, &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			traceQUEUE_SEND_FAILED( pxQueue );
+			return NULL;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vQueueCommitSlot( QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+
+	taskENTER_CRITICAL();
+	{
+		/* There must be a slot acquired, so the queue cannot be full. */
+		configASSERT( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) != 0U );
+		configASSERT( pxQueue->uxMessagesWaiting < pxQueue->uxLength );
+
+		traceQUEUE_SEND( pxQueue );
+		prvCommitSlot( pxQueue );
+
+		/* If there was a task waiting for data to arrive on the queue then
+		unblock it now, as xQueueGenericSend() does. */
+		if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+		{
+			if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* A task may have been waiting to post only because of the slot. */
+		if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+		{
+			if( prvUnblockHeldBack( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ) ) != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void *pvQueueAcquireSlotFromISR( QueueHandle_t xQueue )
+{
+void *pvReturn;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) == 0U ) )
+		{
+			pxQueue->ucSlotsHeld |= queueSLOT_ACQUIRED;
+			pvReturn = ( void * ) queueGET_WRITE_TO( pxQueue );
+		}
+		else
+		{
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+			pvReturn = NULL;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vQueueCommitSlotFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cTxLock = pxQueue->cTxLock;
+
+		configASSERT( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) != 0U );
+		configASSERT( pxQueue->uxMessagesWaiting < pxQueue->uxLength );
+
+		traceQUEUE_SEND_FROM_ISR( pxQueue );
+		prvCommitSlot( pxQueue );
+
+		/* The event list is not altered if the queue is locked.  This will
+		be done when the queue is unlocked later. */
+		if( cTxLock == queueUNLOCKED )
+		{
+			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+			{
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+				{
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			/* Increment the lock count so the task that unlocks the queue
+			knows that data was posted while it was locked. */
+			pxQueue->cTxLock = ( int8_t ) ( cTxLock + 1 );
+		}
+
+		/* A task may have been waiting to post only because of the slot. */
+		if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+		{
+			if( ( prvUnblockHeldBack( &( pxQueue->xTasksWaitingToSend ), &( pxQueue->cRxLock ) ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
+			{
+				*pxHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueGenericSendFromISR( QueueHandle_t xQueue, const void * const pvItemToQueue, BaseType_t * const pxHigherPriorityTaskWoken, const BaseType_t xCopyPosition )
+{
+BaseType_t xReturn;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( !( ( pvItemToQueue == NULL ) && ( pxQueue->uxItemSize != ( UBaseType_t ) 0U ) ) );
+	configASSERT( !( ( xCopyPosition == queueOVERWRITE ) && ( pxQueue->uxLength != 1 ) ) );
+
+	/* RTOS ports that support interrupt nesting have the concept of a maximum
+	system call (or maximum API call) interrupt priority.  Interrupts that are
+	above the maximum system call priority are kept permanently enabled, even
+	when the RTOS kernel is in a critical section, but cannot make any calls to
+	FreeRTOS API functions.  If configASSERT() is defined in FreeRTOSConfig.h
+	then portASSERT_IF_INTERRUPT_PRIORITY_INVALID() will result in an assertion
+	failure if a FreeRTOS API function is called from an interrupt that has been
+	assigned a priority above the configured maximum system call priority.
+	Only FreeRTOS functions that end in FromISR can be called from interrupts
+	that have been assigned a priority at or (logically) below the maximum
+	system call	interrupt priority.  FreeRTOS maintains a separate interrupt
+	safe API to ensure interrupt entry is as fast and as simple as possible.
+	More information (albeit Cortex-M specific) is provided on the following
+	link: http://www.freertos.org/RTOS-Cortex-M3-M4.html */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	/* Similar to xQueueGenericSend, except without blocking if there is no room
+	in the queue.  Also don't directly wake a task that was blocked on a queue
+	read, instead return a flag to say whether a context switch is required or
+	not (i.e. has a task with a higher priority than us been woken by this
+	post). */
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( ( ( pxQueue->uxMessagesWaiting < pxQueue->uxLength ) || ( xCopyPosition == queueOVERWRITE ) ) && ( ( pxQueue->ucSlotsHeld & queueSLOTS_STOPPING_SEND( xCopyPosition ) ) == 0U ) )
+		{
+			const int8_t cTxLock = pxQueue->cTxLock;
+
+			traceQUEUE_SEND_FROM_ISR( pxQueue );
+
+			/* Semaphores use xQueueGiveFromISR(), so pxQueue will not be a
+			semaphore or mutex.  That means prvCopyDataToQueue() cannot result
+			in a task disinheriting a priority and prvCopyDataToQueue() can be
+			called here even though the disinherit function does not check if
+			the scheduler is suspended before accessing the ready lists. */
+			if( queueIS_BYTE_QUEUE( pxQueue ) && ( xCopyPosition == queueSEND_TO_BACK ) )
+			{
+				/* Store a byte in line rather than through a call. */
+				queueBYTE_QUEUE_SEND( pxQueue, pvItemToQueue );
+				pxQueue->uxMessagesWaiting++;
+			}
+			else
+			{
+				( void ) prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
+			}
+
+			/* The event list is not altered if the queue is locked.  This will
+			be done when the queue is unlocked later. */
+			if( cTxLock == queueUNLOCKED )
+			{
+				#if ( configUSE_QUEUE_SETS == 1 )
+				{
+					if( pxQueue->pxQueueSetContainer != NULL )
+					{
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
+						{
+							/* The queue is a member of a queue set, and posting
+							to the queue set caused a higher priority task to
+							unblock.  A context switch is required. */
+							if( pxHigherPriorityTaskWoken != NULL )
+							{
+								*pxHigherPriorityTaskWoken = pdTRUE;
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+						{
+							if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+							{
+								/* The task waiting has a higher priority so
+								record that a context switch is required. */
+								if( pxHigherPriorityTaskWoken != NULL )
+								{
+									*pxHigherPriorityTaskWoken = pdTRUE;
+								}
+								else
+								{
+									mtCOVERAGE_TEST_MARKER();
+								}
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+				}
+				#else /* configUSE_QUEUE_SETS */
+				{
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+						{
+							/* The task waiting has a higher priority so record that a
+							context	switch is required. */
+							if( pxHigherPriorityTaskWoken != NULL )
+							{
+								*pxHigherPriorityTaskWoken = pdTRUE;
+							}
+							else
+							{
+								mtCOVERAGE_TEST_MARKER();
+							}
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif /* configUSE_QUEUE_SETS */
+			}
+			else
+			{
+				/* Increment the lock count so the task that unlocks the queue
+				knows that data was posted while it was locked. */
+				pxQueue->cTxLock = ( int8_t ) ( cTxLock + 1 );
+			}
+
+			xReturn = pdPASS;
+		}
+		else
+		{
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+			xReturn = errQUEUE_FULL;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
 {
 BaseType_t xReturn;
 UBaseType_t uxSavedInterruptStatus;
@@ -1238,7 +1787,6 @@ BaseType_t xQueueGenericReceive( QueueHandle_t xQueue, void * const pvBuffer, Ti
 {
 BaseType_t xEntryTimeSet = pdFALSE;
 TimeOut_t xTimeOut;
-int8_t *pcOriginalReadPosition;
 Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 	configASSERT( pxQueue );
@@ -1260,17 +1808,14 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
 			/* Is there data in the queue now?  To be running the calling task
-			must be the highest priority task wanting to access the queue. */
-			if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+			must be the highest priority task wanting to access the queue.  A
+			borrowed item cannot be received or peeked. */
+			if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U ) )
 			{
-				/* Remember the read position in case the queue is only being
-				peeked. */
-				pcOriginalReadPosition = pxQueue->u.pcReadFrom;
-
-				prvCopyDataFromQueue( pxQueue, pvBuffer );
-
 				if( xJustPeeking == pdFALSE )
 				{
+					prvCopyDataFromQueue( pxQueue, pvBuffer );
+
 					traceQUEUE_RECEIVE( pxQueue );
 
 					/* Actually removing data, not just peeking. */
@@ -1291,115 +1836,437 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 					}
 					#endif /* configUSE_MUTEXES */
 
-					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
-					{
-						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
-						{
-							queueYIELD_IF_USING_PREEMPTION();
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
-					}
-					else
-					{
-						mtCOVERAGE_TEST_MARKER();
-					}
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+						{
+							queueYIELD_IF_USING_PREEMPTION();
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					traceQUEUE_PEEK( pxQueue );
+
+					/* The data is not being removed, so is copied without
+					moving the read position. */
+					prvPeekDataFromQueue( pxQueue, pvBuffer );
+
+					/* The data is being left in the queue, so see if there are
+					any other tasks waiting for the data. */
+					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+					{
+						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+						{
+							/* The task waiting has a higher priority than this task. */
+							queueYIELD_IF_USING_PREEMPTION();
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+
+				taskEXIT_CRITICAL();
+				return pdPASS;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					/* The queue was empty and no block time is specified (or
+					the block time has expired) so leave now. */
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return errQUEUE_EMPTY;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					/* The queue was empty and a block time was specified so
+					configure the timeout structure. */
+					vTaskSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can send to and receive from the queue
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+
+				#if ( configUSE_MUTEXES == 1 )
+				{
+					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					{
+						taskENTER_CRITICAL();
+						{
+							vTaskPriorityInherit( ( void * ) pxQueue->pxMutexHolder );
+						}
+						taskEXIT_CRITICAL();
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				#endif
+
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return errQUEUE_EMPTY;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, UBaseType_t uxMaxItems, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxItems;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( !( ( pvBuffer == NULL ) && ( uxMaxItems != ( UBaseType_t ) 0U ) ) );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( configUSE_QUEUE_SETS == 1 )
+	{
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
+	}
+	#endif
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	if( uxMaxItems == ( UBaseType_t ) 0U )
+	{
+		return 0;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* As xQueueGenericReceive(), but taking everything there is, up to
+	uxMaxItems, in one go. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U )
+			{
+				uxItems = pxQueue->uxMessagesWaiting;
+			}
+			else
+			{
+				/* The borrowed item has to be released first. */
+				uxItems = 0;
+			}
+
+			if( uxItems > ( UBaseType_t ) 0 )
+			{
+				if( uxMaxItems < uxItems )
+				{
+					uxItems = uxMaxItems;
 				}
 				else
 				{
-					traceQUEUE_PEEK( pxQueue );
+					mtCOVERAGE_TEST_MARKER();
+				}
 
-					/* The data is not being removed, so reset the read
-					pointer. */
-					pxQueue->u.pcReadFrom = pcOriginalReadPosition;
+				traceQUEUE_RECEIVE( pxQueue );
+				prvCopyItemsFromQueue( pxQueue, pvBuffer, uxItems );
 
-					/* The data is being left in the queue, so see if there are
-					any other tasks waiting for the data. */
-					if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				/* Only the highest priority task waiting for space is woken,
+				however many items were removed. */
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
 					{
-						if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
-						{
-							/* The task waiting has a higher priority than this task. */
-							queueYIELD_IF_USING_PREEMPTION();
-						}
-						else
-						{
-							mtCOVERAGE_TEST_MARKER();
-						}
+						queueYIELD_IF_USING_PREEMPTION();
 					}
 					else
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 
 				taskEXIT_CRITICAL();
-				return pdPASS;
+				return uxItems;
 			}
 			else
 			{
 				if( xTicksToWait == ( TickType_t ) 0 )
 				{
-					/* The queue was empty and no block time is specified (or
-					the block time has expired) so leave now. */
 					taskEXIT_CRITICAL();
 					traceQUEUE_RECEIVE_FAILED( pxQueue );
-					return errQUEUE_EMPTY;
+					return 0;
 				}
 				else if( xEntryTimeSet == pdFALSE )
 				{
-					/* The queue was empty and a block time was specified so
-					configure the timeout structure. */
 					vTaskSetTimeOutState( &xTimeOut );
 					xEntryTimeSet = pdTRUE;
 				}
 				else
 				{
-					/* Entry time was already set. */
 					mtCOVERAGE_TEST_MARKER();
 				}
 			}
 		}
 		taskEXIT_CRITICAL();
 
-		/* Interrupts and other tasks can send to and receive from the queue
-		now the critical section has been exited. */
+		if( prvWaitOnQueue( pxQueue, pdFALSE, &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			traceQUEUE_RECEIVE_FAILED( pxQueue );
+			return 0;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
 
-		vTaskSuspendAll();
-		prvLockQueue( pxQueue );
+void *pvQueueBorrowSlot( QueueHandle_t xQueue, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+void *pvReturn;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
-		/* Update the timeout state to see if it has expired yet. */
-		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( configUSE_QUEUE_SETS == 1 )
+	{
+		configASSERT( pxQueue->pxQueueSetContainer == NULL );
+	}
+	#endif
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
 		{
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			if( ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U ) )
 			{
-				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				/* The item stays in the queue, so its slot cannot be written
+				to, until it is released. */
+				pxQueue->ucSlotsHeld |= queueSLOT_BORROWED;
+				pvReturn = ( void * ) prvNextReadSlot( pxQueue );
+				taskEXIT_CRITICAL();
+				return pvReturn;
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				taskEXIT_CRITICAL();
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return NULL;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				vTaskSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
 
-				#if ( configUSE_MUTEXES == 1 )
+		if( prvWaitOnQueue( pxQueue, pdFALSE, &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			traceQUEUE_RECEIVE_FAILED( pxQueue );
+			return NULL;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vQueueReleaseSlot( QueueHandle_t xQueue )
+{
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+
+	taskENTER_CRITICAL();
+	{
+		/* There must be a slot borrowed, so the queue cannot be empty. */
+		configASSERT( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) != 0U );
+		configASSERT( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 );
+
+		traceQUEUE_RECEIVE( pxQueue );
+		prvReleaseSlot( pxQueue );
+
+		/* There is now space, so unblock a task waiting to post to the
+		queue, as xQueueGenericReceive() does. */
+		if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+		{
+			if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* A task may have been waiting to receive only because of the
+		borrowed item. */
+		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+		{
+			if( prvUnblockHeldBack( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ) ) != pdFALSE )
+			{
+				queueYIELD_IF_USING_PREEMPTION();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void *pvQueueBorrowSlotFromISR( QueueHandle_t xQueue )
+{
+void *pvReturn;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		if( ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U ) )
+		{
+			pxQueue->ucSlotsHeld |= queueSLOT_BORROWED;
+			pvReturn = ( void * ) prvNextReadSlot( pxQueue );
+		}
+		else
+		{
+			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+			pvReturn = NULL;
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vQueueReleaseSlotFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = ( Queue_t * ) xQueue;
+
+	configASSERT( pxQueue );
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cRxLock = pxQueue->cRxLock;
+
+		configASSERT( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) != 0U );
+		configASSERT( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 );
+
+		traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
+		prvReleaseSlot( pxQueue );
+
+		/* If the queue is locked the event list will not be modified.
+		Instead update the lock count so the task that unlocks the queue will
+		know that an ISR has removed data while the queue was locked. */
+		if( cRxLock == queueUNLOCKED )
+		{
+			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+			{
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
 				{
-					if( pxQueue->uxQueueType == queueQUEUE_IS_MUTEX )
+					if( pxHigherPriorityTaskWoken != NULL )
 					{
-						taskENTER_CRITICAL();
-						{
-							vTaskPriorityInherit( ( void * ) pxQueue->pxMutexHolder );
-						}
-						taskEXIT_CRITICAL();
+						*pxHigherPriorityTaskWoken = pdTRUE;
 					}
 					else
 					{
 						mtCOVERAGE_TEST_MARKER();
 					}
 				}
-				#endif
-
-				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
-				prvUnlockQueue( pxQueue );
-				if( xTaskResumeAll() == pdFALSE )
-				{
-					portYIELD_WITHIN_API();
-				}
 				else
 				{
 					mtCOVERAGE_TEST_MARKER();
@@ -1407,27 +2274,33 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 			}
 			else
 			{
-				/* Try again. */
-				prvUnlockQueue( pxQueue );
-				( void ) xTaskResumeAll();
+				mtCOVERAGE_TEST_MARKER();
 			}
 		}
 		else
 		{
-			prvUnlockQueue( pxQueue );
-			( void ) xTaskResumeAll();
+			pxQueue->cRxLock = ( int8_t ) ( cRxLock + 1 );
+		}
 
-			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+		/* A task may have been waiting to receive only because of the
+		borrowed item. */
+		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+		{
+			if( ( prvUnblockHeldBack( &( pxQueue->xTasksWaitingToReceive ), &( pxQueue->cTxLock ) ) != pdFALSE ) && ( pxHigherPriorityTaskWoken != NULL ) )
 			{
-				traceQUEUE_RECEIVE_FAILED( pxQueue );
-				return errQUEUE_EMPTY;
+				*pxHigherPriorityTaskWoken = pdTRUE;
 			}
 			else
 			{
 				mtCOVERAGE_TEST_MARKER();
 			}
 		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
 }
 /*-----------------------------------------------------------*/
 
@@ -1461,13 +2334,21 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 		const UBaseType_t uxMessagesWaiting = pxQueue->uxMessagesWaiting;
 
 		/* Cannot block in an ISR, so check there is data available. */
-		if( uxMessagesWaiting > ( UBaseType_t ) 0 )
+		if( ( uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U ) )
 		{
 			const int8_t cRxLock = pxQueue->cRxLock;
 
 			traceQUEUE_RECEIVE_FROM_ISR( pxQueue );
 
-			prvCopyDataFromQueue( pxQueue, pvBuffer );
+			if( queueIS_BYTE_QUEUE( pxQueue ) )
+			{
+				/* Load a byte in line rather than through a call. */
+				queueBYTE_QUEUE_RECEIVE( pxQueue, pvBuffer );
+			}
+			else
+			{
+				prvCopyDataFromQueue( pxQueue, pvBuffer );
+			}
 			pxQueue->uxMessagesWaiting = uxMessagesWaiting - 1;
 
 			/* If the queue is locked the event list will not be modified.
@@ -1526,7 +2407,6 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,  void * const pvBuffer )
 {
 BaseType_t xReturn;
 UBaseType_t uxSavedInterruptStatus;
-int8_t *pcOriginalReadPosition;
 Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 
 	configASSERT( pxQueue );
@@ -1552,15 +2432,13 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
 	{
 		/* Cannot block in an ISR, so check there is data available. */
-		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+		if( ( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 ) && ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) == 0U ) )
 		{
 			traceQUEUE_PEEK_FROM_ISR( pxQueue );
 
-			/* Remember the read position so it can be reset as nothing is
-			actually being removed from the queue. */
-			pcOriginalReadPosition = pxQueue->u.pcReadFrom;
-			prvCopyDataFromQueue( pxQueue, pvBuffer );
-			pxQueue->u.pcReadFrom = pcOriginalReadPosition;
+			/* Nothing is actually being removed from the queue, so the read
+			position is not moved. */
+			prvPeekDataFromQueue( pxQueue, pvBuffer );
 
 			xReturn = pdPASS;
 		}
@@ -1635,33 +2513,97 @@ Queue_t * const pxQueue = ( Queue_t * ) xQueue;
 	}
 	#endif
 
+	#if( configUSE_QUEUE_RAM_STATS == 1 )
+	{
+		prvUpdateRAMStats( pxQueue, pdFALSE );
+	}
+	#endif
+
 	#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 0 ) )
 	{
 		/* The queue can only have been allocated dynamically - free it
 		again. */
 		vPortFree( pxQueue );
 	}
-	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	#elif( ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	{
+		/* The queue could have been allocated statically or dynamically, so
+		check before attempting to free the memory. */
+		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+		{
+			vPortFree( pxQueue );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#else
+	{
+		/* The queue must have been statically allocated, so is not going to be
+		deleted.  Avoid compiler warnings about the unused parameter. */
+		( void ) pxQueue;
+	}
+	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_RAM_STATS == 1 )
+
+	void vQueueGetRAMStats( QueueRAMStats_t *pxStats )
+	{
+		configASSERT( pxStats );
+
+		taskENTER_CRITICAL();
+		{
+			*pxStats = xQueueRAMStats;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_QUEUE_RAM_STATS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_QUEUE_RAM_STATS == 1 )
+
+	static void prvUpdateRAMStats( const Queue_t * const pxQueue, const BaseType_t xCreated )
 	{
-		/* The queue could have been allocated statically or dynamically, so
-		check before attempting to free the memory. */
-		if( pxQueue->ucStaticallyAllocated == ( uint8_t ) pdFALSE )
+	size_t xStructureSize, xStorageSize;
+
+		/* A static queue of 1 byte items may have been given a whole
+		StaticQueue_t, but only uses queueBYTE_QUEUE_SIZE bytes of it. */
+		if( queueIS_BYTE_QUEUE( pxQueue ) )
 		{
-			vPortFree( pxQueue );
+			xStructureSize = queueBYTE_QUEUE_SIZE;
 		}
 		else
 		{
-			mtCOVERAGE_TEST_MARKER();
+			xStructureSize = sizeof( Queue_t );
 		}
+
+		xStorageSize = ( size_t ) pxQueue->uxLength * ( size_t ) pxQueue->uxItemSize;
+
+		taskENTER_CRITICAL();
+		{
+			if( xCreated != pdFALSE )
+			{
+				xQueueRAMStats.uxQueues++;
+				xQueueRAMStats.xStructureBytes += xStructureSize;
+				xQueueRAMStats.xStorageBytes += xStorageSize;
+				xQueueRAMStats.xBytesSaved += queuePOINTER_QUEUE_SIZE - xStructureSize;
+			}
+			else
+			{
+				xQueueRAMStats.uxQueues--;
+				xQueueRAMStats.xStructureBytes -= xStructureSize;
+				xQueueRAMStats.xStorageBytes -= xStorageSize;
+				xQueueRAMStats.xBytesSaved -= queuePOINTER_QUEUE_SIZE - xStructureSize;
+			}
+		}
+		taskEXIT_CRITICAL();
 	}
-	#else
-	{
-		/* The queue must have been statically allocated, so is not going to be
-		deleted.  Avoid compiler warnings about the unused parameter. */
-		( void ) pxQueue;
-	}
-	#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
-}
+
+#endif /* configUSE_QUEUE_RAM_STATS */
 /*-----------------------------------------------------------*/
 
 #if ( configUSE_TRACE_FACILITY == 1 )
@@ -1720,30 +2662,66 @@ UBaseType_t uxMessagesWaiting;
 		}
 		#endif /* configUSE_MUTEXES */
 	}
+	else if( queueIS_BYTE_QUEUE( pxQueue ) && ( xPosition == queueSEND_TO_BACK ) )
+	{
+		queueBYTE_QUEUE_SEND( pxQueue, pvItemToQueue );
+	}
 	else if( xPosition == queueSEND_TO_BACK )
 	{
-		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
-		pxQueue->pcWriteTo += pxQueue->uxItemSize;
-		if( pxQueue->pcWriteTo >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+		#if( configUSE_QUEUE_INDICES == 1 )
 		{
-			pxQueue->pcWriteTo = pxQueue->pcHead;
+			const uint8_t ucWriteTo = queueWRITE_INDEX( pxQueue );
+
+			( void ) memcpy( ( void * ) queueINDEX_TO_ITEM( pxQueue, ucWriteTo ), pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+			queueWRITE_INDEX( pxQueue ) = queueNEXT_INDEX( pxQueue, ucWriteTo );
 		}
-		else
+		#else
 		{
-			mtCOVERAGE_TEST_MARKER();
+			( void ) memcpy( ( void * ) pxQueue->pcWriteTo, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports, plus previous logic ensures a null pointer can only be passed to memcpy() if the copy size is 0. */
+			pxQueue->pcWriteTo += pxQueue->uxItemSize;
+			if( pxQueue->pcWriteTo >= pxQueue->t.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+			{
+				pxQueue->pcWriteTo = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
 		}
+		#endif
 	}
 	else
 	{
-		( void ) memcpy( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
-		pxQueue->u.pcReadFrom -= pxQueue->uxItemSize;
-		if( pxQueue->u.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+		if( queueUSES_INDICES( pxQueue ) )
 		{
-			pxQueue->u.pcReadFrom = ( pxQueue->pcTail - pxQueue->uxItemSize );
+			const uint8_t ucReadFrom = queueREAD_INDEX( pxQueue );
+
+			( void ) memcpy( ( void * ) queueINDEX_TO_ITEM( pxQueue, ucReadFrom ), pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+			if( ucReadFrom == ( uint8_t ) 0U )
+			{
+				queueREAD_INDEX( pxQueue ) = ( uint8_t ) ( pxQueue->uxLength - ( UBaseType_t ) 1U );
+			}
+			else
+			{
+				queueREAD_INDEX( pxQueue ) = ( uint8_t ) ( ucReadFrom - 1U );
+			}
 		}
 		else
 		{
-			mtCOVERAGE_TEST_MARKER();
+			#if( configUSE_QUEUE_INDICES == 0 )
+			{
+				( void ) memcpy( ( void * ) pxQueue->u.pcReadFrom, pvItemToQueue, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+				pxQueue->u.pcReadFrom -= pxQueue->uxItemSize;
+				if( pxQueue->u.pcReadFrom < pxQueue->pcHead ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+				{
+					pxQueue->u.pcReadFrom = ( pxQueue->t.pcTail - pxQueue->uxItemSize );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif
 		}
 
 		if( xPosition == queueOVERWRITE )
@@ -1774,20 +2752,308 @@ UBaseType_t uxMessagesWaiting;
 /*-----------------------------------------------------------*/
 
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer )
+{
+	if( queueIS_BYTE_QUEUE( pxQueue ) )
+	{
+		queueBYTE_QUEUE_RECEIVE( pxQueue, pvBuffer );
+	}
+	else if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
+	{
+		#if( configUSE_QUEUE_INDICES == 1 )
+		{
+			const uint8_t ucReadFrom = queueNEXT_INDEX( pxQueue, queueREAD_INDEX( pxQueue ) );
+
+			queueREAD_INDEX( pxQueue ) = ucReadFrom;
+			( void ) memcpy( ( void * ) pvBuffer, ( void * ) queueINDEX_TO_ITEM( pxQueue, ucReadFrom ), ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+		}
+		#else
+		{
+			pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
+			if( pxQueue->u.pcReadFrom >= pxQueue->t.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+			{
+				pxQueue->u.pcReadFrom = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+			( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0. */
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvPeekDataFromQueue( const Queue_t * const pxQueue, void * const pvBuffer )
 {
 	if( pxQueue->uxItemSize != ( UBaseType_t ) 0 )
 	{
-		pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
-		if( pxQueue->u.pcReadFrom >= pxQueue->pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+		( void ) memcpy( ( void * ) pvBuffer, ( void * ) prvNextReadSlot( pxQueue ), ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItemsToQueue( Queue_t * const pxQueue, const void *pvItemsToQueue, const UBaseType_t uxItems )
+{
+const size_t xBytes = ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+int8_t * const pcWriteTo = queueGET_WRITE_TO( pxQueue );
+const size_t xBytesToTail = ( size_t ) ( queueGET_TAIL( pxQueue ) - pcWriteTo );
+
+	/* This function is called from a critical section. */
+
+	if( xBytes <= xBytesToTail )
+	{
+		( void ) memcpy( ( void * ) pcWriteTo, pvItemsToQueue, xBytes ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+	}
+	else
+	{
+		/* The items wrap round the end of the storage area. */
+		( void ) memcpy( ( void * ) pcWriteTo, pvItemsToQueue, xBytesToTail ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+		( void ) memcpy( ( void * ) pxQueue->pcHead, ( const void * ) ( ( const int8_t * ) pvItemsToQueue + xBytesToTail ), xBytes - xBytesToTail ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+	}
+
+	prvAdvanceWriteTo( pxQueue, uxItems );
+	pxQueue->uxMessagesWaiting += uxItems;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCopyItemsFromQueue( Queue_t * const pxQueue, void * const pvBuffer, const UBaseType_t uxItems )
+{
+const size_t xBytes = ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+int8_t * const pcReadFrom = prvNextReadSlot( pxQueue );
+const size_t xBytesToTail = ( size_t ) ( queueGET_TAIL( pxQueue ) - pcReadFrom );
+
+	/* This function is called from a critical section.  The read position
+	is the last item read, so the first item to read is the one after it. */
+
+	if( xBytes <= xBytesToTail )
+	{
+		( void ) memcpy( pvBuffer, ( void * ) pcReadFrom, xBytes ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+	}
+	else
+	{
+		/* The items wrap round the end of the storage area. */
+		( void ) memcpy( pvBuffer, ( void * ) pcReadFrom, xBytesToTail ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+		( void ) memcpy( ( void * ) ( ( int8_t * ) pvBuffer + xBytesToTail ), ( void * ) pxQueue->pcHead, xBytes - xBytesToTail ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports. */
+	}
+
+	/* Leave the read position on the last item read, as
+	prvCopyDataFromQueue() does. */
+	prvAdvanceReadFrom( pxQueue, uxItems );
+	pxQueue->uxMessagesWaiting -= uxItems;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWaitOnQueue( Queue_t * const pxQueue, const BaseType_t xSending, TimeOut_t * const pxTimeOut, TickType_t * const pxTicksToWait )
+{
+BaseType_t xReturn = pdTRUE, xBlock;
+
+	/* Interrupts and other tasks can send to and receive from the queue
+	now the critical section has been exited. */
+
+	vTaskSuspendAll();
+	prvLockQueue( pxQueue );
+
+	if( xSending != pdFALSE )
+	{
+		xBlock = prvIsQueueFull( pxQueue );
+	}
+	else
+	{
+		xBlock = prvIsQueueEmpty( pxQueue );
+	}
+
+	if( xTaskCheckForTimeOut( pxTimeOut, pxTicksToWait ) == pdFALSE )
+	{
+		if( xBlock != pdFALSE )
+		{
+			if( xSending != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), *pxTicksToWait );
+			}
+			else
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), *pxTicksToWait );
+			}
+
+			prvUnlockQueue( pxQueue );
+
+			if( xTaskResumeAll() == pdFALSE )
+			{
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			/* Try again. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+		}
+	}
+	else
+	{
+		prvUnlockQueue( pxQueue );
+		( void ) xTaskResumeAll();
+
+		/* The timeout has expired.  If the queue changed as it did the
+		caller tries once more, with no block time left. */
+		*pxTicksToWait = ( TickType_t ) 0;
+		xReturn = ( xBlock == pdFALSE ) ? pdTRUE : pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCommitSlot( Queue_t * const pxQueue )
+{
+	/* This function is called from a critical section. */
+
+	prvAdvanceWriteTo( pxQueue, ( UBaseType_t ) 1U );
+	pxQueue->uxMessagesWaiting++;
+	pxQueue->ucSlotsHeld &= ( uint8_t ) ~queueSLOT_ACQUIRED;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseSlot( Queue_t * const pxQueue )
+{
+	/* This function is called from a critical section. */
+
+	prvAdvanceReadFrom( pxQueue, ( UBaseType_t ) 1U );
+	pxQueue->uxMessagesWaiting--;
+	pxQueue->ucSlotsHeld &= ( uint8_t ) ~queueSLOT_BORROWED;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockHeldBack( List_t * const pxEventList, volatile int8_t * const pcLock )
+{
+BaseType_t xReturn = pdFALSE;
+const int8_t cLock = *pcLock;
+
+	/* This function is called from a critical section. */
+
+	if( cLock == queueUNLOCKED )
+	{
+		if( listLIST_IS_EMPTY( pxEventList ) == pdFALSE )
 		{
-			pxQueue->u.pcReadFrom = pxQueue->pcHead;
+			xReturn = xTaskRemoveFromEventList( pxEventList );
 		}
 		else
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
-		( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( size_t ) pxQueue->uxItemSize ); /*lint !e961 !e418 MISRA exception as the casts are only redundant for some ports.  Also previous logic ensures a null pointer can only be passed to memcpy() when the count is 0. */
 	}
+	else
+	{
+		*pcLock = ( int8_t ) ( cLock + 1 );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static int8_t *prvNextReadSlot( const Queue_t * const pxQueue )
+{
+int8_t *pcSlot = NULL;
+
+	if( queueUSES_INDICES( pxQueue ) )
+	{
+		pcSlot = queueINDEX_TO_ITEM( pxQueue, queueNEXT_INDEX( pxQueue, queueREAD_INDEX( pxQueue ) ) );
+	}
+	else
+	{
+		#if( configUSE_QUEUE_INDICES == 0 )
+		{
+			pcSlot = pxQueue->u.pcReadFrom + pxQueue->uxItemSize;
+
+			if( pcSlot >= pxQueue->t.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+			{
+				pcSlot = pxQueue->pcHead;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+	}
+
+	return pcSlot;
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdvanceWriteTo( Queue_t * const pxQueue, const UBaseType_t uxItems )
+{
+	if( queueUSES_INDICES( pxQueue ) )
+	{
+		queueWRITE_INDEX( pxQueue ) = prvAdvanceIndex( pxQueue, queueWRITE_INDEX( pxQueue ), uxItems );
+	}
+	else
+	{
+		#if( configUSE_QUEUE_INDICES == 0 )
+		{
+			pxQueue->pcWriteTo += ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+			if( pxQueue->pcWriteTo >= pxQueue->t.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+			{
+				pxQueue->pcWriteTo -= ( pxQueue->t.pcTail - pxQueue->pcHead );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvAdvanceReadFrom( Queue_t * const pxQueue, const UBaseType_t uxItems )
+{
+	if( queueUSES_INDICES( pxQueue ) )
+	{
+		queueREAD_INDEX( pxQueue ) = prvAdvanceIndex( pxQueue, queueREAD_INDEX( pxQueue ), uxItems );
+	}
+	else
+	{
+		#if( configUSE_QUEUE_INDICES == 0 )
+		{
+			pxQueue->u.pcReadFrom += ( size_t ) uxItems * ( size_t ) pxQueue->uxItemSize;
+			if( pxQueue->u.pcReadFrom >= pxQueue->t.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+			{
+				pxQueue->u.pcReadFrom -= ( pxQueue->t.pcTail - pxQueue->pcHead );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvAdvanceIndex( const Queue_t * const pxQueue, const uint8_t ucIndex, const UBaseType_t uxItems )
+{
+const UBaseType_t uxToEnd = pxQueue->uxLength - ( UBaseType_t ) ucIndex;
+uint8_t ucReturn;
+
+	/* Worked out without ever going past uxLength, which can be 255. */
+	if( uxItems < uxToEnd )
+	{
+		ucReturn = ( uint8_t ) ( ucIndex + uxItems );
+	}
+	else
+	{
+		ucReturn = ( uint8_t ) ( uxItems - uxToEnd );
+	}
+
+	return ucReturn;
 }
 /*-----------------------------------------------------------*/
 
@@ -1917,7 +3183,8 @@ BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 )
+		/* A borrowed item is not there to be received. */
+		if( ( pxQueue->uxMessagesWaiting == ( UBaseType_t )  0 ) || ( ( pxQueue->ucSlotsHeld & queueSLOT_BORROWED ) != 0U ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -1956,7 +3223,8 @@ BaseType_t xReturn;
 
 	taskENTER_CRITICAL();
 	{
-		if( pxQueue->uxMessagesWaiting == pxQueue->uxLength )
+		/* Nothing can be posted while a slot is acquired. */
+		if( ( pxQueue->uxMessagesWaiting == pxQueue->uxLength ) || ( ( pxQueue->ucSlotsHeld & queueSLOT_ACQUIRED ) != 0U ) )
 		{
 			xReturn = pdTRUE;
 		}
@@ -2108,17 +3376,8 @@ BaseType_t xReturn;
 			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
 			{
 				/* Data is available from the queue. */
-				pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
-				if( pxQueue->u.pcReadFrom >= pxQueue->pcTail )
-				{
-					pxQueue->u.pcReadFrom = pxQueue->pcHead;
-				}
-				else
-				{
-					mtCOVERAGE_TEST_MARKER();
-				}
+				prvCopyDataFromQueue( pxQueue, pvBuffer );
 				--( pxQueue->uxMessagesWaiting );
-				( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
 
 				xReturn = pdPASS;
 
@@ -2216,17 +3475,8 @@ BaseType_t xReturn;
 		if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
 		{
 			/* Copy the data from the queue. */
-			pxQueue->u.pcReadFrom += pxQueue->uxItemSize;
-			if( pxQueue->u.pcReadFrom >= pxQueue->pcTail )
-			{
-				pxQueue->u.pcReadFrom = pxQueue->pcHead;
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
+			prvCopyDataFromQueue( pxQueue, pvBuffer );
 			--( pxQueue->uxMessagesWaiting );
-			( void ) memcpy( ( void * ) pvBuffer, ( void * ) pxQueue->u.pcReadFrom, ( unsigned ) pxQueue->uxItemSize );
 
 			if( ( *pxCoRoutineWoken ) == pdFALSE )
 			{
@@ -252,6 +252,34 @@ count overflows. */
 
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMING_WHEEL == 1 )
+
+	/* The timing wheel has two levels of taskWHEEL_SLOTS slots each.  A task
+	due less than taskWHEEL_SLOTS ticks from now goes in the near slot selected
+	by the low bits of its wake time, and every task in a near slot is due when
+	the tick count next selects that slot.  A task due less than
+	taskWHEEL_SPAN ticks from now goes in the far slot selected by the next
+	configTIMING_WHEEL_BITS bits of its wake time, and is moved to the near
+	wheel at the start of the turn in which it is due.  Longer delays use the
+	sorted delayed lists as before. */
+	#define taskWHEEL_SLOTS					( ( TickType_t ) 1 << configTIMING_WHEEL_BITS )
+	#define taskWHEEL_MASK					( taskWHEEL_SLOTS - ( TickType_t ) 1 )
+	#define taskWHEEL_SPAN					( ( TickType_t ) 1 << ( 2 * configTIMING_WHEEL_BITS ) )
+	#define taskWHEEL_NEAR_SLOT( xTime )	( &( xTimingWheel[ ( xTime ) & taskWHEEL_MASK ] ) )
+	#define taskWHEEL_FAR_SLOT( xTime )		( &( xTimingWheel[ taskWHEEL_SLOTS + ( ( ( xTime ) >> configTIMING_WHEEL_BITS ) & taskWHEEL_MASK ) ] ) )
+
+	/* Is pxList one of the timing wheel slots? */
+	#define taskLIST_IS_IN_TIMING_WHEEL( pxList ) ( ( ( pxList ) >= &( xTimingWheel[ 0 ] ) ) && ( ( pxList ) < &( xTimingWheel[ 2 * taskWHEEL_SLOTS ] ) ) )
+
+#else
+
+	#define prvAddCurrentTaskToTimingWheel( xTicksToWait ) pdFALSE
+	#define taskLIST_IS_IN_TIMING_WHEEL( pxList ) pdFALSE
+
+#endif /* configUSE_TIMING_WHEEL */
+
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
  * the task.  It is inserted at the end of the list.
@@ -379,6 +407,12 @@ PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;				/*< Points to the
 PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;		/*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;						/*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if( configUSE_TIMING_WHEEL == 1 )
+
+	PRIVILEGED_DATA static List_t xTimingWheel[ 2 * taskWHEEL_SLOTS ];	/*< Delayed tasks due within taskWHEEL_SPAN ticks - the near slots followed by the far slots. */
+
+#endif
+
 #if( INCLUDE_vTaskDelete == 1 )
 
 	PRIVILEGED_DATA static List_t xTasksWaitingTermination;				/*< Tasks that have been deleted - but their memory not yet freed. */
@@ -550,6 +584,34 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait, const BaseT
  */
 static void prvResetNextTaskUnblockTime( void );
 
+#if( configUSE_TIMING_WHEEL == 1 )
+
+	/*
+	 * Place the calling task, whose wake time has already been written to its
+	 * state list item, in the timing wheel.  Returns pdFALSE if the wake time
+	 * is too far away, in which case the task must go in a delayed list.
+	 */
+	static BaseType_t prvAddCurrentTaskToTimingWheel( const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Unblock the tasks in the timing wheel that are due at xTime.  Must be
+	 * called for every value the tick count takes.  Returns pdTRUE if a task
+	 * that should preempt the running task was unblocked.
+	 */
+	static BaseType_t prvProcessTimingWheel( const TickType_t xTime ) PRIVILEGED_FUNCTION;
+
+	#if ( configUSE_TICKLESS_IDLE != 0 )
+
+		/*
+		 * The number of ticks until prvProcessTimingWheel() next has anything
+		 * to do, or portMAX_DELAY if the wheel is empty.
+		 */
+		static TickType_t prvGetTimingWheelIdleTime( void ) PRIVILEGED_FUNCTION;
+
+	#endif
+
+#endif /* configUSE_TIMING_WHEEL */
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) && ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) )
 
 	/*
@@ -1287,7 +1349,7 @@ static void prvAddNewTaskToReadyList( TCB_t *pxNewTCB )
 			}
 			taskEXIT_CRITICAL();
 
-			if( ( pxStateList == pxDelayedTaskList ) || ( pxStateList == pxOverflowDelayedTaskList ) )
+			if( ( pxStateList == pxDelayedTaskList ) || ( pxStateList == pxOverflowDelayedTaskList ) || ( taskLIST_IS_IN_TIMING_WHEEL( pxStateList ) ) )
 			{
 				/* The task being queried is referenced from one of the Blocked
 				lists. */
@@ -2006,6 +2068,17 @@ void vTaskSuspendAll( void )
 		else
 		{
 			xReturn = xNextTaskUnblockTime - xTickCount;
+
+			#if( configUSE_TIMING_WHEEL == 1 )
+			{
+			TickType_t xWheelIdleTime = prvGetTimingWheelIdleTime();
+
+				if( xWheelIdleTime < xReturn )
+				{
+					xReturn = xWheelIdleTime;
+				}
+			}
+			#endif
 		}
 
 		return xReturn;
@@ -2288,6 +2361,17 @@ TCB_t *pxTCB;
 				pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxOverflowDelayedTaskList, pcNameToQuery );
 			}
 
+			#if( configUSE_TIMING_WHEEL == 1 )
+			{
+			UBaseType_t uxSlot;
+
+				for( uxSlot = 0; ( pxTCB == NULL ) && ( uxSlot < ( 2 * taskWHEEL_SLOTS ) ); uxSlot++ )
+				{
+					pxTCB = prvSearchForNameWithinSingleList( &( xTimingWheel[ uxSlot ] ), pcNameToQuery );
+				}
+			}
+			#endif
+
 			#if ( INCLUDE_vTaskSuspend == 1 )
 			{
 				if( pxTCB == NULL )
@@ -2341,6 +2425,17 @@ TCB_t *pxTCB;
 				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
 				uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
 
+				#if( configUSE_TIMING_WHEEL == 1 )
+				{
+				UBaseType_t uxSlot;
+
+					for( uxSlot = 0; uxSlot < ( 2 * taskWHEEL_SLOTS ); uxSlot++ )
+					{
+						uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xTimingWheel[ uxSlot ] ), eBlocked );
+					}
+				}
+				#endif
+
 				#if( INCLUDE_vTaskDelete == 1 )
 				{
 					/* Fill in an TaskStatus_t structure with information on
@@ -2415,7 +2510,28 @@ implementations require configUSE_TICKLESS_IDLE to be set to a value other than
 		was suppressed.  Note this does *not* call the tick hook function for
 		each stepped tick. */
 		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
-		xTickCount += xTicksToJump;
+
+		#if( configUSE_TIMING_WHEEL == 1 )
+		{
+		TickType_t xTicks;
+
+			/* The wheel must see every tick count value.  The scheduler is
+			suspended, so any switch is held pending. */
+			for( xTicks = 0; xTicks < xTicksToJump; xTicks++ )
+			{
+				xTickCount++;
+				if( prvProcessTimingWheel( xTickCount ) != pdFALSE )
+				{
+					xYieldPending = pdTRUE;
+				}
+			}
+		}
+		#else
+		{
+			xTickCount += xTicksToJump;
+		}
+		#endif
+
 		traceINCREASE_TICK_COUNT( xTicksToJump );
 	}
 
@@ -2525,6 +2641,15 @@ BaseType_t xSwitchRequired = pdFALSE;
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if( configUSE_TIMING_WHEEL == 1 )
+		{
+			if( prvProcessTimingWheel( xConstTickCount ) != pdFALSE )
+			{
+				xSwitchRequired = pdTRUE;
+			}
+		}
+		#endif
+
 		/* See if this tick has made a timeout expire.  Tasks are stored in
 		the	queue in the order of their wake time - meaning once one task
 		has been found whose block time has not expired there is no need to
@@ -3343,6 +3468,17 @@ UBaseType_t uxPriority;
 	vListInitialise( &xDelayedTaskList2 );
 	vListInitialise( &xPendingReadyList );
 
+	#if( configUSE_TIMING_WHEEL == 1 )
+	{
+	UBaseType_t uxSlot;
+
+		for( uxSlot = ( UBaseType_t ) 0U; uxSlot < ( UBaseType_t ) ( 2 * taskWHEEL_SLOTS ); uxSlot++ )
+		{
+			vListInitialise( &( xTimingWheel[ uxSlot ] ) );
+		}
+	}
+	#endif /* configUSE_TIMING_WHEEL */
+
 	#if ( INCLUDE_vTaskDelete == 1 )
 	{
 		vListInitialise( &xTasksWaitingTermination );
@@ -4735,7 +4871,12 @@ const TickType_t xConstTickCount = xTickCount;
 			/* The list item will be inserted in wake time order. */
 			listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
-			if( xTimeToWake < xConstTickCount )
+			if( prvAddCurrentTaskToTimingWheel( xTicksToWait ) != pdFALSE )
+			{
+				/* The task is due soon enough to go in the timing wheel. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+			else if( xTimeToWake < xConstTickCount )
 			{
 				/* Wake time has overflowed.  Place this item in the overflow
 				list. */
@@ -4771,7 +4912,12 @@ const TickType_t xConstTickCount = xTickCount;
 		/* The list item will be inserted in wake time order. */
 		listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
-		if( xTimeToWake < xConstTickCount )
+		if( prvAddCurrentTaskToTimingWheel( xTicksToWait ) != pdFALSE )
+		{
+			/* The task is due soon enough to go in the timing wheel. */
+			mtCOVERAGE_TEST_MARKER();
+		}
+		else if( xTimeToWake < xConstTickCount )
 		{
 			/* Wake time has overflowed.  Place this item in the overflow list. */
 			vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
@@ -4799,6 +4945,152 @@ const TickType_t xConstTickCount = xTickCount;
 	}
 	#endif /* INCLUDE_vTaskSuspend */
 }
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMING_WHEEL == 1 )
+
+	static BaseType_t prvAddCurrentTaskToTimingWheel( const TickType_t xTicksToWait )
+	{
+	const TickType_t xTimeToWake = listGET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ) );
+	BaseType_t xReturn = pdTRUE;
+
+		/* The wheel is indexed by the wake time, so the order of the tasks
+		within a slot does not matter and they are simply added to the end. */
+		if( xTicksToWait == ( TickType_t ) 0 )
+		{
+			/* The wake time is now, so the slot has already been processed.
+			The delayed list will unblock the task on the next tick. */
+			xReturn = pdFALSE;
+		}
+		else if( xTicksToWait < taskWHEEL_SLOTS )
+		{
+			vListInsertEnd( taskWHEEL_NEAR_SLOT( xTimeToWake ), &( pxCurrentTCB->xStateListItem ) );
+		}
+		else if( xTicksToWait < taskWHEEL_SPAN )
+		{
+			vListInsertEnd( taskWHEEL_FAR_SLOT( xTimeToWake ), &( pxCurrentTCB->xStateListItem ) );
+		}
+		else
+		{
+			xReturn = pdFALSE;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvProcessTimingWheel( const TickType_t xTime )
+	{
+	List_t *pxSlot;
+	TCB_t *pxTCB;
+	BaseType_t xSwitchRequired = pdFALSE;
+
+		/* At the start of each turn of the near wheel, move the tasks due
+		during the turn out of the far wheel. */
+		if( ( xTime & taskWHEEL_MASK ) == ( TickType_t ) 0 )
+		{
+			pxSlot = taskWHEEL_FAR_SLOT( xTime );
+
+			while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+			{
+				pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+				( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+				vListInsertEnd( taskWHEEL_NEAR_SLOT( listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) ) ), &( pxTCB->xStateListItem ) );
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Every task in the near slot for this tick is due now. */
+		pxSlot = taskWHEEL_NEAR_SLOT( xTime );
+
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTCB = ( TCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			configASSERT( listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) ) == xTime );
+
+			( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+
+			/* Is the task waiting on an event also?  If so remove it from the
+			event list. */
+			if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+			{
+				( void ) uxListRemove( &( pxTCB->xEventListItem ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvAddTaskToReadyList( pxTCB );
+
+			#if (  configUSE_PREEMPTION == 1 )
+			{
+				if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+				{
+					xSwitchRequired = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			#endif /* configUSE_PREEMPTION */
+		}
+
+		return xSwitchRequired;
+	}
+	/*-----------------------------------------------------------*/
+
+	#if ( configUSE_TICKLESS_IDLE != 0 )
+
+		static TickType_t prvGetTimingWheelIdleTime( void )
+		{
+		TickType_t xTicks, xTicksToWake, xReturn = portMAX_DELAY;
+		List_t *pxSlot;
+		ListItem_t const *pxItem;
+
+			/* Every task in the near wheel is due within one turn. */
+			for( xTicks = 1; xTicks < taskWHEEL_SLOTS; xTicks++ )
+			{
+				if( listLIST_IS_EMPTY( taskWHEEL_NEAR_SLOT( xTickCount + xTicks ) ) == pdFALSE )
+				{
+					xReturn = xTicks;
+					break;
+				}
+			}
+
+			/* A task in the far wheel can still be due before those in the
+			near wheel, once the turn in which it is due has started.  The
+			first far slot that is not empty holds the next one due, but the
+			tasks within a slot are not in order. */
+			for( xTicks = taskWHEEL_SLOTS - ( xTickCount & taskWHEEL_MASK ); ( xTicks <= taskWHEEL_SPAN ) && ( xTicks < xReturn ); xTicks += taskWHEEL_SLOTS )
+			{
+				pxSlot = taskWHEEL_FAR_SLOT( xTickCount + xTicks );
+
+				if( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+				{
+					for( pxItem = listGET_HEAD_ENTRY( pxSlot ); pxItem != listGET_END_MARKER( pxSlot ); pxItem = listGET_NEXT( pxItem ) )
+					{
+						xTicksToWake = listGET_LIST_ITEM_VALUE( pxItem ) - xTickCount;
+
+						if( xTicksToWake < xReturn )
+						{
+							xReturn = xTicksToWake;
+						}
+					}
+					break;
+				}
+			}
+
+			return xReturn;
+		}
+
+	#endif /* configUSE_TICKLESS_IDLE */
+
+#endif /* configUSE_TIMING_WHEEL */
 
 
 #ifdef FREERTOS_MODULE_TEST
@@ -110,10 +110,123 @@
 #define configMINIMAL_STACK_SIZE	( ( unsigned short ) 85 )
 #define configTOTAL_HEAP_SIZE		( (size_t ) ( 7000 ) )
 #define configMAX_TASK_NAME_LEN		( 8 )
-#define configUSE_TRACE_FACILITY	0
 #define configUSE_16_BIT_TICKS		1
 #define configIDLE_SHOULD_YIELD		1
 #define configQUEUE_REGISTRY_SIZE	0
+#define configUSE_MALLOC_FAILED_HOOK	1
+
+/* Set configSUPPORT_STATIC_ALLOCATION to 1 to create every task, queue and
+co-routine of the demo in a static buffer, the idle task's included (see
+vApplicationGetIdleTaskMemory() in main.c), so the map file shows where all the
+RAM goes.  Dynamic allocation is then off unless set to 1 as well, and the heap
+files build to nothing, but the signal and heap benchmarks and the heap stats
+need it. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION		0
+#endif
+#ifndef configSUPPORT_DYNAMIC_ALLOCATION
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		#define configSUPPORT_DYNAMIC_ALLOCATION	0
+	#else
+		#define configSUPPORT_DYNAMIC_ALLOCATION	1
+	#endif
+#endif
+
+/* Set to 1 to allocate from heap_coalesce.c, which can free and merges
+neighbouring free blocks with 2 byte headers, or 0 for heap_1.c, which cannot
+free but has no headers.  Both files are built, this selects which one is
+used. */
+#ifndef configUSE_COALESCING_HEAP
+	#define configUSE_COALESCING_HEAP	1
+#endif
+
+/* Set to 1 to serve allocations from fixed size block pools first (see
+heap_pools.c).  configBLOCK_POOLS lists the pools as X( block size, number of
+blocks ) - here TCBs, minimal stacks and the queue of one item.  The pools are
+static, so configTOTAL_HEAP_SIZE can be reduced by their size. */
+#ifndef configUSE_BLOCK_POOLS
+	#define configUSE_BLOCK_POOLS		0
+#endif
+#ifndef configBLOCK_POOLS
+	#define configBLOCK_POOLS( X )		X( sizeof( StaticTask_t ), 8 ) X( configMINIMAL_STACK_SIZE, 8 ) X( sizeof( StaticQueue_t ) + 1, 2 )
+#endif
+
+/* Set to 1 to make every queue of 1 byte items a byte queue, which keeps 8 bit
+read and write offsets in place of pointers, copies items by assignment and
+needs fewer bytes of RAM (StaticByteQueue_t) - see queue.c. */
+#ifndef configUSE_BYTE_QUEUES
+	#define configUSE_BYTE_QUEUES		1
+#endif
+
+/* Set to 1 to have every queue keep its read and write positions as 8 bit
+item indices rather than pointers, which takes 4 bytes off each queue,
+semaphore and mutex and limits a queue to 255 items - see queue.c. */
+#ifndef configUSE_QUEUE_INDICES
+	#define configUSE_QUEUE_INDICES		1
+#endif
+
+/* Host simulation only (FreeRTOS/Source/portable/GCC/Posix).  In virtual time
+the tickless idle hooks are used to jump the clock forward while every task is
+blocked. */
+#if defined( portSIM_VIRTUAL_TIME ) && ( portSIM_VIRTUAL_TIME == 1 )
+	#define configUSE_TICKLESS_IDLE		1
+#endif
+
+/* Set to 1 to stop the tick and sleep while every task is blocked (see
+vPortSuppressTicksAndSleep() in the ATmega2560 port.c). */
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE		0
+#endif
+
+/* Set to 1 to record kernel events and send them to the serial port from the
+idle task (see KernelTrace/ktrace.h).  The records are timestamped with the
+run time counter. */
+#ifndef configUSE_KERNEL_TRACE
+	#define configUSE_KERNEL_TRACE		0
+#endif
+
+/* Set to 1 to count the time each task runs in timer 1 counts (4us).  The
+trace facility is needed to read the counts with uxTaskGetSystemState(). */
+#ifndef configGENERATE_RUN_TIME_STATS
+	#define configGENERATE_RUN_TIME_STATS	configUSE_KERNEL_TRACE
+#endif
+#ifndef configUSE_TRACE_FACILITY
+	#define configUSE_TRACE_FACILITY	configGENERATE_RUN_TIME_STATS
+#endif
+
+#if( configUSE_KERNEL_TRACE == 1 )
+	/* Defines the trace macros. */
+	#include "KernelTrace/ktrace.h"
+#endif
+
+/* Set to 1 to count heap allocations and log the task that owns each block
+(see HeapStats/heapstats.h), to find the smallest configTOTAL_HEAP_SIZE that
+will do. */
+#ifndef configUSE_HEAP_STATS
+	#define configUSE_HEAP_STATS		0
+#endif
+
+#if( configUSE_HEAP_STATS == 1 )
+	/* Defines the heap trace macros. */
+	#include "HeapStats/hstrace.h"
+#endif
+
+/* The heap stats also report the RAM used by the queues. */
+#ifndef configUSE_QUEUE_RAM_STATS
+	#define configUSE_QUEUE_RAM_STATS	configUSE_HEAP_STATS
+#endif
+
+/* Set configUSE_TIMING_WHEEL to 1 to keep tasks that block for less than
+2^( 2 * configTIMING_WHEEL_BITS ) ticks in a timing wheel rather than the sorted
+delayed lists, so blocking and unblocking them takes the same time however many
+tasks are blocked.  The wheel costs 2^( configTIMING_WHEEL_BITS + 1 ) lists of
+RAM, 288 bytes with 4 bits. */
+#ifndef configUSE_TIMING_WHEEL
+	#define configUSE_TIMING_WHEEL		0
+#endif
+#ifndef configTIMING_WHEEL_BITS
+	#define configTIMING_WHEEL_BITS		4
+#endif
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		1
@@ -126,9 +239,16 @@ to exclude the API function. */
 #define INCLUDE_uxTaskPriorityGet		0
 #define INCLUDE_vTaskDelete				0
 #define INCLUDE_vTaskCleanUpResources	0
-#define INCLUDE_vTaskSuspend			0
+#if( configUSE_TICKLESS_IDLE == 1 )
+	/* Required by the tickless idle implementation. */
+	#define INCLUDE_vTaskSuspend		1
+#else
+	#define INCLUDE_vTaskSuspend		0
+#endif
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1	/* Used by serial.c. */
+#define INCLUDE_xTaskGetSchedulerState	configUSE_HEAP_STATS	/* Used by heapstats.c. */
 
 /* It is a good idea to define configASSERT() while developing.  configASSERT()
 uses the same semantics as the standard C assert() macro. */
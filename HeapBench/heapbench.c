@@ -0,0 +1,426 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Measures the time pvPortMalloc() and vPortFree() take, and how well the
+ * 	heap stands up to allocations of mixed sizes coming and going, to compare
+ * 	heap_coalesce.c with heap_1.c
+ *
+ */
+
+/*
+ * Runs once, from the heap left over once every other task has been created,
+ * writing its results to the serial port:
+ *
+ *  - Latency: hbSAMPLES blocks of each size in hbSizes[] are allocated, and
+ *    then freed, each call being timed with timer 3, which counts at the CPU
+ *    clock:
+ *
+ *        HEAP coalesce malloc size=32 n=8 min=210 avg=260 max=318
+ *        HEAP coalesce free size=32 n=8 min=190 avg=241 max=301
+ *
+ *  - Churn: hbSLOTS slots each hold a block of a pseudo random size up to
+ *    hbMAX_CHURN_SIZE bytes.  hbCHURN_STEPS times a slot is picked, its block
+ *    freed and a new one allocated.  The count of failed allocations, the
+ *    free heap, the largest block that could still be allocated and the share
+ *    of the free heap that is not in that block follow:
+ *
+ *        HEAP coalesce churn steps=2000 failed=0 free=2210 largest=1790 frag=19%
+ *
+ *    Once the slots are freed again a last line gives the free heap and
+ *    largest block, which are back where they started if every free block
+ *    was merged.
+ *
+ * With configUSE_BLOCK_POOLS set to 1 a line for each block pool follows,
+ * giving the blocks in use, the most ever in use and the requests that found
+ * the pool empty and went to the heap:
+ *
+ *        HEAP pool size=38 blocks=8 used=2 peak=8 fallbacks=112
+ *
+ * heap_1.c cannot free, so with it the blocks are only allocated: the free
+ * lines are left out and the churn stops at the first failed allocation, so
+ * steps is how far it got.  Everything the bench allocated is then lost.
+ *
+ * The serial port is opened here, so the com test tasks cannot run at the
+ * same time.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "heapbench.h"
+
+/* Nothing is built when there is no heap to measure. */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+/* Blocks of each size timed. */
+#define hbSAMPLES						( 8 )
+
+/* The churn. */
+#define hbSLOTS							( 12 )
+#define hbCHURN_STEPS					( ( uint16_t ) 2000 )
+#define hbMAX_CHURN_SIZE				( ( uint16_t ) 96 )
+
+/* Delay before starting, so every other task has been created and has
+allocated what it needs. */
+#define hbSTART_DELAY					( ( TickType_t ) 100 / portTICK_PERIOD_MS )
+
+/* Timer 3 in normal mode, clocked with no prescaler. */
+#define hbTIMER3_NORMAL_TCCR3A			( ( uint8_t ) 0b00000000 )
+#define hbTIMER3_NO_PRESCALE_TCCR3B		( ( uint8_t ) 0b00000001 )
+
+/* Serial output. */
+#define hbQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 48 )
+#define hbTX_BLOCK_TIME					( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define hbSTACK_SIZE					( configMINIMAL_STACK_SIZE + 48 )
+
+#if( configUSE_COALESCING_HEAP == 1 )
+	#define hbHEAP_NAME					"HEAP coalesce "
+	#define hbCAN_FREE					1
+#else
+	#define hbHEAP_NAME					"HEAP heap_1 "
+	#define hbCAN_FREE					0
+#endif
+
+/* The time taken by a number of calls. */
+typedef struct HEAP_TIMES
+{
+	uint16_t usMin;
+	uint16_t usMax;
+	uint32_t ulTotal;
+} HeapTimes_t;
+
+/*
+ * The task that does the measuring.
+ */
+static portTASK_FUNCTION_PROTO( vHeapBenchTask, pvParameters );
+
+/*
+ * Write the lines described at the top of the file.
+ */
+static void prvMeasureLatency( size_t xSize );
+static void prvMeasureChurn( void );
+
+/*
+ * Add one call to a set of times, and write the set.
+ */
+static void prvAddTime( HeapTimes_t *pxTimes, uint16_t usCycles );
+static void prvSendTimes( const char *pcName, size_t xSize, const HeapTimes_t *pxTimes );
+
+/*
+ * Write the free heap and largest block.
+ */
+static void prvSendFree( void );
+
+/*
+ * Write the state of each block pool.
+ */
+#if( configUSE_BLOCK_POOLS == 1 )
+	static void prvSendPools( void );
+#endif
+
+/*
+ * Write a string to the serial port.
+ */
+static void prvSendString( const char *pcString );
+
+/* Handle of the port the results are written to. */
+static xComPortHandle xPort = NULL;
+
+/* Block sizes timed: a small queue, a TCB sized block and a minimal stack. */
+static const size_t xSizes[] = { 8, 32, configMINIMAL_STACK_SIZE };
+
+/* The blocks being timed, and the churned slots. */
+static void *pvBlocks[ hbSAMPLES ];
+static void *pvSlots[ hbSLOTS ];
+
+/*-----------------------------------------------------------*/
+
+void vStartHeapBenchTask( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	xPort = xSerialPortInitMinimal( ulBaudRate, hbQUEUE_LENGTH );
+	xTaskCreate( vHeapBenchTask, "HBench", hbSTACK_SIZE, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vHeapBenchTask, pvParameters )
+{
+UBaseType_t uxSize;
+
+	( void ) pvParameters;
+
+	TCCR3A = hbTIMER3_NORMAL_TCCR3A;
+	TCCR3B = hbTIMER3_NO_PRESCALE_TCCR3B;
+
+	vTaskDelay( hbSTART_DELAY );
+
+	prvSendString( hbHEAP_NAME "start" );
+	prvSendFree();
+
+	for( uxSize = 0; uxSize < ( sizeof( xSizes ) / sizeof( xSizes[ 0 ] ) ); uxSize++ )
+	{
+		prvMeasureLatency( xSizes[ uxSize ] );
+	}
+
+	prvMeasureChurn();
+
+	#if( configUSE_BLOCK_POOLS == 1 )
+	{
+		prvSendPools();
+	}
+	#endif
+
+	for( ;; )
+	{
+		vTaskDelay( portMAX_DELAY );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureLatency( size_t xSize )
+{
+HeapTimes_t xTimes;
+UBaseType_t uxBlock;
+uint16_t usStart;
+
+	xTimes.usMin = 0xffff;
+	xTimes.usMax = 0;
+	xTimes.ulTotal = 0;
+
+	for( uxBlock = 0; uxBlock < hbSAMPLES; uxBlock++ )
+	{
+		usStart = TCNT3;
+		pvBlocks[ uxBlock ] = pvPortMalloc( xSize );
+		prvAddTime( &xTimes, TCNT3 - usStart );
+	}
+	prvSendTimes( "malloc", xSize, &xTimes );
+
+	#if( hbCAN_FREE == 1 )
+	{
+		xTimes.usMin = 0xffff;
+		xTimes.usMax = 0;
+		xTimes.ulTotal = 0;
+
+		for( uxBlock = 0; uxBlock < hbSAMPLES; uxBlock++ )
+		{
+			usStart = TCNT3;
+			vPortFree( pvBlocks[ uxBlock ] );
+			prvAddTime( &xTimes, TCNT3 - usStart );
+		}
+		prvSendTimes( "free", xSize, &xTimes );
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvMeasureChurn( void )
+{
+uint32_t ulRandom = 1UL, ulFree, ulLargest;
+uint16_t usStep, usFailed = 0;
+UBaseType_t uxSlot;
+
+	for( usStep = 0; usStep < hbCHURN_STEPS; usStep++ )
+	{
+		/* A linear congruential generator, so every run is the same. */
+		ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+		uxSlot = ( UBaseType_t ) ( ( ulRandom >> 16 ) % hbSLOTS );
+		ulRandom = ( ulRandom * 1103515245UL ) + 12345UL;
+
+		#if( hbCAN_FREE == 1 )
+		{
+			vPortFree( pvSlots[ uxSlot ] );
+		}
+		#endif
+
+		pvSlots[ uxSlot ] = pvPortMalloc( ( size_t ) ( 1UL + ( ( ulRandom >> 16 ) % hbMAX_CHURN_SIZE ) ) );
+
+		if( pvSlots[ uxSlot ] == NULL )
+		{
+			usFailed++;
+
+			#if( hbCAN_FREE == 0 )
+			{
+				break;
+			}
+			#endif
+		}
+	}
+
+	ulFree = ( uint32_t ) xPortGetFreeHeapSize();
+	ulLargest = ( uint32_t ) xPortGetLargestFreeBlockSize();
+
+	vSerialPutValue( xPort, hbHEAP_NAME "churn steps=", usStep, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " failed=", usFailed, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " free=", ulFree, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " largest=", ulLargest, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " frag=", ( ulFree > 0UL ) ? ( 100UL - ( ( ulLargest * 100UL ) / ulFree ) ) : 0UL, hbTX_BLOCK_TIME );
+	prvSendString( "%\r\n" );
+
+	#if( hbCAN_FREE == 1 )
+	{
+		for( uxSlot = 0; uxSlot < hbSLOTS; uxSlot++ )
+		{
+			vPortFree( pvSlots[ uxSlot ] );
+			pvSlots[ uxSlot ] = NULL;
+		}
+
+		prvSendString( hbHEAP_NAME "end" );
+		prvSendFree();
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddTime( HeapTimes_t *pxTimes, uint16_t usCycles )
+{
+	pxTimes->ulTotal += usCycles;
+
+	if( usCycles < pxTimes->usMin )
+	{
+		pxTimes->usMin = usCycles;
+	}
+
+	if( usCycles > pxTimes->usMax )
+	{
+		pxTimes->usMax = usCycles;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendTimes( const char *pcName, size_t xSize, const HeapTimes_t *pxTimes )
+{
+	prvSendString( hbHEAP_NAME );
+	prvSendString( pcName );
+	vSerialPutValue( xPort, " size=", ( uint32_t ) xSize, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " n=", hbSAMPLES, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " min=", pxTimes->usMin, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " avg=", pxTimes->ulTotal / hbSAMPLES, hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " max=", pxTimes->usMax, hbTX_BLOCK_TIME );
+	prvSendString( "\r\n" );
+
+	/* Let the line go, so the serial interrupts stay out of the timing. */
+	vTaskDelay( hbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendFree( void )
+{
+	vSerialPutValue( xPort, " free=", ( uint32_t ) xPortGetFreeHeapSize(), hbTX_BLOCK_TIME );
+	vSerialPutValue( xPort, " largest=", ( uint32_t ) xPortGetLargestFreeBlockSize(), hbTX_BLOCK_TIME );
+	prvSendString( "\r\n" );
+	vTaskDelay( hbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_BLOCK_POOLS == 1 )
+
+	static void prvSendPools( void )
+	{
+	BlockPoolStats_t xStats;
+	UBaseType_t uxPool;
+
+		for( uxPool = 0; uxPool < uxPortGetBlockPoolCount(); uxPool++ )
+		{
+			vPortGetBlockPoolStats( uxPool, &xStats );
+
+			vSerialPutValue( xPort, "HEAP pool size=", ( uint32_t ) xStats.xBlockSize, hbTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " blocks=", xStats.uxBlocks, hbTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " used=", xStats.uxInUse, hbTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " peak=", xStats.uxMaxInUse, hbTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " fallbacks=", xStats.ulFallbacks, hbTX_BLOCK_TIME );
+			prvSendString( "\r\n" );
+			vTaskDelay( hbTX_BLOCK_TIME );
+		}
+	}
+
+#endif /* configUSE_BLOCK_POOLS */
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), hbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
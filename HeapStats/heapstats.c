@@ -0,0 +1,486 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Counts heap allocations and logs the task that owns each block, to size
+ * 	configTOTAL_HEAP_SIZE.  The trace macros are in HeapStats/hstrace.h.
+ *
+ */
+
+/*
+ * pvPortMalloc() and vPortFree() call the trace macros defined in hstrace.h,
+ * which count the calls and keep a log of the blocks in use - the address,
+ * the size asked for and the task that asked for it.  Blocks allocated before
+ * the scheduler starts, the idle task's included, are owned by main().  Every
+ * hstPERIOD the task writes the totals, then the blocks and bytes held by each
+ * task:
+ *
+ *     HEAPSTAT free=912 min_free=912 peak=6088 allocs=31 frees=0 failed=0 largest=285 untracked=0
+ *     HEAPSTAT task=main blocks=29 bytes=5641
+ *     HEAPSTAT task=Check blocks=2 bytes=123
+ *
+ * peak is configTOTAL_HEAP_SIZE less the least free space there has ever
+ * been, block headers included, so is the smallest configTOTAL_HEAP_SIZE that
+ * would have done.  With block pools in use (configUSE_BLOCK_POOLS) the blocks
+ * from the pools are counted and logged, but are not part of the heap figures.
+ *
+ * With configUSE_QUEUE_RAM_STATS set to 1 a line follows the totals with the
+ * RAM used by the queues, semaphores and mutexes, static ones included - the
+ * bytes of their structures and of their storage, and the bytes fewer their
+ * structures need than with read and write pointers, in all and per queue:
+ *
+ *     HEAPSTAT queues=6 struct=168 storage=330 saved=24 per_queue=4
+ *
+ * vHeapStatsNotifyFailure(), for vApplicationMallocFailedHook(), wakes the
+ * task, which then writes the last failed allocation.  The hook runs in the
+ * task that called pvPortMalloc(), so does not write to the serial port
+ * itself.  Failures before the scheduler starts are written when the task
+ * first runs:
+ *
+ *     HEAPSTAT failed size=85 task=Check caller=0x1a2b
+ *
+ * The serial port is opened here, so the com test tasks cannot run at the
+ * same time.
+ */
+
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "heapstats.h"
+
+/* Nothing is built unless the heap is being traced. */
+#if( configUSE_HEAP_STATS == 1 )
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION != 1 )
+	#error The heap stats need configSUPPORT_DYNAMIC_ALLOCATION set to 1.
+#endif
+
+#if( INCLUDE_xTaskGetSchedulerState != 1 )
+	#error The heap stats need INCLUDE_xTaskGetSchedulerState set to 1.
+#endif
+
+/* Time between reports. */
+#define hstPERIOD						( ( TickType_t ) 5000 / portTICK_PERIOD_MS )
+
+/* Serial output. */
+#define hstQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 48 )
+#define hstTX_BLOCK_TIME				( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define hstSTACK_SIZE					( configMINIMAL_STACK_SIZE + 48 )
+
+/* A block in use. */
+typedef struct HEAP_LOG_ENTRY
+{
+	void *pvBlock;
+	size_t xSize;						/* As asked for, without the header or padding. */
+	TaskHandle_t xOwner;				/* NULL if allocated before the scheduler started. */
+} HeapLogEntry_t;
+
+/*
+ * The task that writes the report.
+ */
+static portTASK_FUNCTION_PROTO( vHeapStatsTask, pvParameters );
+
+/*
+ * The task running, or NULL before the scheduler has started, when
+ * xTaskGetCurrentTaskHandle() would give the last task created.
+ */
+static TaskHandle_t prvGetOwner( void );
+
+/*
+ * Write the last allocation that failed.
+ */
+static void prvSendFailure( void );
+
+/*
+ * Write a string, a hex value or the name of a task to the serial port.
+ */
+static void prvSendString( const char *pcString, TickType_t xBlockTime );
+static void prvSendHex( portPOINTER_SIZE_TYPE uxValue, TickType_t xBlockTime );
+static void prvSendOwner( TaskHandle_t xOwner, TickType_t xBlockTime );
+
+/* Handle of the port the report is written to. */
+static xComPortHandle xPort = NULL;
+
+/* The task that writes the report, woken by vHeapStatsNotifyFailure(). */
+static TaskHandle_t xHeapStatsTask = NULL;
+
+/* The blocks in use, the first uxLogUsed entries of the array. */
+static HeapLogEntry_t xLog[ hstLOG_LENGTH ];
+static UBaseType_t uxLogUsed = 0;
+
+static HeapStats_t xStats = { 0 };
+
+/* The last allocation that failed. */
+static size_t xFailedSize = 0;
+static TaskHandle_t xFailedOwner = NULL;
+static void *pvFailedCaller = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vStartHeapStatsTask( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	xPort = xSerialPortInitMinimal( ulBaudRate, hstQUEUE_LENGTH );
+	xTaskCreate( vHeapStatsTask, "HStats", hstSTACK_SIZE, NULL, uxPriority, &xHeapStatsTask );
+}
+/*-----------------------------------------------------------*/
+
+void vHeapStatsMalloc( void *pvBlock, size_t xWantedSize, void *pvCaller )
+{
+	if( xWantedSize > xStats.xLargestRequest )
+	{
+		xStats.xLargestRequest = xWantedSize;
+	}
+
+	if( pvBlock == NULL )
+	{
+		xStats.ulFailures++;
+		xFailedSize = xWantedSize;
+		xFailedOwner = prvGetOwner();
+		pvFailedCaller = pvCaller;
+	}
+	else
+	{
+		xStats.ulAllocations++;
+
+		if( uxLogUsed < ( UBaseType_t ) hstLOG_LENGTH )
+		{
+			xLog[ uxLogUsed ].pvBlock = pvBlock;
+			xLog[ uxLogUsed ].xSize = xWantedSize;
+			xLog[ uxLogUsed ].xOwner = prvGetOwner();
+			uxLogUsed++;
+		}
+		else
+		{
+			xStats.usUntracked++;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vHeapStatsFree( void *pvBlock )
+{
+UBaseType_t uxEntry;
+BaseType_t xFound = pdFALSE;
+
+	xStats.ulFrees++;
+
+	for( uxEntry = 0; uxEntry < uxLogUsed; uxEntry++ )
+	{
+		if( xLog[ uxEntry ].pvBlock == pvBlock )
+		{
+			/* The order of the log does not matter, so the last entry fills
+			the gap. */
+			uxLogUsed--;
+			xLog[ uxEntry ] = xLog[ uxLogUsed ];
+			xFound = pdTRUE;
+			break;
+		}
+	}
+
+	if( ( xFound == pdFALSE ) && ( xStats.usUntracked > 0U ) )
+	{
+		xStats.usUntracked--;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vHeapStatsGet( HeapStats_t *pxStats )
+{
+	vTaskSuspendAll();
+	{
+		*pxStats = xStats;
+	}
+	( void ) xTaskResumeAll();
+
+	pxStats->xFreeBytes = xPortGetFreeHeapSize();
+	pxStats->xMinimumEverFreeBytes = xPortGetMinimumEverFreeHeapSize();
+}
+/*-----------------------------------------------------------*/
+
+void vHeapStatsNotifyFailure( void )
+{
+	/* vHeapStatsMalloc() has already recorded the failure.  Before the
+	scheduler starts the task finds it when it first runs. */
+	if( ( xHeapStatsTask != NULL ) && ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) )
+	{
+		( void ) xTaskNotifyGive( xHeapStatsTask );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vHeapStatsTask, pvParameters )
+{
+HeapStats_t xCopy;
+#if( configUSE_QUEUE_RAM_STATS == 1 )
+	QueueRAMStats_t xQueueStats;
+#endif
+UBaseType_t uxEntry, uxOther;
+TaskHandle_t xOwner;
+uint32_t ulBlocks, ulBytes, ulFailures, ulFailuresSent = 0UL;
+BaseType_t xFirst;
+TimeOut_t xTimeOut;
+TickType_t xTicksToWait = hstPERIOD;
+
+	( void ) pvParameters;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		/* Several failures between wakes are written as the last. */
+		vTaskSuspendAll();
+		{
+			ulFailures = xStats.ulFailures;
+		}
+		( void ) xTaskResumeAll();
+
+		if( ulFailures != ulFailuresSent )
+		{
+			ulFailuresSent = ulFailures;
+			prvSendFailure();
+		}
+
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			/* Not yet time for the report, so wait for the rest of the
+			period or to be woken by vHeapStatsNotifyFailure(). */
+			( void ) ulTaskNotifyTake( pdTRUE, xTicksToWait );
+			continue;
+		}
+
+		xTicksToWait = hstPERIOD;
+		vTaskSetTimeOutState( &xTimeOut );
+
+		vHeapStatsGet( &xCopy );
+
+		vSerialPutValue( xPort, "HEAPSTAT free=", ( uint32_t ) xCopy.xFreeBytes, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " min_free=", ( uint32_t ) xCopy.xMinimumEverFreeBytes, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " peak=", ( uint32_t ) ( configTOTAL_HEAP_SIZE - xCopy.xMinimumEverFreeBytes ), hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " allocs=", xCopy.ulAllocations, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " frees=", xCopy.ulFrees, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " failed=", xCopy.ulFailures, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " largest=", ( uint32_t ) xCopy.xLargestRequest, hstTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " untracked=", ( uint32_t ) xCopy.usUntracked, hstTX_BLOCK_TIME );
+		prvSendString( "\r\n", hstTX_BLOCK_TIME );
+
+		#if( configUSE_QUEUE_RAM_STATS == 1 )
+		{
+			vQueueGetRAMStats( &xQueueStats );
+
+			vSerialPutValue( xPort, "HEAPSTAT queues=", ( uint32_t ) xQueueStats.uxQueues, hstTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " struct=", ( uint32_t ) xQueueStats.xStructureBytes, hstTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " storage=", ( uint32_t ) xQueueStats.xStorageBytes, hstTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " saved=", ( uint32_t ) xQueueStats.xBytesSaved, hstTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " per_queue=", ( xQueueStats.uxQueues == ( UBaseType_t ) 0 ) ? 0UL : ( uint32_t ) ( xQueueStats.xBytesSaved / ( size_t ) xQueueStats.uxQueues ), hstTX_BLOCK_TIME );
+			prvSendString( "\r\n", hstTX_BLOCK_TIME );
+		}
+		#endif
+
+		/* One line per task, for the first entry in the log that task owns.
+		The log is read with the scheduler suspended, but can change between
+		lines. */
+		for( uxEntry = 0; uxEntry < ( UBaseType_t ) hstLOG_LENGTH; uxEntry++ )
+		{
+			xFirst = pdFALSE;
+			ulBlocks = 0UL;
+			ulBytes = 0UL;
+			xOwner = NULL;
+
+			vTaskSuspendAll();
+			{
+				if( uxEntry < uxLogUsed )
+				{
+					xOwner = xLog[ uxEntry ].xOwner;
+					xFirst = pdTRUE;
+
+					for( uxOther = 0; uxOther < uxLogUsed; uxOther++ )
+					{
+						if( xLog[ uxOther ].xOwner == xOwner )
+						{
+							if( uxOther < uxEntry )
+							{
+								/* Already reported. */
+								xFirst = pdFALSE;
+								break;
+							}
+
+							ulBlocks++;
+							ulBytes += ( uint32_t ) xLog[ uxOther ].xSize;
+						}
+					}
+				}
+			}
+			( void ) xTaskResumeAll();
+
+			if( xFirst != pdFALSE )
+			{
+				prvSendString( "HEAPSTAT task=", hstTX_BLOCK_TIME );
+				prvSendOwner( xOwner, hstTX_BLOCK_TIME );
+				vSerialPutValue( xPort, " blocks=", ulBlocks, hstTX_BLOCK_TIME );
+				vSerialPutValue( xPort, " bytes=", ulBytes, hstTX_BLOCK_TIME );
+				prvSendString( "\r\n", hstTX_BLOCK_TIME );
+			}
+		}
+
+		prvSendString( "\r\n", hstTX_BLOCK_TIME );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static TaskHandle_t prvGetOwner( void )
+{
+TaskHandle_t xOwner = NULL;
+
+	if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+	{
+		xOwner = xTaskGetCurrentTaskHandle();
+	}
+
+	return xOwner;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendFailure( void )
+{
+size_t xSize;
+TaskHandle_t xOwner;
+void *pvCaller;
+
+	vTaskSuspendAll();
+	{
+		xSize = xFailedSize;
+		xOwner = xFailedOwner;
+		pvCaller = pvFailedCaller;
+	}
+	( void ) xTaskResumeAll();
+
+	vSerialPutValue( xPort, "HEAPSTAT failed size=", ( uint32_t ) xSize, hstTX_BLOCK_TIME );
+	prvSendString( " task=", hstTX_BLOCK_TIME );
+	prvSendOwner( xOwner, hstTX_BLOCK_TIME );
+	prvSendString( " caller=0x", hstTX_BLOCK_TIME );
+	prvSendHex( ( portPOINTER_SIZE_TYPE ) pvCaller, hstTX_BLOCK_TIME );
+	prvSendString( "\r\n", hstTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString, TickType_t xBlockTime )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), xBlockTime );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendHex( portPOINTER_SIZE_TYPE uxValue, TickType_t xBlockTime )
+{
+char cBuffer[ ( sizeof( void * ) * 2 ) + 1 ];
+char *pcDigit = &( cBuffer[ sizeof( cBuffer ) - 1 ] );
+const char * const pcHex = "0123456789abcdef";
+
+	/* Two digits for each byte of a pointer. */
+	*pcDigit = '\0';
+	while( pcDigit != cBuffer )
+	{
+		pcDigit--;
+		*pcDigit = pcHex[ uxValue & ( portPOINTER_SIZE_TYPE ) 0x0f ];
+		uxValue >>= 4;
+	}
+
+	prvSendString( cBuffer, xBlockTime );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendOwner( TaskHandle_t xOwner, TickType_t xBlockTime )
+{
+	if( xOwner == NULL )
+	{
+		prvSendString( "main", xBlockTime );
+	}
+	else
+	{
+		prvSendString( pcTaskGetName( xOwner ), xBlockTime );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_STATS */
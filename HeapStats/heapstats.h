@@ -0,0 +1,132 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Counts heap allocations and logs the task that owns each block, to size
+ * 	configTOTAL_HEAP_SIZE.  The trace macros are in HeapStats/hstrace.h.
+ *
+ */
+
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#if( configUSE_HEAP_STATS == 1 )
+
+/* The most blocks the log can hold at once.  Each entry is three pointer sized
+words, 6 bytes on the AVR.  Blocks allocated while the log is full are counted
+but not owned by any task. */
+#ifndef hstLOG_LENGTH
+	#define hstLOG_LENGTH				( 32 )
+#endif
+
+typedef struct HEAP_STATS
+{
+	size_t xFreeBytes;					/* xPortGetFreeHeapSize(). */
+	size_t xMinimumEverFreeBytes;		/* xPortGetMinimumEverFreeHeapSize(). */
+	size_t xLargestRequest;				/* The largest size passed to pvPortMalloc(), whether it succeeded or not. */
+	uint32_t ulAllocations;				/* Successful calls to pvPortMalloc(). */
+	uint32_t ulFrees;
+	uint32_t ulFailures;				/* Calls to pvPortMalloc() that returned NULL. */
+	uint16_t usUntracked;				/* Blocks in use that are not in the log. */
+} HeapStats_t;
+
+/*
+ * Open the serial port, then create the task that writes the statistics and
+ * the blocks held by each task to it every 5 seconds.  Call before creating
+ * any other task so an allocation failure while they are created can be
+ * reported.
+ */
+void vStartHeapStatsTask( UBaseType_t uxPriority, unsigned long ulBaudRate );
+
+/*
+ * Take a copy of the statistics.
+ */
+void vHeapStatsGet( HeapStats_t *pxStats );
+
+/*
+ * Wake the task so it writes the size, task and caller of the last allocation
+ * that failed to the serial port.  Does not write anything itself, so does not
+ * block.  For use from vApplicationMallocFailedHook().
+ */
+void vHeapStatsNotifyFailure( void );
+
+#endif /* configUSE_HEAP_STATS */
+
+#endif
+
@@ -0,0 +1,332 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Records kernel events into a RAM buffer that is sent to the serial port
+ * 	from the idle task.
+ *
+ */
+
+/*
+ * The trace macros in ktrace.h write fixed size records into a ring buffer
+ * with interrupts masked, which takes a few microseconds per event.  The idle
+ * hook copies the buffer into the serial Tx queue, so the trace only uses time
+ * that no task wants.  When the buffer is full records are dropped and
+ * counted, and the count is sent in a ktrLOST record once there is room again.
+ *
+ * The buffer indices are 8 bits so the idle task can read the head written by
+ * an interrupt without masking interrupts.
+ */
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "ktrace.h"
+
+#if( configUSE_KERNEL_TRACE == 1 )
+
+#if( configGENERATE_RUN_TIME_STATS != 1 ) || ( configUSE_TRACE_FACILITY != 1 )
+	#error The kernel trace needs configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY set to 1.
+#endif
+
+#if( ktrBUFFER_SIZE > 256 ) || ( ( ktrBUFFER_SIZE & ( ktrBUFFER_SIZE - 1 ) ) != 0 ) || ( ktrBUFFER_SIZE < ( 4 * ktrRECORD_SIZE ) )
+	#error ktrBUFFER_SIZE must be a power of 2 from 16 to 256.
+#endif
+
+#define ktrBUFFER_MASK					( ktrBUFFER_SIZE - 1 )
+
+/* Length of the serial Tx queue the buffer is copied into. */
+#define ktrQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 64 )
+
+/*
+ * Check there is room for uxRecords records, plus a ktrTIME_HIGH record if the
+ * upper half of ulTime has changed and a ktrLOST record if any records have
+ * been dropped, and write those two if needed.  Counts a dropped record and
+ * returns pdFALSE if there is not room.  Called with interrupts masked.
+ */
+static BaseType_t prvReserve( UBaseType_t uxRecords, uint32_t ulTime );
+
+/*
+ * Write one record at the head of the buffer.  Called with interrupts masked
+ * once prvReserve() has returned pdTRUE.
+ */
+static void prvWrite( uint8_t ucType, uint8_t ucArgument, uint16_t usValue );
+
+/* The ring buffer.  Records are written at ucHead and sent from ucTail. */
+static uint8_t ucBuffer[ ktrBUFFER_SIZE ];
+static volatile uint8_t ucHead = 0;
+static volatile uint8_t ucTail = 0;
+
+/* The upper half of the run time counter as last sent.  The decoder starts
+from 0. */
+static uint16_t usTimeHigh = 0;
+
+/* Records dropped since the last ktrLOST record. */
+static uint8_t ucLost = 0;
+
+/* Number given to the next queue created, or 0 while vKernelTraceStart() is
+creating the serial queues. */
+static uint8_t ucNextQueue = 1;
+static BaseType_t xIgnoreQueues = pdFALSE;
+
+/* Nothing is sent until the serial port is open. */
+static BaseType_t xStarted = pdFALSE;
+static xComPortHandle xPort = NULL;
+
+/*-----------------------------------------------------------*/
+
+void vKernelTraceStart( unsigned long ulBaudRate )
+{
+UBaseType_t uxSavedInterruptStatus;
+
+	xIgnoreQueues = pdTRUE;
+	xPort = xSerialPortInitMinimal( ulBaudRate, ktrQUEUE_LENGTH );
+	xIgnoreQueues = pdFALSE;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		/* Anything recorded before the start record could not be decoded. */
+		ucHead = 0;
+		ucTail = 0;
+		ucLost = 0;
+		usTimeHigh = 0;
+
+		prvWrite( ktrSTART, ktrVERSION, ( uint16_t ) 'K' | ( ( uint16_t ) 'T' << 8 ) );
+		xStarted = pdTRUE;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+void vKernelTraceDrain( void )
+{
+BaseType_t xSpace = xStarted;
+
+	while( ( xSpace != pdFALSE ) && ( ucTail != ucHead ) )
+	{
+		xSpace = xSerialPutChar( xPort, ( signed char ) ucBuffer[ ucTail ], ( TickType_t ) 0 );
+
+		if( xSpace != pdFALSE )
+		{
+			ucTail = ( uint8_t ) ( ( ucTail + 1 ) & ktrBUFFER_MASK );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vKernelTraceRecord( uint8_t ucType, uint8_t ucArgument )
+{
+UBaseType_t uxSavedInterruptStatus;
+uint32_t ulTime;
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		ulTime = portGET_RUN_TIME_COUNTER_VALUE();
+
+		if( prvReserve( 1, ulTime ) != pdFALSE )
+		{
+			prvWrite( ucType, ucArgument, ( uint16_t ) ulTime );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+void vKernelTraceQueueRecord( uint8_t ucType, uint8_t ucQueue )
+{
+	/* Queue 0 is the serial port the trace is sent to. */
+	if( ucQueue != 0 )
+	{
+		vKernelTraceRecord( ucType, ucQueue );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vKernelTraceTaskCreate( uint8_t ucTask, const char *pcName )
+{
+UBaseType_t uxSavedInterruptStatus, uxName, uxLength;
+uint32_t ulTime;
+
+	/* The name is sent two characters per ktrTASK_NAME record, always ending
+	with a 0. */
+	for( uxLength = 0; ( uxLength < configMAX_TASK_NAME_LEN ) && ( pcName[ uxLength ] != '\0' ); uxLength++ )
+	{
+	}
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		ulTime = portGET_RUN_TIME_COUNTER_VALUE();
+
+		if( prvReserve( 1 + ( ( uxLength + 2 ) / 2 ), ulTime ) != pdFALSE )
+		{
+			prvWrite( ktrTASK_CREATE, ucTask, ( uint16_t ) ulTime );
+
+			for( uxName = 0; uxName <= uxLength; uxName += 2 )
+			{
+				prvWrite( ktrTASK_NAME, ucTask, ( uint16_t ) ( uint8_t ) pcName[ uxName ] | ( ( uint16_t ) ( ( uxName + 1 ) < uxLength ? ( uint8_t ) pcName[ uxName + 1 ] : 0 ) << 8 ) );
+			}
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
+
+uint8_t ucKernelTraceQueueCreate( void )
+{
+uint8_t ucQueue = 0;
+
+	if( xIgnoreQueues == pdFALSE )
+	{
+		ucQueue = ucNextQueue;
+
+		/* Queues past 255 all share the last number. */
+		if( ucNextQueue < 0xff )
+		{
+			ucNextQueue++;
+		}
+
+		vKernelTraceRecord( ktrQUEUE_CREATE, ucQueue );
+	}
+
+	return ucQueue;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvReserve( UBaseType_t uxRecords, uint32_t ulTime )
+{
+uint16_t usHigh = ( uint16_t ) ( ulTime >> 16 );
+UBaseType_t uxFree;
+BaseType_t xReturn = pdFALSE;
+
+	if( usHigh != usTimeHigh )
+	{
+		uxRecords++;
+	}
+
+	if( ucLost != 0 )
+	{
+		uxRecords++;
+	}
+
+	/* One record is always left empty so a full buffer can be told from an
+	empty one. */
+	uxFree = ( ktrBUFFER_SIZE - ktrRECORD_SIZE - ( ( UBaseType_t ) ( ucHead - ucTail ) & ktrBUFFER_MASK ) ) / ktrRECORD_SIZE;
+
+	if( uxFree >= uxRecords )
+	{
+		if( usHigh != usTimeHigh )
+		{
+			prvWrite( ktrTIME_HIGH, 0, usHigh );
+			usTimeHigh = usHigh;
+		}
+
+		if( ucLost != 0 )
+		{
+			prvWrite( ktrLOST, ucLost, ( uint16_t ) ulTime );
+			ucLost = 0;
+		}
+
+		xReturn = pdTRUE;
+	}
+	else if( ucLost < 0xff )
+	{
+		ucLost++;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvWrite( uint8_t ucType, uint8_t ucArgument, uint16_t usValue )
+{
+uint8_t ucIndex = ucHead;
+
+	ucBuffer[ ucIndex ] = ucType;
+	ucBuffer[ ucIndex + 1 ] = ucArgument;
+	ucBuffer[ ucIndex + 2 ] = ( uint8_t ) usValue;
+	ucBuffer[ ucIndex + 3 ] = ( uint8_t ) ( usValue >> 8 );
+
+	ucHead = ( uint8_t ) ( ( ucIndex + ktrRECORD_SIZE ) & ktrBUFFER_MASK );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_KERNEL_TRACE */
+
@@ -0,0 +1,189 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Records kernel events into a RAM buffer that is sent to the serial port
+ * 	from the idle task.  Included by FreeRTOSConfig.h when
+ * 	configUSE_KERNEL_TRACE is 1, as it defines the kernel trace macros.
+ *
+ */
+
+#ifndef KERNEL_TRACE_H
+#define KERNEL_TRACE_H
+
+/* Also included by the demo files, after the kernel has defined the trace
+macros it was not given. */
+#if( configUSE_KERNEL_TRACE == 1 )
+
+/*
+ * Stream format.  Every record is four bytes: the record type, an argument and
+ * the low 16 bits of the run time counter (timer 1 counts of 4us), least
+ * significant byte first.  The upper 16 bits of the counter are sent in a
+ * ktrTIME_HIGH record whenever they change.  Task and queue numbers are 1 based
+ * and assigned in order of creation.  Tools/ktrace2json decodes the stream.
+ */
+#define ktrRECORD_SIZE						( 4 )
+
+#define ktrSTART							( 0x00 )	/* Argument ktrVERSION, time "KT". */
+#define ktrTIME_HIGH						( 0x01 )	/* Time holds the upper 16 bits. */
+#define ktrLOST								( 0x02 )	/* Argument records dropped, up to 255. */
+#define ktrTASK_CREATE						( 0x03 )	/* Argument task, followed by ktrTASK_NAME. */
+#define ktrTASK_NAME						( 0x04 )	/* Argument task, time holds two characters. */
+#define ktrTASK_SWITCHED_IN					( 0x05 )	/* Argument task. */
+#define ktrTASK_DELAY						( 0x06 )
+#define ktrTASK_DELAY_UNTIL					( 0x07 )
+#define ktrTICK								( 0x08 )	/* Argument low byte of the tick count. */
+#define ktrQUEUE_CREATE						( 0x10 )	/* Argument queue for all the queue records. */
+#define ktrMUTEX_CREATE						( 0x11 )
+#define ktrQUEUE_SEND						( 0x12 )
+#define ktrQUEUE_SEND_FAILED				( 0x13 )
+#define ktrQUEUE_RECEIVE					( 0x14 )
+#define ktrQUEUE_RECEIVE_FAILED				( 0x15 )
+#define ktrQUEUE_PEEK						( 0x16 )
+#define ktrBLOCKING_ON_QUEUE_SEND			( 0x17 )
+#define ktrBLOCKING_ON_QUEUE_RECEIVE		( 0x18 )
+#define ktrQUEUE_SEND_FROM_ISR				( 0x19 )
+#define ktrQUEUE_SEND_FROM_ISR_FAILED		( 0x1a )
+#define ktrQUEUE_RECEIVE_FROM_ISR			( 0x1b )
+#define ktrQUEUE_RECEIVE_FROM_ISR_FAILED	( 0x1c )
+
+#define ktrVERSION							( 1 )
+
+/* Size of the RAM buffer, a power of 2 no larger than 256. */
+#ifndef ktrBUFFER_SIZE
+	#define ktrBUFFER_SIZE					( 256 )
+#endif
+
+/* A tick record every millisecond costs 4000 bytes a second of the 11520 the
+serial port can send at 115200 baud, so they are off by default. */
+#ifndef ktrRECORD_TICKS
+	#define ktrRECORD_TICKS					0
+#endif
+
+/*
+ * Open the serial port and write the ktrSTART record.  Call before creating
+ * any task or queue so they are all named in the stream.
+ */
+void vKernelTraceStart( unsigned long ulBaudRate );
+
+/*
+ * Send as much of the buffer as fits in the serial queue without blocking.
+ * Called from the idle hook.
+ */
+void vKernelTraceDrain( void );
+
+/*
+ * Called from the trace macros.  Each masks interrupts itself, so can be
+ * called from a task, a critical section or an interrupt.
+ */
+void vKernelTraceRecord( uint8_t ucType, uint8_t ucArgument );
+void vKernelTraceQueueRecord( uint8_t ucType, uint8_t ucQueue );
+void vKernelTraceTaskCreate( uint8_t ucTask, const char *pcName );
+uint8_t ucKernelTraceQueueCreate( void );
+
+/* The kernel trace macros.  Those used in tasks.c refer to pxCurrentTCB, and
+those used in queue.c to the queue number, which is set on creation.  Queues
+created by vKernelTraceStart() keep the number 0 and are not recorded, as
+otherwise sending the trace would itself be traced. */
+#define traceTASK_SWITCHED_IN()						vKernelTraceRecord( ktrTASK_SWITCHED_IN, ( uint8_t ) pxCurrentTCB->uxTCBNumber )
+#define traceTASK_CREATE( pxNewTCB )				vKernelTraceTaskCreate( ( uint8_t ) ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+#define traceTASK_DELAY()							vKernelTraceRecord( ktrTASK_DELAY, ( uint8_t ) pxCurrentTCB->uxTCBNumber )
+#define traceTASK_DELAY_UNTIL( xTimeToWake )		vKernelTraceRecord( ktrTASK_DELAY_UNTIL, ( uint8_t ) pxCurrentTCB->uxTCBNumber )
+
+#if( ktrRECORD_TICKS == 1 )
+	#define traceTASK_INCREMENT_TICK( xTickCount )	vKernelTraceRecord( ktrTICK, ( uint8_t ) ( xTickCount ) )
+#endif
+
+#define traceQUEUE_CREATE( pxNewQueue )						( pxNewQueue )->uxQueueNumber = ( UBaseType_t ) ucKernelTraceQueueCreate()
+#define traceCREATE_MUTEX( pxNewQueue )						vKernelTraceQueueRecord( ktrMUTEX_CREATE, ( uint8_t ) ( pxNewQueue )->uxQueueNumber )
+#define traceQUEUE_SEND( pxQueue )							vKernelTraceQueueRecord( ktrQUEUE_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_SEND_FAILED( pxQueue )					vKernelTraceQueueRecord( ktrQUEUE_SEND_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE( pxQueue )						vKernelTraceQueueRecord( ktrQUEUE_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )				vKernelTraceQueueRecord( ktrQUEUE_RECEIVE_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_PEEK( pxQueue )							vKernelTraceQueueRecord( ktrQUEUE_PEEK, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )				vKernelTraceQueueRecord( ktrBLOCKING_ON_QUEUE_SEND, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )			vKernelTraceQueueRecord( ktrBLOCKING_ON_QUEUE_RECEIVE, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )					vKernelTraceQueueRecord( ktrQUEUE_SEND_FROM_ISR, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )			vKernelTraceQueueRecord( ktrQUEUE_SEND_FROM_ISR_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )				vKernelTraceQueueRecord( ktrQUEUE_RECEIVE_FROM_ISR, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue )		vKernelTraceQueueRecord( ktrQUEUE_RECEIVE_FROM_ISR_FAILED, ( uint8_t ) ( pxQueue )->uxQueueNumber )
+
+#endif /* configUSE_KERNEL_TRACE */
+
+#endif
+
@@ -101,12 +101,23 @@ static void prvRegisterCheck2( void *pvParameters );
 /* Set to a non zero value should an error be found. */
 portBASE_TYPE xRegTestError = pdFALSE;
 
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The TCBs and stacks of the two tasks. */
+	static StaticTask_t xRegTest1TaskBuffer, xRegTest2TaskBuffer;
+	static StackType_t xRegTest1Stack[ configMINIMAL_STACK_SIZE ], xRegTest2Stack[ configMINIMAL_STACK_SIZE ];
+#endif
+
 /*-----------------------------------------------------------*/
 
 void vStartRegTestTasks( void )
 {
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskCreateStatic( prvRegisterCheck1, "Reg1", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, xRegTest1Stack, &xRegTest1TaskBuffer );
+	xTaskCreateStatic( prvRegisterCheck2, "Reg2", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, xRegTest2Stack, &xRegTest2TaskBuffer );
+#else
 	xTaskCreate( prvRegisterCheck1, "Reg1", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
 	xTaskCreate( prvRegisterCheck2, "Reg2", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -0,0 +1,224 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Periodically writes the run time stats of every task to the serial port
+ *
+ */
+
+/*
+ * Every rtsPERIOD the task writes the same table vTaskGetRunTimeStats() would
+ * produce - the task name, the run time counter value and the percentage of
+ * the total run time - followed by a blank line:
+ *
+ *     Total	1250000
+ *     IDLE		862519		69%
+ *     Check	1042		<1%
+ *     ...
+ *
+ * The counter is in timer 1 counts (4us), so the first line gives the total.
+ * The numbers are cumulative since the scheduler started.
+ *
+ * vTaskGetRunTimeStats() itself cannot be used as it frees a buffer, which
+ * heap_1 does not allow, so the task states are read into a static array and
+ * formatted here.  The serial port is opened here, so the com test tasks
+ * cannot run at the same time.
+ */
+
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "rtstats.h"
+
+/* Nothing is built unless the kernel is counting run time. */
+#if( configGENERATE_RUN_TIME_STATS == 1 )
+
+#if( configUSE_TRACE_FACILITY != 1 )
+	#error The run time stats task needs configUSE_TRACE_FACILITY set to 1.
+#endif
+
+/* Time between tables. */
+#define rtsPERIOD						( ( TickType_t ) 5000 / portTICK_PERIOD_MS )
+
+/* The most tasks that will be reported. */
+#define rtsMAX_TASKS					( 16 )
+
+/* Serial output. */
+#define rtsQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 48 )
+#define rtsTX_BLOCK_TIME				( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define rtsSTACK_SIZE					( configMINIMAL_STACK_SIZE + 48 )
+
+/*
+ * The task that writes the table.
+ */
+static portTASK_FUNCTION_PROTO( vRunTimeStatsTask, pvParameters );
+
+/*
+ * Write a string to the serial port.
+ */
+static void prvSendString( const char *pcString );
+
+/* Handle of the port the table is written to. */
+static xComPortHandle xPort = NULL;
+
+/* The state of each task, filled in by uxTaskGetSystemState(). */
+static TaskStatus_t xTaskStatus[ rtsMAX_TASKS ];
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The task's TCB and stack. */
+	static StaticTask_t xRunTimeStatsTaskBuffer;
+	static StackType_t xRunTimeStatsStack[ rtsSTACK_SIZE ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+void vStartRunTimeStatsTask( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	xPort = xSerialPortInitMinimal( ulBaudRate, rtsQUEUE_LENGTH );
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskCreateStatic( vRunTimeStatsTask, "Stats", rtsSTACK_SIZE, NULL, uxPriority, xRunTimeStatsStack, &xRunTimeStatsTaskBuffer );
+#else
+	xTaskCreate( vRunTimeStatsTask, "Stats", rtsSTACK_SIZE, NULL, uxPriority, NULL );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vRunTimeStatsTask, pvParameters )
+{
+UBaseType_t uxTasks, uxTask;
+uint32_t ulTotalRunTime, ulPercentage;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		vTaskDelay( rtsPERIOD );
+
+		uxTasks = uxTaskGetSystemState( xTaskStatus, rtsMAX_TASKS, &ulTotalRunTime );
+
+		vSerialPutValue( xPort, "Total\t", ulTotalRunTime, rtsTX_BLOCK_TIME );
+		prvSendString( "\r\n" );
+
+		/* For percentage calculations. */
+		ulTotalRunTime /= 100UL;
+
+		for( uxTask = 0; uxTask < uxTasks; uxTask++ )
+		{
+			prvSendString( xTaskStatus[ uxTask ].pcTaskName );
+			vSerialPutValue( xPort, "\t\t", xTaskStatus[ uxTask ].ulRunTimeCounter, rtsTX_BLOCK_TIME );
+
+			if( ulTotalRunTime > 0UL )
+			{
+				ulPercentage = xTaskStatus[ uxTask ].ulRunTimeCounter / ulTotalRunTime;
+			}
+			else
+			{
+				ulPercentage = 0UL;
+			}
+
+			if( ulPercentage > 0UL )
+			{
+				vSerialPutValue( xPort, "\t\t", ulPercentage, rtsTX_BLOCK_TIME );
+				prvSendString( "%\r\n" );
+			}
+			else
+			{
+				/* If the percentage is zero here then the task has consumed
+				less than 1% of the total run time. */
+				prvSendString( "\t\t<1%\r\n" );
+			}
+		}
+
+		prvSendString( "\r\n" );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), rtsTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configGENERATE_RUN_TIME_STATS */
+
@@ -0,0 +1,384 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Measures the sustained throughput of the serial driver, and the CPU time
+ * 	it takes, through the loopback connector
+ *
+ */
+
+/*
+ * Needs the same loopback connector as the com test tasks.  Each cycle:
+ *
+ *  - With the port quiet, a task at the idle priority counts how many times it
+ *    goes round a loop in sbCALIBRATE_PERIOD.
+ *  - The Tx task then writes an incrementing byte pattern as fast as the
+ *    driver accepts it, while the Rx task reads it back and counts the bytes
+ *    received and the breaks in the sequence, for sbMEASURE_PERIOD.
+ *  - The loop count during the transfer, against the quiet count, gives the
+ *    share of the CPU the transfer took, and a line such as
+ *
+ *        SER ring baud=115200 actual=117647 bytes/s=11520 lost=0 cpu=9%
+ *
+ *    is written to the port, actual being the baud rate the driver could
+ *    set.  "ring" or "queue" says which buffers the driver
+ *    was built with (serUSE_RING_BUFFERS).
+ *
+ * The driver's counters (see vSerialPutStats()) follow on a second line when
+ * it is built with serUSE_STATS set to 1.
+ *
+ * With sbBLOCK_SIZE set above 0 the pattern is written with xSerialPutString()
+ * and read with usSerialRead() in blocks of that many bytes, rather than a
+ * character at a time, and " block=<size>" is added after the baud rate.
+ *
+ * At most baud rates the line is the limit, so the CPU share is the number to
+ * compare.  Above about 500000 baud the driver becomes the limit, and shows up
+ * as fewer bytes/s or lost bytes.  The loop task shares the CPU with any
+ * other idle priority task, so mainDEMO_INTEGER is best set to 0.  The serial
+ * port is opened here, so the com test tasks cannot run at the same time.
+ */
+
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "serialbench.h"
+
+/* Length of each phase. */
+#define sbCALIBRATE_PERIOD				( ( TickType_t ) 2000 / portTICK_PERIOD_MS )
+#define sbMEASURE_PERIOD				( ( TickType_t ) 5000 / portTICK_PERIOD_MS )
+
+/* The transfer has finished once nothing has been received for this long. */
+#define sbDRAIN_TIME					( ( TickType_t ) 20 / portTICK_PERIOD_MS )
+
+#define sbQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 64 )
+#define sbTX_BLOCK_TIME					( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define sbSTACK_SIZE					( configMINIMAL_STACK_SIZE + 32 )
+
+/* Bytes per xSerialPutString() and usSerialRead() call, or 0 to transfer a
+character at a time. */
+#ifndef sbBLOCK_SIZE
+	#define sbBLOCK_SIZE				0
+#endif
+
+#if( serUSE_RING_BUFFERS == 1 )
+	#define sbDRIVER_NAME				"SER ring baud="
+#else
+	#define sbDRIVER_NAME				"SER queue baud="
+#endif
+
+/*
+ * The tasks described at the top of the file.
+ */
+static portTASK_FUNCTION_PROTO( vSerialBenchRxTask, pvParameters );
+static portTASK_FUNCTION_PROTO( vSerialBenchTxTask, pvParameters );
+static portTASK_FUNCTION_PROTO( vSerialBenchLoopTask, pvParameters );
+
+/*
+ * Read and discard characters until none arrive for sbDRAIN_TIME.
+ */
+static void prvDrain( void );
+
+/*
+ * Write a string to the serial port.
+ */
+static void prvSendString( const char *pcString );
+
+/* Handle of the port under test. */
+static xComPortHandle xPort = NULL;
+static unsigned long ulBenchBaudRate = 0;
+
+/* Set by the Rx task while the Tx task should be sending. */
+static volatile BaseType_t xSending = pdFALSE;
+
+/* Incremented by the loop task. */
+static volatile uint32_t ulLoops = 0;
+
+#if( sbBLOCK_SIZE > 0 )
+	/* The blocks written and read by the Tx and Rx tasks. */
+	static signed char cTxBlock[ sbBLOCK_SIZE ];
+	static signed char cRxBlock[ sbBLOCK_SIZE ];
+#endif
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The TCBs and stacks of the three tasks. */
+	static StaticTask_t xRxTaskBuffer, xTxTaskBuffer, xLoopTaskBuffer;
+	static StackType_t xRxStack[ sbSTACK_SIZE ], xTxStack[ configMINIMAL_STACK_SIZE ], xLoopStack[ configMINIMAL_STACK_SIZE ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+void vStartSerialBenchTasks( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	ulBenchBaudRate = ulBaudRate;
+	xPort = xSerialPortInitMinimal( ulBaudRate, sbQUEUE_LENGTH );
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskCreateStatic( vSerialBenchRxTask, "SBRx", sbSTACK_SIZE, NULL, uxPriority, xRxStack, &xRxTaskBuffer );
+	xTaskCreateStatic( vSerialBenchTxTask, "SBTx", configMINIMAL_STACK_SIZE, NULL, uxPriority, xTxStack, &xTxTaskBuffer );
+	xTaskCreateStatic( vSerialBenchLoopTask, "SBLoop", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, xLoopStack, &xLoopTaskBuffer );
+#else
+	xTaskCreate( vSerialBenchRxTask, "SBRx", sbSTACK_SIZE, NULL, uxPriority, NULL );
+	xTaskCreate( vSerialBenchTxTask, "SBTx", configMINIMAL_STACK_SIZE, NULL, uxPriority, NULL );
+	xTaskCreate( vSerialBenchLoopTask, "SBLoop", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vSerialBenchRxTask, pvParameters )
+{
+uint32_t ulQuietLoops, ulBusyLoops, ulBytes, ulLost, ulPercent;
+TickType_t xStart;
+uint8_t ucExpected;
+SerialBaud_t xBaud;
+#if( sbBLOCK_SIZE > 0 )
+	unsigned short usReceived, usIndex;
+#else
+	signed char cChar;
+#endif
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		/* Nothing should be in flight while the quiet loop count is taken. */
+		prvDrain();
+		ulLoops = 0;
+		vTaskDelay( sbCALIBRATE_PERIOD );
+		ulQuietLoops = ulLoops;
+
+		ulBytes = 0;
+		ulLost = 0;
+		ucExpected = 0;
+		ulLoops = 0;
+		xStart = xTaskGetTickCount();
+		xSending = pdTRUE;
+
+		while( ( xTaskGetTickCount() - xStart ) < sbMEASURE_PERIOD )
+		{
+			#if( sbBLOCK_SIZE > 0 )
+			{
+				usReceived = usSerialRead( xPort, cRxBlock, sbBLOCK_SIZE, sbTX_BLOCK_TIME );
+
+				for( usIndex = 0; usIndex < usReceived; usIndex++ )
+				{
+					if( ( uint8_t ) cRxBlock[ usIndex ] != ucExpected )
+					{
+						ulLost += ( uint8_t ) ( ( uint8_t ) cRxBlock[ usIndex ] - ucExpected );
+					}
+
+					ucExpected = ( uint8_t ) cRxBlock[ usIndex ] + 1;
+				}
+
+				ulBytes += usReceived;
+			}
+			#else
+			{
+				if( xSerialGetChar( xPort, &cChar, sbTX_BLOCK_TIME ) != pdFALSE )
+				{
+					/* A byte that is not the next in the sequence means some
+					were lost. */
+					if( ( uint8_t ) cChar != ucExpected )
+					{
+						ulLost += ( uint8_t ) ( ( uint8_t ) cChar - ucExpected );
+					}
+
+					ucExpected = ( uint8_t ) cChar + 1;
+					ulBytes++;
+				}
+			}
+			#endif
+		}
+
+		xSending = pdFALSE;
+		ulBusyLoops = ulLoops;
+
+		/* The share of the CPU the loop task lost during the transfer. */
+		ulPercent = 0;
+		if( ulQuietLoops > 0 )
+		{
+			ulQuietLoops = ( ulQuietLoops / sbCALIBRATE_PERIOD ) * sbMEASURE_PERIOD;
+
+			if( ( ulBusyLoops < ulQuietLoops ) && ( ulQuietLoops >= 100UL ) )
+			{
+				ulPercent = 100UL - ( ulBusyLoops / ( ulQuietLoops / 100UL ) );
+			}
+		}
+
+		prvDrain();
+
+		prvSendString( sbDRIVER_NAME );
+		vSerialPutValue( xPort, "", ( uint32_t ) ulBenchBaudRate, sbTX_BLOCK_TIME );
+		vSerialGetBaud( xPort, &xBaud );
+		vSerialPutValue( xPort, " actual=", xBaud.ulBaud, sbTX_BLOCK_TIME );
+		#if( sbBLOCK_SIZE > 0 )
+		{
+			vSerialPutValue( xPort, " block=", ( uint32_t ) sbBLOCK_SIZE, sbTX_BLOCK_TIME );
+		}
+		#endif
+		vSerialPutValue( xPort, " bytes/s=", ( ulBytes * configTICK_RATE_HZ ) / sbMEASURE_PERIOD, sbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " lost=", ulLost, sbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " cpu=", ulPercent, sbTX_BLOCK_TIME );
+		prvSendString( "%\r\n" );
+
+		/* The driver's own view of the transfer, e.g. for overruns. */
+		#if( serUSE_STATS == 1 )
+		{
+			vSerialPutStats( xPort, xPort );
+			vSerialResetStats( xPort );
+		}
+		#endif
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vSerialBenchTxTask, pvParameters )
+{
+uint8_t ucNext = 0;
+#if( sbBLOCK_SIZE > 0 )
+	unsigned short usIndex;
+#endif
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		if( xSending != pdFALSE )
+		{
+			#if( sbBLOCK_SIZE > 0 )
+			{
+				for( usIndex = 0; usIndex < sbBLOCK_SIZE; usIndex++ )
+				{
+					cTxBlock[ usIndex ] = ( signed char ) ucNext;
+					ucNext++;
+				}
+
+				/* Waits until the whole block is in the driver, so the
+				sequence is not broken by a partial write. */
+				( void ) xSerialPutString( xPort, cTxBlock, sbBLOCK_SIZE, portMAX_DELAY );
+			}
+			#else
+			{
+				if( xSerialPutChar( xPort, ( signed char ) ucNext, sbTX_BLOCK_TIME ) != pdFALSE )
+				{
+					ucNext++;
+				}
+			}
+			#endif
+		}
+		else
+		{
+			/* Each transfer starts the sequence again. */
+			ucNext = 0;
+			vTaskDelay( 1 );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vSerialBenchLoopTask, pvParameters )
+{
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		ulLoops++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvDrain( void )
+{
+signed char cChar;
+
+	while( xSerialGetChar( xPort, &cChar, sbDRAIN_TIME ) != pdFALSE )
+	{
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), sbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
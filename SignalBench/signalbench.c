@@ -0,0 +1,359 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Compares the cost of waking a task through a queue, a binary semaphore
+ * 	and a direct to task notification
+ *
+ */
+
+/*
+ * Two tasks take turns.  The waiting task, one priority above the signalling
+ * task, blocks on each of the three mechanisms in turn, sgSAMPLES times each:
+ *
+ *  - a queue of one uint8_t item, as used by the Blinky tasks in main.c,
+ *  - a binary semaphore,
+ *  - its own task notification, given with xTaskNotifyGive() and taken with
+ *    ulTaskNotifyTake().
+ *
+ * The signalling task goes through the same sequence.  Straight after each
+ * tick it reads timer 3, which counts at the CPU clock, and signals.  The
+ * waiting task reads timer 3 again as soon as its wait returns, so the
+ * difference is the whole path from the call that signals, through the
+ * context switch, to the return of the call that waited.  After each
+ * mechanism a line such as
+ *
+ *     SIG queue n=256 min=590 avg=596 max=1021 ram=43
+ *
+ * is written to the serial port, min, avg and max being in CPU cycles and ram
+ * the bytes of heap the object took when it was created.  A notification
+ * takes no heap, as the value and state it uses are part of every task's TCB
+ * whether they are used or not (configUSE_TASK_NOTIFICATIONS).  The tasks'
+ * own stacks and TCBs are not counted.
+ *
+ * Other tasks at the priority of the waiting task or above show up in max.
+ * The serial port is opened here, so the com test tasks cannot run at the
+ * same time.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "signalbench.h"
+
+/* The RAM each object takes is measured from the heap, so nothing is built
+without one. */
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+
+/* Signals measured for each line of output. */
+#define sgSAMPLES						( ( uint16_t ) 256 )
+
+/* Time between rounds of the three mechanisms. */
+#define sgPERIOD						( ( TickType_t ) 5000 / portTICK_PERIOD_MS )
+
+/* Timer 3 in normal mode, clocked with no prescaler. */
+#define sgTIMER3_NORMAL_TCCR3A			( ( uint8_t ) 0b00000000 )
+#define sgTIMER3_NO_PRESCALE_TCCR3B		( ( uint8_t ) 0b00000001 )
+
+/* The mechanisms, in the order they are measured. */
+#define sgQUEUE							( 0 )
+#define sgSEMAPHORE						( 1 )
+#define sgNOTIFY						( 2 )
+#define sgNUM_MECHANISMS				( 3 )
+
+/* The value sent through the queue. */
+#define sgQUEUE_VALUE					( ( uint8_t ) 100 )
+
+/* Serial output. */
+#define sgQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 48 )
+#define sgTX_BLOCK_TIME					( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define sgSTACK_SIZE					( configMINIMAL_STACK_SIZE + 32 )
+
+/* The results for one mechanism. */
+typedef struct SIGNAL_RESULT
+{
+	uint16_t usMin;
+	uint16_t usMax;
+	uint32_t ulTotal;
+	size_t xHeapBytes;
+} SignalResult_t;
+
+/*
+ * The tasks described at the top of the file.
+ */
+static portTASK_FUNCTION_PROTO( vSignalBenchSignalTask, pvParameters );
+static portTASK_FUNCTION_PROTO( vSignalBenchWaitTask, pvParameters );
+
+/*
+ * Signal, or wait on, the given mechanism.  prvWait() returns pdFALSE if the
+ * wait timed out.
+ */
+static void prvSignal( UBaseType_t uxMechanism );
+static BaseType_t prvWait( UBaseType_t uxMechanism );
+
+/*
+ * Write a string to the serial port.
+ */
+static void prvSendString( const char *pcString );
+
+/* Handle of the port the results are written to. */
+static xComPortHandle xPort = NULL;
+
+/* The objects being compared, and the task that is notified. */
+static QueueHandle_t xQueue = NULL;
+static SemaphoreHandle_t xSemaphore = NULL;
+static TaskHandle_t xWaitTask = NULL;
+
+/* Timer 3 just before the latest signal. */
+static volatile uint16_t usSignalTime = 0;
+
+static SignalResult_t xResults[ sgNUM_MECHANISMS ];
+
+static const char * const pcNames[ sgNUM_MECHANISMS ] = { "SIG queue n=", "SIG semaphore n=", "SIG notify n=" };
+
+/*-----------------------------------------------------------*/
+
+void vStartSignalBenchTasks( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+size_t xFreeHeap;
+
+	xPort = xSerialPortInitMinimal( ulBaudRate, sgQUEUE_LENGTH );
+
+	xFreeHeap = xPortGetFreeHeapSize();
+	xQueue = xQueueCreate( 1, sizeof( uint8_t ) );
+	xResults[ sgQUEUE ].xHeapBytes = xFreeHeap - xPortGetFreeHeapSize();
+
+	xFreeHeap = xPortGetFreeHeapSize();
+	xSemaphore = xSemaphoreCreateBinary();
+	xResults[ sgSEMAPHORE ].xHeapBytes = xFreeHeap - xPortGetFreeHeapSize();
+
+	xResults[ sgNOTIFY ].xHeapBytes = 0;
+
+	configASSERT( xQueue );
+	configASSERT( xSemaphore );
+
+	TCCR3A = sgTIMER3_NORMAL_TCCR3A;
+	TCCR3B = sgTIMER3_NO_PRESCALE_TCCR3B;
+
+	xTaskCreate( vSignalBenchWaitTask, "SGWait", configMINIMAL_STACK_SIZE, NULL, uxPriority + 1, &xWaitTask );
+	xTaskCreate( vSignalBenchSignalTask, "SGSig", sgSTACK_SIZE, NULL, uxPriority, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vSignalBenchSignalTask, pvParameters )
+{
+UBaseType_t uxMechanism;
+uint16_t usSample;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		for( uxMechanism = 0; uxMechanism < sgNUM_MECHANISMS; uxMechanism++ )
+		{
+			for( usSample = 0; usSample < sgSAMPLES; usSample++ )
+			{
+				/* Start straight after a tick so the tick interrupt does not
+				land in the sample.  The waiting task has the higher priority
+				so is already blocked again. */
+				vTaskDelay( 1 );
+
+				usSignalTime = TCNT3;
+				prvSignal( uxMechanism );
+			}
+
+			vSerialPutValue( xPort, pcNames[ uxMechanism ], sgSAMPLES, sgTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " min=", xResults[ uxMechanism ].usMin, sgTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " avg=", xResults[ uxMechanism ].ulTotal / sgSAMPLES, sgTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " max=", xResults[ uxMechanism ].usMax, sgTX_BLOCK_TIME );
+			vSerialPutValue( xPort, " ram=", ( uint32_t ) xResults[ uxMechanism ].xHeapBytes, sgTX_BLOCK_TIME );
+			prvSendString( "\r\n" );
+
+			/* Let the line go before the next mechanism is measured, so the
+			serial interrupts stay out of the samples. */
+			vTaskDelay( sgTX_BLOCK_TIME );
+		}
+
+		vTaskDelay( sgPERIOD );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vSignalBenchWaitTask, pvParameters )
+{
+UBaseType_t uxMechanism;
+uint16_t usSample, usCycles;
+SignalResult_t *pxResult;
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		for( uxMechanism = 0; uxMechanism < sgNUM_MECHANISMS; uxMechanism++ )
+		{
+			pxResult = &( xResults[ uxMechanism ] );
+			pxResult->usMin = 0xffff;
+			pxResult->usMax = 0;
+			pxResult->ulTotal = 0;
+
+			for( usSample = 0; usSample < sgSAMPLES; usSample++ )
+			{
+				while( prvWait( uxMechanism ) == pdFALSE )
+				{
+					/* Without INCLUDE_vTaskSuspend portMAX_DELAY is not
+					forever, so just wait again. */
+				}
+
+				usCycles = TCNT3 - usSignalTime;
+				pxResult->ulTotal += usCycles;
+
+				if( usCycles < pxResult->usMin )
+				{
+					pxResult->usMin = usCycles;
+				}
+
+				if( usCycles > pxResult->usMax )
+				{
+					pxResult->usMax = usCycles;
+				}
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSignal( UBaseType_t uxMechanism )
+{
+const uint8_t ucValue = sgQUEUE_VALUE;
+
+	switch( uxMechanism )
+	{
+		case sgQUEUE:
+			( void ) xQueueSend( xQueue, &ucValue, 0 );
+			break;
+
+		case sgSEMAPHORE:
+			( void ) xSemaphoreGive( xSemaphore );
+			break;
+
+		default:
+			( void ) xTaskNotifyGive( xWaitTask );
+			break;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWait( UBaseType_t uxMechanism )
+{
+uint8_t ucValue;
+BaseType_t xReturn;
+
+	switch( uxMechanism )
+	{
+		case sgQUEUE:
+			xReturn = xQueueReceive( xQueue, &ucValue, portMAX_DELAY );
+			break;
+
+		case sgSEMAPHORE:
+			xReturn = xSemaphoreTake( xSemaphore, portMAX_DELAY );
+			break;
+
+		default:
+			xReturn = ( ulTaskNotifyTake( pdTRUE, portMAX_DELAY ) != 0 ) ? pdTRUE : pdFALSE;
+			break;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), sgTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
@@ -0,0 +1,267 @@
+/*
+    FreeRTOS V9.0.0 - Copyright (C) 2016 Real Time Engineers Ltd.
+    All rights reserved
+
+    VISIT http://www.FreeRTOS.org TO ENSURE YOU ARE USING THE LATEST VERSION.
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation >>>> AND MODIFIED BY <<<< the FreeRTOS exception.
+
+    ***************************************************************************
+    >>!   NOTE: The modification to the GPL is included to allow you to     !<<
+    >>!   distribute a combined work that includes FreeRTOS without being   !<<
+    >>!   obliged to provide the source code for proprietary components     !<<
+    >>!   outside of the FreeRTOS kernel.                                   !<<
+    ***************************************************************************
+
+    FreeRTOS is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+    FOR A PARTICULAR PURPOSE.  Full license text is available on the following
+    link: http://www.freertos.org/a00114.html
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS provides completely free yet professionally developed,    *
+     *    robust, strictly quality controlled, supported, and cross          *
+     *    platform software that is more than just the market leader, it     *
+     *    is the industry's de facto standard.                               *
+     *                                                                       *
+     *    Help yourself get started quickly while simultaneously helping     *
+     *    to support the FreeRTOS project by purchasing a FreeRTOS           *
+     *    tutorial book, reference manual, or both:                          *
+     *    http://www.FreeRTOS.org/Documentation                              *
+     *                                                                       *
+    ***************************************************************************
+
+    http://www.FreeRTOS.org/FAQHelp.html - Having a problem?  Start by reading
+    the FAQ page "My application does not run, what could be wrong?".  Have you
+    defined configASSERT()?
+
+    http://www.FreeRTOS.org/support - In return for receiving this top quality
+    embedded software for free we request you assist our global community by
+    participating in the support forum.
+
+    http://www.FreeRTOS.org/training - Investing in training allows your team to
+    be as productive as possible as early as possible.  Now you can receive
+    FreeRTOS training directly from Richard Barry, CEO of Real Time Engineers
+    Ltd, and the world's leading authority on the world's leading RTOS.
+
+    http://www.FreeRTOS.org/plus - A selection of FreeRTOS ecosystem products,
+    including FreeRTOS+Trace - an indispensable productivity tool, a DOS
+    compatible FAT file system, and our tiny thread aware UDP/IP stack.
+
+    http://www.FreeRTOS.org/labs - Where new FreeRTOS products go to incubate.
+    Come and try FreeRTOS+TCP, our new open source TCP/IP stack for FreeRTOS.
+
+    http://www.OpenRTOS.com - Real Time Engineers ltd. license FreeRTOS to High
+    Integrity Systems ltd. to sell under the OpenRTOS brand.  Low cost OpenRTOS
+    licenses offer ticketed support, indemnification and commercial middleware.
+
+    http://www.SafeRTOS.com - High Integrity Systems also provide a safety
+    engineered and independently SIL3 certified version for use in safety and
+    mission critical applications that require provable dependability.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: WinAVR
+ * Burner: AVR Dude (STK500v2)
+ * IDE: Eclipse Mars.2
+ *
+ * Description:
+ * 	Measures the CPU cycles taken from a task by each tick interrupt, to
+ * 	compare the full and the fast tick ISRs of the port (portUSE_FAST_TICK_ISR)
+ *
+ */
+
+/*
+ * A single task spins reading timer 3, which counts at the CPU clock, and looks
+ * for gaps between consecutive reads.  A gap in which the tick count changed
+ * is the time the tick interrupt took away from the task - the interrupt
+ * response, the handler and the reti.  The cost of one loop iteration,
+ * measured with interrupts disabled, is taken off each sample.
+ *
+ * After tbSAMPLES ticks a line such as
+ *
+ *     TICK fast n=256 min=95 avg=101 max=412
+ *
+ * is written to the serial port, and the task sleeps for tbPERIOD before
+ * measuring again.  "fast" or "full" says which tick ISR the port was built
+ * with.  The task should be the only one at its priority or above so that
+ * min and avg are the cost of a tick that does not switch context.  Ticks that
+ * do switch show up in max.
+ *
+ * The serial port is opened here, so the com test tasks cannot run at the
+ * same time.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo file headers. */
+#include "serial.h"
+#include "tickbench.h"
+
+/* Ticks measured for each line of output. */
+#define tbSAMPLES						( ( uint16_t ) 256 )
+
+/* Time between measurements. */
+#define tbPERIOD						( ( TickType_t ) 10000 / portTICK_PERIOD_MS )
+
+/* Loop iterations used to find the cost of one iteration, and the margin
+above that cost that is taken to mean an interrupt was serviced. */
+#define tbCALIBRATION_LOOPS				( 16 )
+#define tbLOOP_MARGIN					( ( uint16_t ) 8 )
+
+/* Timer 3 in normal mode, clocked with no prescaler. */
+#define tbTIMER3_NORMAL_TCCR3A			( ( uint8_t ) 0b00000000 )
+#define tbTIMER3_NO_PRESCALE_TCCR3B		( ( uint8_t ) 0b00000001 )
+
+/* Serial output. */
+#define tbQUEUE_LENGTH					( ( unsigned portBASE_TYPE ) 48 )
+#define tbTX_BLOCK_TIME					( ( TickType_t ) 10 / portTICK_PERIOD_MS )
+#define tbSTACK_SIZE					( configMINIMAL_STACK_SIZE + 32 )
+
+#if portUSE_FAST_TICK_ISR == 1
+	#define tbISR_NAME					"TICK fast n="
+#else
+	#define tbISR_NAME					"TICK full n="
+#endif
+
+/*
+ * The task that does the measuring.
+ */
+static portTASK_FUNCTION_PROTO( vTickBenchTask, pvParameters );
+
+/*
+ * Write a string to the serial port.
+ */
+static void prvSendString( const char *pcString );
+
+/* Handle of the port the results are written to. */
+static xComPortHandle xPort = NULL;
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The task's TCB and stack. */
+	static StaticTask_t xTickBenchTaskBuffer;
+	static StackType_t xTickBenchStack[ tbSTACK_SIZE ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+void vStartTickBenchTask( UBaseType_t uxPriority, unsigned long ulBaudRate )
+{
+	xPort = xSerialPortInitMinimal( ulBaudRate, tbQUEUE_LENGTH );
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTaskCreateStatic( vTickBenchTask, "TBench", tbSTACK_SIZE, NULL, uxPriority, xTickBenchStack, &xTickBenchTaskBuffer );
+#else
+	xTaskCreate( vTickBenchTask, "TBench", tbSTACK_SIZE, NULL, uxPriority, NULL );
+#endif
+}
+/*-----------------------------------------------------------*/
+
+static portTASK_FUNCTION( vTickBenchTask, pvParameters )
+{
+uint16_t usPrevious, usNow, usGap, usLoopCycles, usMin, usMax, usSamples;
+uint32_t ulTotal;
+TickType_t xLastTick, xTick;
+UBaseType_t uxLoop;
+
+	( void ) pvParameters;
+
+	TCCR3A = tbTIMER3_NORMAL_TCCR3A;
+	TCCR3B = tbTIMER3_NO_PRESCALE_TCCR3B;
+
+	/* Find the cost of one loop iteration when nothing can interrupt it. */
+	usLoopCycles = 0;
+	portENTER_CRITICAL();
+	{
+		usPrevious = TCNT3;
+		for( uxLoop = 0; uxLoop < tbCALIBRATION_LOOPS; uxLoop++ )
+		{
+			usNow = TCNT3;
+			usGap = usNow - usPrevious;
+			usPrevious = usNow;
+
+			if( usGap > usLoopCycles )
+			{
+				usLoopCycles = usGap;
+			}
+		}
+	}
+	portEXIT_CRITICAL();
+
+	for( ;; )
+	{
+		usMin = 0xffff;
+		usMax = 0;
+		ulTotal = 0;
+		usSamples = 0;
+
+		xLastTick = xTaskGetTickCount();
+		usPrevious = TCNT3;
+
+		while( usSamples < tbSAMPLES )
+		{
+			usNow = TCNT3;
+			usGap = usNow - usPrevious;
+			usPrevious = usNow;
+
+			if( usGap > ( uint16_t ) ( usLoopCycles + tbLOOP_MARGIN ) )
+			{
+				/* Something interrupted the loop.  Only a gap across which
+				the tick count moved on by one is a tick sample - any other
+				interrupt is ignored. */
+				xTick = xTaskGetTickCount();
+				if( ( TickType_t ) ( xTick - xLastTick ) == ( TickType_t ) 1 )
+				{
+					usGap -= usLoopCycles;
+					ulTotal += usGap;
+					usSamples++;
+
+					if( usGap < usMin )
+					{
+						usMin = usGap;
+					}
+
+					if( usGap > usMax )
+					{
+						usMax = usGap;
+					}
+				}
+				xLastTick = xTick;
+
+				/* Don't count the time taken to read the tick count. */
+				usPrevious = TCNT3;
+			}
+		}
+
+		vSerialPutValue( xPort, tbISR_NAME, usSamples, tbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " min=", usMin, tbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " avg=", ulTotal / usSamples, tbTX_BLOCK_TIME );
+		vSerialPutValue( xPort, " max=", usMax, tbTX_BLOCK_TIME );
+		prvSendString( "\r\n" );
+
+		vTaskDelay( tbPERIOD );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendString( const char *pcString )
+{
+	( void ) xSerialPutString( xPort, ( const signed char * ) pcString, ( unsigned short ) strlen( pcString ), tbTX_BLOCK_TIME );
+}
+/*-----------------------------------------------------------*/
+
@@ -0,0 +1,570 @@
+/*
+ * Demo AVR323 project
+ *
+ * ArduinoMEGA with FreeRTOS 9.0.0
+ *
+ * Compiler: g++ (host)
+ *
+ * Description:
+ * 	Converts the stream written by KernelTrace/ktrace.c into Chrome trace
+ * 	event JSON, which can be opened in chrome://tracing or ui.perfetto.dev.
+ *
+ * 	g++ -std=c++11 -O2 -o ktrace2json Tools/ktrace2json/ktrace2json.cpp
+ * 	ktrace2json [-u us_per_count] trace.bin [trace.json]
+ *
+ * 	Each task gets a track showing when it ran and, between runs, why it was
+ * 	not running: blocked on a queue, delayed, or preempted while ready.
+ * 	Queue operations are marked on the track of the task that made them, and
+ * 	those made from interrupts on the ISR track.  A summary of the longest
+ * 	run and the longest wait while ready for each task is written to stderr.
+ *
+ * 	A ktrSTART record marks a reset of the target, and starts a new process
+ * 	in the output so every run is shown separately.
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Must match KernelTrace/ktrace.h. */
+namespace ktr
+{
+	const std::size_t RECORD_SIZE = 4;
+	const int VERSION = 1;
+
+	enum Type
+	{
+		START = 0x00,
+		TIME_HIGH = 0x01,
+		LOST = 0x02,
+		TASK_CREATE = 0x03,
+		TASK_NAME = 0x04,
+		TASK_SWITCHED_IN = 0x05,
+		TASK_DELAY = 0x06,
+		TASK_DELAY_UNTIL = 0x07,
+		TICK = 0x08,
+		QUEUE_CREATE = 0x10,
+		MUTEX_CREATE = 0x11,
+		QUEUE_SEND = 0x12,
+		QUEUE_SEND_FAILED = 0x13,
+		QUEUE_RECEIVE = 0x14,
+		QUEUE_RECEIVE_FAILED = 0x15,
+		QUEUE_PEEK = 0x16,
+		BLOCKING_ON_QUEUE_SEND = 0x17,
+		BLOCKING_ON_QUEUE_RECEIVE = 0x18,
+		QUEUE_SEND_FROM_ISR = 0x19,
+		QUEUE_SEND_FROM_ISR_FAILED = 0x1a,
+		QUEUE_RECEIVE_FROM_ISR = 0x1b,
+		QUEUE_RECEIVE_FROM_ISR_FAILED = 0x1c
+	};
+}
+
+namespace
+{
+
+/* The track used for interrupts.  Tasks use their task number. */
+const int ISR_TRACK = 0;
+
+struct TaskState
+{
+	std::string name;
+	std::string pendingName;	/* Being received in ktrTASK_NAME records. */
+	bool nameComplete = false;
+
+	/* Why the task is not running, set when it blocks or is switched out. */
+	std::string waitReason;
+	uint64_t waitStart = 0;
+	bool waiting = false;
+
+	/* Summary. */
+	uint64_t runs = 0;
+	uint64_t runTime = 0;
+	uint64_t longestRun = 0;
+	uint64_t longestRunAt = 0;
+	uint64_t longestReady = 0;
+	uint64_t longestReadyAt = 0;
+};
+
+class Decoder
+{
+public:
+	Decoder( double usPerCount, std::ostream &out ) : usPerCount( usPerCount ), out( out ) {}
+
+	void decode( const std::vector< uint8_t > &data );
+	void finish();
+
+private:
+	void startSession();
+	void endSession();
+	void record( uint8_t type, uint8_t argument, uint16_t value );
+	void switchTo( int task );
+	void instant( int track, const std::string &name, const char *scope = "t" );
+	void slice( int track, const std::string &name, uint64_t start, uint64_t end, const char *category );
+	void event( const std::string &body );
+	std::string taskName( int task );
+	std::string queueName( int queue );
+	std::string timestamp( uint64_t counts ) const;
+	static std::string quote( const std::string &text );
+
+	double usPerCount;
+	std::ostream &out;
+	bool firstEvent = true;
+
+	/* Per session state. */
+	int session = 0;
+	uint64_t epoch = 0;			/* Added to the 32 bit counter after it wraps. */
+	uint32_t timeHigh = 0;
+	uint64_t now = 0;
+	uint64_t backwardSteps = 0;
+	int running = -1;
+	uint64_t runStart = 0;
+	std::map< int, TaskState > tasks;
+	std::map< int, bool > mutexes;
+	uint64_t lostRecords = 0;
+	uint64_t skippedBytes = 0;
+};
+
+void Decoder::decode( const std::vector< uint8_t > &data )
+{
+	std::size_t offset = 0;
+
+	while( offset + ktr::RECORD_SIZE <= data.size() )
+	{
+		const uint8_t type = data[ offset ];
+		const uint8_t argument = data[ offset + 1 ];
+		const uint16_t value = static_cast< uint16_t >( data[ offset + 2 ] | ( data[ offset + 3 ] << 8 ) );
+		const bool isStart = ( type == ktr::START ) && ( value == ( 'K' | ( 'T' << 8 ) ) );
+
+		if( isStart )
+		{
+			if( argument != ktr::VERSION )
+			{
+				std::cerr << "ktrace2json: stream version " << static_cast< int >( argument ) << " is not supported\n";
+				std::exit( EXIT_FAILURE );
+			}
+
+			endSession();
+			startSession();
+			offset += ktr::RECORD_SIZE;
+		}
+		else if( session == 0 )
+		{
+			/* Nothing can be decoded before the first start record, which
+			also gives the record alignment. */
+			skippedBytes++;
+			offset++;
+		}
+		else
+		{
+			record( type, argument, value );
+			offset += ktr::RECORD_SIZE;
+		}
+	}
+}
+
+void Decoder::finish()
+{
+	endSession();
+
+	if( skippedBytes != 0 )
+	{
+		std::cerr << "ktrace2json: skipped " << skippedBytes << " bytes before the first start record\n";
+	}
+
+	if( session == 0 )
+	{
+		std::cerr << "ktrace2json: no start record found\n";
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void Decoder::startSession()
+{
+	session++;
+	epoch = 0;
+	timeHigh = 0;
+	now = 0;
+	backwardSteps = 0;
+	running = -1;
+	runStart = 0;
+	tasks.clear();
+	mutexes.clear();
+	lostRecords = 0;
+
+	std::ostringstream body;
+	body << "\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << session << ",\"args\":{\"name\":" << quote( "Run " + std::to_string( session ) ) << "}";
+	event( body.str() );
+
+	body.str( "" );
+	body << "\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << session << ",\"tid\":" << ISR_TRACK << ",\"args\":{\"name\":\"ISR\"}";
+	event( body.str() );
+}
+
+void Decoder::endSession()
+{
+	if( session == 0 )
+	{
+		return;
+	}
+
+	/* Close the open slices at the last time seen. */
+	if( running >= 0 )
+	{
+		slice( running, taskName( running ), runStart, now, "running" );
+	}
+
+	for( auto &entry : tasks )
+	{
+		TaskState &task = entry.second;
+
+		if( task.waiting )
+		{
+			slice( entry.first, task.waitReason, task.waitStart, now, "waiting" );
+		}
+
+		std::ostringstream body;
+		body << "\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << session << ",\"tid\":" << entry.first << ",\"args\":{\"name\":" << quote( taskName( entry.first ) ) << "}";
+		event( body.str() );
+	}
+
+	std::cerr << "Run " << session << ": " << timestamp( now ) << " us";
+	if( lostRecords != 0 )
+	{
+		std::cerr << ", " << lostRecords << " records lost";
+	}
+	if( backwardSteps != 0 )
+	{
+		std::cerr << ", " << backwardSteps << " timestamps out of order";
+	}
+	std::cerr << "\n";
+	std::fprintf( stderr, "  %-10s %8s %12s %12s %14s %12s %14s\n", "task", "runs", "run us", "longest us", "at us", "ready us", "at us" );
+
+	for( auto &entry : tasks )
+	{
+		const TaskState &task = entry.second;
+
+		std::fprintf( stderr, "  %-10s %8llu %12s %12s %14s %12s %14s\n",
+					  taskName( entry.first ).c_str(),
+					  static_cast< unsigned long long >( task.runs ),
+					  timestamp( task.runTime ).c_str(),
+					  timestamp( task.longestRun ).c_str(),
+					  timestamp( task.longestRunAt ).c_str(),
+					  timestamp( task.longestReady ).c_str(),
+					  timestamp( task.longestReadyAt ).c_str() );
+	}
+}
+
+void Decoder::record( uint8_t type, uint8_t argument, uint16_t value )
+{
+	if( type == ktr::TIME_HIGH )
+	{
+		timeHigh = value;
+		return;
+	}
+
+	if( type == ktr::TASK_NAME )
+	{
+		/* Carries characters rather than a time. */
+		TaskState &task = tasks[ argument ];
+		const char characters[ 2 ] = { static_cast< char >( value & 0xff ), static_cast< char >( value >> 8 ) };
+
+		for( char c : characters )
+		{
+			if( task.nameComplete )
+			{
+				break;
+			}
+			else if( c == '\0' )
+			{
+				task.name = task.pendingName;
+				task.nameComplete = true;
+			}
+			else
+			{
+				task.pendingName += c;
+			}
+		}
+		return;
+	}
+
+	/* The counter is read in tasks and interrupts, so may step back by a few
+	counts.  Keep the timeline monotonic, and allow for the 32 bit counter
+	wrapping. */
+	uint64_t time = epoch + ( ( static_cast< uint64_t >( timeHigh ) << 16 ) | value );
+
+	if( time < now )
+	{
+		if( ( now - time ) > 0x80000000ULL )
+		{
+			epoch += 0x100000000ULL;
+			time += 0x100000000ULL;
+		}
+		else
+		{
+			backwardSteps++;
+			time = now;
+		}
+	}
+	now = time;
+
+	switch( type )
+	{
+		case ktr::LOST:
+			lostRecords += argument;
+			instant( ISR_TRACK, std::to_string( argument ) + " records lost", "g" );
+			break;
+
+		case ktr::TASK_CREATE:
+			tasks[ argument ].nameComplete = false;
+			tasks[ argument ].pendingName.clear();
+			break;
+
+		case ktr::TASK_SWITCHED_IN:
+			switchTo( argument );
+			break;
+
+		case ktr::TASK_DELAY:
+		case ktr::TASK_DELAY_UNTIL:
+			tasks[ argument ].waitReason = ( type == ktr::TASK_DELAY ) ? "vTaskDelay" : "vTaskDelayUntil";
+			break;
+
+		case ktr::TICK:
+			instant( ISR_TRACK, "tick" );
+			break;
+
+		case ktr::QUEUE_CREATE:
+			mutexes[ argument ] = false;
+			break;
+
+		case ktr::MUTEX_CREATE:
+			mutexes[ argument ] = true;
+			break;
+
+		case ktr::BLOCKING_ON_QUEUE_SEND:
+		case ktr::BLOCKING_ON_QUEUE_RECEIVE:
+			if( running >= 0 )
+			{
+				tasks[ running ].waitReason = std::string( ( type == ktr::BLOCKING_ON_QUEUE_SEND ) ? "send to " : "receive from " ) + queueName( argument );
+				instant( running, "block " + tasks[ running ].waitReason );
+			}
+			break;
+
+		case ktr::QUEUE_SEND:
+		case ktr::QUEUE_SEND_FAILED:
+		case ktr::QUEUE_RECEIVE:
+		case ktr::QUEUE_RECEIVE_FAILED:
+		case ktr::QUEUE_PEEK:
+		{
+			static const char * const names[] = { "send", "send failed", "receive", "receive failed", "peek" };
+
+			instant( ( running >= 0 ) ? running : ISR_TRACK, std::string( names[ type - ktr::QUEUE_SEND ] ) + " " + queueName( argument ) );
+			break;
+		}
+
+		case ktr::QUEUE_SEND_FROM_ISR:
+		case ktr::QUEUE_SEND_FROM_ISR_FAILED:
+		case ktr::QUEUE_RECEIVE_FROM_ISR:
+		case ktr::QUEUE_RECEIVE_FROM_ISR_FAILED:
+		{
+			static const char * const names[] = { "send", "send failed", "receive", "receive failed" };
+
+			instant( ISR_TRACK, std::string( names[ type - ktr::QUEUE_SEND_FROM_ISR ] ) + " " + queueName( argument ) );
+			break;
+		}
+
+		default:
+			std::cerr << "ktrace2json: unknown record type " << static_cast< int >( type ) << " at " << timestamp( now ) << " us\n";
+			break;
+	}
+}
+
+void Decoder::switchTo( int task )
+{
+	if( running >= 0 )
+	{
+		TaskState &previous = tasks[ running ];
+		const uint64_t duration = now - runStart;
+
+		slice( running, taskName( running ), runStart, now, "running" );
+
+		previous.runTime += duration;
+		if( duration > previous.longestRun )
+		{
+			previous.longestRun = duration;
+			previous.longestRunAt = runStart;
+		}
+
+		/* A task switched out without blocking or delaying is still ready to
+		run. */
+		previous.waiting = true;
+		previous.waitStart = now;
+		if( previous.waitReason.empty() )
+		{
+			previous.waitReason = "ready";
+		}
+	}
+
+	TaskState &next = tasks[ task ];
+
+	if( next.waiting )
+	{
+		slice( task, next.waitReason, next.waitStart, now, "waiting" );
+
+		if( ( next.waitReason == "ready" ) && ( ( now - next.waitStart ) > next.longestReady ) )
+		{
+			next.longestReady = now - next.waitStart;
+			next.longestReadyAt = next.waitStart;
+		}
+	}
+
+	next.waiting = false;
+	next.waitReason.clear();
+	next.runs++;
+	running = task;
+	runStart = now;
+}
+
+void Decoder::instant( int track, const std::string &name, const char *scope )
+{
+	std::ostringstream body;
+
+	body << "\"ph\":\"i\",\"s\":\"" << scope << "\",\"name\":" << quote( name ) << ",\"ts\":" << timestamp( now ) << ",\"pid\":" << session << ",\"tid\":" << track;
+	event( body.str() );
+}
+
+void Decoder::slice( int track, const std::string &name, uint64_t start, uint64_t end, const char *category )
+{
+	std::ostringstream body;
+
+	body << "\"ph\":\"X\",\"cat\":\"" << category << "\",\"name\":" << quote( name ) << ",\"ts\":" << timestamp( start ) << ",\"dur\":" << timestamp( end - start ) << ",\"pid\":" << session << ",\"tid\":" << track;
+	event( body.str() );
+}
+
+void Decoder::event( const std::string &body )
+{
+	if( firstEvent )
+	{
+		out << "{\"traceEvents\":[\n";
+		firstEvent = false;
+	}
+	else
+	{
+		out << ",\n";
+	}
+
+	out << "{" << body << "}";
+}
+
+std::string Decoder::taskName( int task )
+{
+	const TaskState &state = tasks[ task ];
+	std::string name = state.nameComplete ? state.name : state.pendingName;
+
+	if( name.empty() )
+	{
+		name = "Task " + std::to_string( task );
+	}
+
+	return name;
+}
+
+std::string Decoder::queueName( int queue )
+{
+	return ( mutexes[ queue ] ? "Mutex " : "Queue " ) + std::to_string( queue );
+}
+
+std::string Decoder::timestamp( uint64_t counts ) const
+{
+	char buffer[ 32 ];
+
+	std::snprintf( buffer, sizeof( buffer ), "%.3f", static_cast< double >( counts ) * usPerCount );
+	return buffer;
+}
+
+std::string Decoder::quote( const std::string &text )
+{
+	std::string quoted = "\"";
+
+	for( char c : text )
+	{
+		if( ( c == '"' ) || ( c == '\\' ) )
+		{
+			quoted += '\\';
+			quoted += c;
+		}
+		else if( static_cast< unsigned char >( c ) < 0x20 )
+		{
+			char escape[ 8 ];
+			std::snprintf( escape, sizeof( escape ), "\\u%04x", static_cast< unsigned >( c ) );
+			quoted += escape;
+		}
+		else
+		{
+			quoted += c;
+		}
+	}
+
+	return quoted + "\"";
+}
+
+void usage()
+{
+	std::cerr << "usage: ktrace2json [-u us_per_count] trace.bin [trace.json]\n"
+				 "  -u  microseconds per run time counter count, 4 for the ATmega2560 at 16MHz\n";
+	std::exit( EXIT_FAILURE );
+}
+
+}
+
+int main( int argc, char *argv[] )
+{
+	double usPerCount = 4.0;
+	int argument = 1;
+
+	if( ( argc > 2 ) && ( std::strcmp( argv[ argument ], "-u" ) == 0 ) )
+	{
+		usPerCount = std::atof( argv[ argument + 1 ] );
+		argument += 2;
+	}
+
+	if( ( argc - argument < 1 ) || ( argc - argument > 2 ) || ( usPerCount <= 0.0 ) )
+	{
+		usage();
+	}
+
+	std::ifstream input( argv[ argument ], std::ios::binary );
+	if( !input )
+	{
+		std::cerr << "ktrace2json: cannot open " << argv[ argument ] << "\n";
+		return EXIT_FAILURE;
+	}
+
+	const std::vector< uint8_t > data( ( std::istreambuf_iterator< char >( input ) ), std::istreambuf_iterator< char >() );
+
+	std::ofstream file;
+	if( argc - argument == 2 )
+	{
+		file.open( argv[ argument + 1 ] );
+		if( !file )
+		{
+			std::cerr << "ktrace2json: cannot create " << argv[ argument + 1 ] << "\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	Decoder decoder( usPerCount, file.is_open() ? static_cast< std::ostream & >( file ) : std::cout );
+	decoder.decode( data );
+	decoder.finish();
+
+	return EXIT_SUCCESS;
+}
@@ -99,7 +99,15 @@
 #include "serial.h"
 #include "comtest.h"
 #include "PollQ.h"
+#include "kernbench.h"
 #include "RegTest/regtest.h"
+#include "TickBench/tickbench.h"
+#include "RunTimeStats/rtstats.h"
+#include "KernelTrace/ktrace.h"
+#include "SerialBench/serialbench.h"
+#include "SignalBench/signalbench.h"
+#include "HeapBench/heapbench.h"
+#include "HeapStats/heapstats.h"
 #include "crflash.h"
 #include "croutine.h"
 
@@ -110,6 +118,12 @@ tasks just use the idle priority. */
 #define mainCOM_TEST_PRIORITY				( tskIDLE_PRIORITY + 2 )
 #define mainQUEUE_POLL_PRIORITY				( tskIDLE_PRIORITY + 2 )
 #define mainCHECK_TASK_PRIORITY				( tskIDLE_PRIORITY + 3 )
+#define mainTICK_BENCH_PRIORITY				( tskIDLE_PRIORITY + 3 )
+#define mainRUN_TIME_STATS_PRIORITY			( tskIDLE_PRIORITY + 1 )
+#define mainSIGNAL_BENCH_PRIORITY			( tskIDLE_PRIORITY + 2 )
+#define mainKERNEL_BENCH_PRIORITY			( tskIDLE_PRIORITY + 2 )
+#define mainHEAP_BENCH_PRIORITY				( tskIDLE_PRIORITY + 2 )
+#define mainHEAP_STATS_PRIORITY				( tskIDLE_PRIORITY + 1 )
 
 /* Baud rate used by the serial port tasks. */
 #define mainCOM_TEST_BAUD_RATE				( ( uint32_t ) 115200 )
@@ -151,14 +165,110 @@ again. Digital Pin 12 */
 /* The number of coroutines to create. */
 #define mainNUM_FLASH_COROUTINES			( 3 )
 
-/* Flags to enable each functionality */
-#define mainDEMO_BLINKY						1
-#define mainDEMO_INTEGER					1
-#define mainDEMO_COMTEST					1
-#define mainDEMO_POLLEDQUEUE				1
-#define mainDEMO_REGTEST					1
-#define mainDEMO_ERRORCHECK					1
-#define mainDEMO_COROUTINE					1
+/* Flags to enable each functionality.  They can be overridden on the compiler
+command line, e.g. -DmainDEMO_INTEGER=0 to leave out the only task that never
+blocks when soak testing in the host simulation's virtual time. */
+#ifndef mainDEMO_BLINKY
+	#define mainDEMO_BLINKY			1
+#endif
+/* Set to 1 for the Blinky send task to wake the receive task with a direct to
+task notification rather than through a queue.  The notification needs no RAM
+beyond the receive task's TCB (see SignalBench/signalbench.c). */
+#ifndef mainDEMOBLINKY_USE_NOTIFY
+	#define mainDEMOBLINKY_USE_NOTIFY	0
+#endif
+
+#if( ( mainDEMOBLINKY_USE_NOTIFY == 1 ) && ( configUSE_TASK_NOTIFICATIONS != 1 ) )
+	#error mainDEMOBLINKY_USE_NOTIFY needs configUSE_TASK_NOTIFICATIONS set to 1.
+#endif
+
+#ifndef mainDEMO_INTEGER
+	#define mainDEMO_INTEGER			1
+#endif
+#ifndef mainDEMO_COMTEST
+	#define mainDEMO_COMTEST			1
+#endif
+#ifndef mainDEMO_POLLEDQUEUE
+	#define mainDEMO_POLLEDQUEUE		1
+#endif
+#ifndef mainDEMO_REGTEST
+	#ifdef __AVR__
+		/* The register test tasks are written in AVR assembler. */
+		#define mainDEMO_REGTEST			1
+	#else
+		#define mainDEMO_REGTEST			0
+	#endif
+#endif
+#ifndef mainDEMO_ERRORCHECK
+	#define mainDEMO_ERRORCHECK		1
+#endif
+#ifndef mainDEMO_COROUTINE
+	#define mainDEMO_COROUTINE		1
+#endif
+
+/* The tick ISR benchmark writes its results to the serial port, so is off by
+default and cannot run with the com test tasks.  It reads timer 3 so only runs
+on the AVR. */
+#ifndef mainDEMO_TICKBENCH
+	#define mainDEMO_TICKBENCH		0
+#endif
+
+/* The run time stats task writes a table of the time used by each task to the
+serial port every 5 seconds.  It needs configGENERATE_RUN_TIME_STATS. */
+#ifndef mainDEMO_RUNTIMESTATS
+	#define mainDEMO_RUNTIMESTATS	0
+#endif
+
+#if( ( mainDEMO_RUNTIMESTATS == 1 ) && ( configGENERATE_RUN_TIME_STATS != 1 ) )
+	#error mainDEMO_RUNTIMESTATS needs configGENERATE_RUN_TIME_STATS set to 1.
+#endif
+
+/* The serial benchmark needs the com test loopback connector, and is best run
+with mainDEMO_INTEGER set to 0. */
+#ifndef mainDEMO_SERIALBENCH
+	#define mainDEMO_SERIALBENCH	0
+#endif
+
+/* The signal benchmark compares the time taken to wake a task through a queue,
+a binary semaphore and a task notification, and writes it to the serial port.
+It reads timer 3 so cannot run with the tick ISR benchmark either. */
+#ifndef mainDEMO_SIGNALBENCH
+	#define mainDEMO_SIGNALBENCH	0
+#endif
+
+/* The kernel benchmark (Demo/Common/Minimal/kernbench.c) writes the cycles
+taken by the queue, yield, scheduler suspend and delay primitives to the
+serial port.  It runs at priorities 2 and 3, so is best run with
+mainDEMO_POLLEDQUEUE and mainDEMO_ERRORCHECK set to 0. */
+#ifndef mainDEMO_KERNELBENCH
+	#define mainDEMO_KERNELBENCH	0
+#endif
+
+/* The heap benchmark times pvPortMalloc() and vPortFree() and measures the
+fragmentation left by a mix of allocations, to compare the heap selected by
+configUSE_COALESCING_HEAP with the other.  It runs once. */
+#ifndef mainDEMO_HEAPBENCH
+	#define mainDEMO_HEAPBENCH		0
+#endif
+
+/* The heap stats task writes the heap usage, and the blocks held by each task,
+to the serial port every 5 seconds, and the malloc failed hook writes the task
+and size of any allocation that fails.  It needs configUSE_HEAP_STATS. */
+#ifndef mainDEMO_HEAPSTATS
+	#define mainDEMO_HEAPSTATS		0
+#endif
+
+#if( ( mainDEMO_HEAPSTATS == 1 ) && ( configUSE_HEAP_STATS != 1 ) )
+	#error mainDEMO_HEAPSTATS needs configUSE_HEAP_STATS set to 1.
+#endif
+
+#if( ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) && ( ( mainDEMO_SIGNALBENCH + mainDEMO_HEAPBENCH + mainDEMO_HEAPSTATS ) > 0 ) )
+	#error mainDEMO_SIGNALBENCH, mainDEMO_HEAPBENCH and mainDEMO_HEAPSTATS measure the heap, so need configSUPPORT_DYNAMIC_ALLOCATION set to 1.
+#endif
+
+#if( ( mainDEMO_COMTEST + mainDEMO_TICKBENCH + mainDEMO_RUNTIMESTATS + mainDEMO_SERIALBENCH + mainDEMO_SIGNALBENCH + mainDEMO_KERNELBENCH + mainDEMO_HEAPBENCH + mainDEMO_HEAPSTATS + configUSE_KERNEL_TRACE ) > 1 )
+	#error Only one of mainDEMO_COMTEST, mainDEMO_TICKBENCH, mainDEMO_RUNTIMESTATS, mainDEMO_SERIALBENCH, mainDEMO_SIGNALBENCH, mainDEMO_KERNELBENCH, mainDEMO_HEAPBENCH, mainDEMO_HEAPSTATS and configUSE_KERNEL_TRACE can use the serial port.
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -168,46 +278,116 @@ again. Digital Pin 12 */
 static void prvQueueReceiveTask( void *pvParameters );
 static void prvQueueSendTask( void *pvParameters );
 
-/*
- * The task function for the "Check" task.
- */
-static void vErrorChecks( void *pvParameters );
-
-/*
- * Checks the unique counts of other tasks to ensure they are still operational.
- * Flashes an LED if everything is okay.
- */
-static void prvCheckOtherTasksAreStillRunning( void );
+#if( mainDEMO_ERRORCHECK == 1 )
+	/*
+	 * The task function for the "Check" task.
+	 */
+	static void vErrorChecks( void *pvParameters );
+
+	/*
+	 * Checks the unique counts of other tasks to ensure they are still
+	 * operational.  Flashes an LED if everything is okay.
+	 */
+	static void prvCheckOtherTasksAreStillRunning( void );
+#endif
 
 /*-----------------------------------------------------------*/
 
-/* The queue used by both tasks. */
-static QueueHandle_t xQueue = NULL;
+#if( mainDEMOBLINKY_USE_NOTIFY == 1 )
+	/* The task notified by the send task. */
+	static TaskHandle_t xReceiveTask = NULL;
+#else
+	/* The queue used by both tasks. */
+	static QueueHandle_t xQueue = NULL;
+#endif
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* The queue, TCBs and stacks of the tasks defined in this file. */
+	#if( mainDEMO_BLINKY == 1 )
+		#if( mainDEMOBLINKY_USE_NOTIFY == 0 )
+			static StaticByteQueue_t xQueueBuffer;
+			static uint8_t ucQueueStorage[ mainDEMOBLINKY_QUEUE_LENGTH * sizeof( unsigned char ) ];
+		#endif
+		static StaticTask_t xReceiveTaskBuffer, xSendTaskBuffer;
+		static StackType_t xReceiveStack[ configMINIMAL_STACK_SIZE ], xSendStack[ configMINIMAL_STACK_SIZE ];
+	#endif
+	#if( mainDEMO_ERRORCHECK == 1 )
+		static StaticTask_t xCheckTaskBuffer;
+		static StackType_t xCheckStack[ configMINIMAL_STACK_SIZE ];
+	#endif
+
+	/* The idle task's TCB and stack, given to the kernel by
+	vApplicationGetIdleTaskMemory(). */
+	static StaticTask_t xIdleTaskBuffer;
+	static StackType_t xIdleStack[ configMINIMAL_STACK_SIZE ];
+#endif
 
 /*-----------------------------------------------------------*/
 
 int main( void )
 {
+#if( configUSE_KERNEL_TRACE == 1 )
+	/* Before anything is created, so every task and queue is in the trace. */
+	vKernelTraceStart( mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_HEAPSTATS == 1 )
+	/* First, so the port is open to report an allocation that fails while
+	the other tasks are created. */
+	vStartHeapStatsTask( mainHEAP_STATS_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+
 	/* Setup the LED's for output. */
 	vParTestInitialise();
 
 #if( mainDEMO_BLINKY == 1 )
-	/* Create the queue. */
-	xQueue = xQueueCreate( mainDEMOBLINKY_QUEUE_LENGTH, sizeof( unsigned char ) );
-
-	/* Demo Blinky tasks */
-	if( xQueue != NULL )
+	#if( mainDEMOBLINKY_USE_NOTIFY == 1 )
 	{
-		/* Start the two tasks as described in the comments at the top of this file. */
-		xTaskCreate( prvQueueReceiveTask,					/* The function that implements the task. */
-					"RX", 									/* The text name assigned to the task - for debug only as it is not used by the kernel. */
-					configMINIMAL_STACK_SIZE, 				/* The size of the stack to allocate to the task. */
-					( void * ) mainDEMOBLINKY_RECEIVE_PARAMETER, /* The parameter passed to the task - just to check the functionality. */
-					mainDEMOBLINKY_RECEIVE_PRIORITY, 		/* The priority assigned to the task. */
-					NULL );									/* The task handle is not required, so NULL is passed. */
-
-		xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_SEND_PARAMETER, mainDEMOBLINKY_SEND_PRIORITY, NULL );
+		/* The send task needs the handle of the receive task, so the receive
+		task is created first. */
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			xReceiveTask = xTaskCreateStatic( prvQueueReceiveTask, "RX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_RECEIVE_PARAMETER, mainDEMOBLINKY_RECEIVE_PRIORITY, xReceiveStack, &xReceiveTaskBuffer );
+		#else
+			xTaskCreate( prvQueueReceiveTask, "RX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_RECEIVE_PARAMETER, mainDEMOBLINKY_RECEIVE_PRIORITY, &xReceiveTask );
+		#endif
+
+		if( xReceiveTask != NULL )
+		{
+			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+				xTaskCreateStatic( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_SEND_PARAMETER, mainDEMOBLINKY_SEND_PRIORITY, xSendStack, &xSendTaskBuffer );
+			#else
+				xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_SEND_PARAMETER, mainDEMOBLINKY_SEND_PRIORITY, NULL );
+			#endif
+		}
+	}
+	#else
+	{
+		/* Create the queue. */
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			xQueue = xQueueCreateByteStatic( mainDEMOBLINKY_QUEUE_LENGTH, ucQueueStorage, &xQueueBuffer );
+		#else
+			xQueue = xQueueCreate( mainDEMOBLINKY_QUEUE_LENGTH, sizeof( unsigned char ) );
+		#endif
+
+		/* Demo Blinky tasks */
+		if( xQueue != NULL )
+		{
+			/* Start the two tasks as described in the comments at the top of this file. */
+			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			xTaskCreateStatic( prvQueueReceiveTask, "RX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_RECEIVE_PARAMETER, mainDEMOBLINKY_RECEIVE_PRIORITY, xReceiveStack, &xReceiveTaskBuffer );
+			xTaskCreateStatic( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_SEND_PARAMETER, mainDEMOBLINKY_SEND_PRIORITY, xSendStack, &xSendTaskBuffer );
+			#else
+			xTaskCreate( prvQueueReceiveTask,					/* The function that implements the task. */
+						"RX", 									/* The text name assigned to the task - for debug only as it is not used by the kernel. */
+						configMINIMAL_STACK_SIZE, 				/* The size of the stack to allocate to the task. */
+						( void * ) mainDEMOBLINKY_RECEIVE_PARAMETER, /* The parameter passed to the task - just to check the functionality. */
+						mainDEMOBLINKY_RECEIVE_PRIORITY, 		/* The priority assigned to the task. */
+						NULL );									/* The task handle is not required, so NULL is passed. */
+
+			xTaskCreate( prvQueueSendTask, "TX", configMINIMAL_STACK_SIZE, ( void * ) mainDEMOBLINKY_SEND_PARAMETER, mainDEMOBLINKY_SEND_PRIORITY, NULL );
+			#endif
+		}
 	}
+	#endif
 #endif
 
 	/* Demo AVR323 tasks */
@@ -223,10 +403,32 @@ int main( void )
 #if( mainDEMO_REGTEST == 1 )
 	vStartRegTestTasks();
 #endif
+#if( mainDEMO_TICKBENCH == 1 )
+	vStartTickBenchTask( mainTICK_BENCH_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_RUNTIMESTATS == 1 )
+	vStartRunTimeStatsTask( mainRUN_TIME_STATS_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_SERIALBENCH == 1 )
+	vStartSerialBenchTasks( mainCOM_TEST_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_SIGNALBENCH == 1 )
+	vStartSignalBenchTasks( mainSIGNAL_BENCH_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_KERNELBENCH == 1 )
+	vStartKernelBenchTasks( mainKERNEL_BENCH_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
+#if( mainDEMO_HEAPBENCH == 1 )
+	vStartHeapBenchTask( mainHEAP_BENCH_PRIORITY, mainCOM_TEST_BAUD_RATE );
+#endif
 
 #if( mainDEMO_ERRORCHECK == 1 )
 	/* Create the tasks defined within this file. */
-	xTaskCreate( vErrorChecks, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, NULL );
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		xTaskCreateStatic( vErrorChecks, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, xCheckStack, &xCheckTaskBuffer );
+	#else
+		xTaskCreate( vErrorChecks, "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, NULL );
+	#endif
 #endif
 
 #if( mainDEMO_COROUTINE == 1 )
@@ -254,7 +456,7 @@ const TickType_t xBlockTime = pdMS_TO_TICKS( mainDEMOBLINKY_FREQUENCY_MS );
 	( void ) pvParameters;
 
 	/* Check the task parameter is as expected. */
-	configASSERT( ( ( unsigned int ) pvParameters ) == mainDEMOBLINKY_SEND_PARAMETER );
+	configASSERT( ( ( unsigned int ) ( uintptr_t ) pvParameters ) == mainDEMOBLINKY_SEND_PARAMETER );
 
 	/* Initialize xNextWakeTime - this only needs to be done once. */
 	xNextWakeTime = xTaskGetTickCount();
@@ -267,47 +469,84 @@ const TickType_t xBlockTime = pdMS_TO_TICKS( mainDEMOBLINKY_FREQUENCY_MS );
 		time. */
 		vTaskDelayUntil( &xNextWakeTime, xBlockTime );
 
-		/* Send to the queue - causing the queue receive task to unblock and
-		toggle the LED.  0 is used as the block time so the sending operation
-		will not block - it shouldn't need to block as the queue should always
-		be empty at this point in the code. */
-		xQueueSend( xQueue, &ucValueToSend, 0U );
+		#if( mainDEMOBLINKY_USE_NOTIFY == 1 )
+		{
+			/* Send the value as the receive task's notification value - causing
+			it to unblock and toggle the LED.  The receive task should always
+			have taken the previous value, so the value is not overwritten if
+			it is still pending, as the send to the queue would fail. */
+			xTaskNotify( xReceiveTask, ( uint32_t ) ucValueToSend, eSetValueWithoutOverwrite );
+		}
+		#else
+		{
+			/* Send to the queue - causing the queue receive task to unblock and
+			toggle the LED.  0 is used as the block time so the sending operation
+			will not block - it shouldn't need to block as the queue should always
+			be empty at this point in the code. */
+			xQueueSend( xQueue, &ucValueToSend, 0U );
+		}
+		#endif
 	}
 }
 /*-----------------------------------------------------------*/
 
 static void prvQueueReceiveTask( void *pvParameters )
 {
-unsigned char ucReceivedValue;
+#if( mainDEMOBLINKY_USE_NOTIFY == 1 )
+	uint32_t ulReceivedValue;
+#else
+	unsigned char ucReceivedValue;
+#endif
 
 	/* Remove compiler warning in the case that configASSERT() is not
 	defined. */
 	( void ) pvParameters;
 
 	/* Check the task parameter is as expected. */
-	configASSERT( ( ( unsigned int ) pvParameters ) == mainDEMOBLINKY_RECEIVE_PARAMETER );
+	configASSERT( ( ( unsigned int ) ( uintptr_t ) pvParameters ) == mainDEMOBLINKY_RECEIVE_PARAMETER );
 
 	for( ;; )
 	{
-		/* Wait until something arrives in the queue - this task will block
-		indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
-		FreeRTOSConfig.h. */
-		xQueueReceive( xQueue, &ucReceivedValue, portMAX_DELAY );
-
-		/*  To get here something must have been received from the queue, but
-		is it the expected value?  If it is, toggle the LED. */
-		if( ucReceivedValue == 100UL )
+		#if( mainDEMOBLINKY_USE_NOTIFY == 1 )
 		{
-			/* The Windows Blinky Demo prints a message with printf().
-			 * In Arduino, we'll just blink a LED */
-			vParTestToggleLED(mainDEMOBLINKY_LED);
-
-			ucReceivedValue = 0U;
+			/* Wait until the send task notifies this task, clearing the value
+			on the way out - this task will block indefinitely provided
+			INCLUDE_vTaskSuspend is set to 1 in FreeRTOSConfig.h.  If the wait
+			times out the value is left at 0. */
+			ulReceivedValue = 0U;
+			xTaskNotifyWait( 0U, ( uint32_t ) 0xffffffffUL, &ulReceivedValue, portMAX_DELAY );
+
+			/* Is it the expected value?  If it is, toggle the LED. */
+			if( ulReceivedValue == 100UL )
+			{
+				vParTestToggleLED(mainDEMOBLINKY_LED);
+			}
+		}
+		#else
+		{
+			/* Wait until something arrives in the queue - this task will block
+			indefinitely provided INCLUDE_vTaskSuspend is set to 1 in
+			FreeRTOSConfig.h. */
+			xQueueReceive( xQueue, &ucReceivedValue, portMAX_DELAY );
+
+			/*  To get here something must have been received from the queue, but
+			is it the expected value?  If it is, toggle the LED. */
+			if( ucReceivedValue == 100UL )
+			{
+				/* The Windows Blinky Demo prints a message with printf().
+				 * In Arduino, we'll just blink a LED */
+				vParTestToggleLED(mainDEMOBLINKY_LED);
+
+				ucReceivedValue = 0U;
+			}
 		}
+		#endif
 	}
 }
 /*-----------------------------------------------------------*/
 
+#if( mainDEMO_ERRORCHECK == 1 )
+
 static void vErrorChecks( void *pvParameters )
 {
 static volatile uint32_t ulDummyVariable = 3UL;
@@ -371,6 +610,7 @@ static portBASE_TYPE xErrorHasOccurred = pdFALSE;
 		vParTestToggleLED( mainCHECK_TASK_LED );
 	}
 }
+#endif /* mainDEMO_ERRORCHECK */
 /*-----------------------------------------------------------*/
 
 void vAssertCalled( unsigned long ulLine, const char * const pcFileName )
@@ -383,9 +623,39 @@ void vAssertCalled( unsigned long ulLine, const char * const pcFileName )
 }
 /*-----------------------------------------------------------*/
 
+void vApplicationMallocFailedHook( void )
+{
+	/* pvPortMalloc() returned NULL, so a task or queue was not created.  With
+	the heap stats task the size, task and caller are written to the serial
+	port - configTOTAL_HEAP_SIZE is too small, or a pool too few blocks. */
+#if( mainDEMO_HEAPSTATS == 1 )
+	vHeapStatsNotifyFailure();
+#endif
+
+	vParTestToggleLED(mainASSERTCALLED_LED);
+}
+/*-----------------------------------------------------------*/
+
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+	{
+		/* Called by vTaskStartScheduler() to create the idle task in the
+		buffers above rather than on the heap. */
+		*ppxIdleTaskTCBBuffer = &xIdleTaskBuffer;
+		*ppxIdleTaskStackBuffer = xIdleStack;
+		*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 void vApplicationIdleHook( void )
 {
 #if( mainDEMO_COROUTINE == 1 )
 	vCoRoutineSchedule();
 #endif
+#if( configUSE_KERNEL_TRACE == 1 )
+	vKernelTraceDrain();
+#endif
 }
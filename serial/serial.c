@@ -78,7 +78,59 @@
  *
  * Description:
  * 	Based on the official Demo for AVR323 (WINAVR)
- * 	Implements only USART0
+ * 	Implements USART0 to USART3 (serCOM1 to serCOM4).  Each port has its own
+ * 	buffers and its handle points to them, so the API functions only follow
+ * 	the handle.  The ISRs of each USART are expanded from the same code with
+ * 	the register addresses of that USART, so they use direct accesses.  Set
+ * 	serNUM_PORTS lower to leave out the buffers and ISRs of USART3 downwards.
+ *
+ * 	xSerialPutString() copies as much of a buffer as fits into the Tx buffer
+ * 	before enabling the UDRE interrupt once, and usSerialRead() waits for the
+ * 	first character and then returns all that have arrived, up to a limit.
+ * 	vSerialPutValue() writes a name and a decimal value, for the tasks that
+ * 	report figures as "name=value" text.
+ *
+ * 	With serUSE_COBS_FRAMES set to 1, xSerialEnableFrames() makes the Rx ISR
+ * 	of a port decode COBS frames (each ended by a 0x00 byte) straight into
+ * 	two frame slots, instead of buffering single characters.  The task
+ * 	waiting in pucSerialGetFrame() is only notified when a whole frame is
+ * 	complete, and is given a pointer to it in the slot, which it hands back
+ * 	with vSerialReleaseFrame().  The ISR fills the other slot in the
+ * 	meantime.  A frame that arrives while both slots are held, is too long
+ * 	or has a line error is dropped.
+ *
+ * 	The baud rate is set with whichever of the normal and double speed modes,
+ * 	and of the two nearest UBRRn values for each, gets closest to the rate
+ * 	asked for.  vSerialGetBaud() gives the rate achieved and its error, and
+ * 	the serBAUD_...() macros of serial.h work the same out at compile time.
+ *
+ * 	With serUSE_FLOW_CONTROL set to 1, xSerialSetFlowControl() turns on RTS/CTS
+ * 	or XON/XOFF flow control for a port.  When the Rx buffer fills to its high
+ * 	watermark the Rx ISR raises RTS, or sends XOFF ahead of any queued
+ * 	characters, and the task that empties it to the low watermark lowers RTS
+ * 	or sends XON.  The UDRE ISR stops sending while CTS is high, or after an
+ * 	XOFF is received until an XON is.  XON and XOFF are taken out of the
+ * 	received characters, so XON/XOFF is only for text.  Flow control applies
+ * 	to the character buffers, not to COBS frames.
+ *
+ * 	With serUSE_STATS set to 1 (the default) each port counts its line errors,
+ * 	the characters it had no room for and the writes that found the Tx buffer
+ * 	full, and keeps the peak use of each buffer.  vSerialGetStats() reads the
+ * 	counters and vSerialPutStats() writes them to a port as one line.
+ *
+ * 	With serUSE_RING_BUFFERS set to 1 (the default) the characters are held in
+ * 	two byte rings rather than queues.  Each ring has one writer and one reader
+ * 	and 8 bit indices, so the ISRs only copy a byte and move an index, with no
+ * 	critical section or event list.  A task that has to wait records its
+ * 	handle in the ring and blocks on its task notification, and the ISR only
+ * 	notifies it once the number of characters (or free spaces) it is waiting
+ * 	for is reached.  The task notification of a task using the port is
+ * 	therefore not available for other uses.  Set serUSE_RING_BUFFERS to 0 for
+ * 	the original queue driver.
+ *
+ * 	With configSUPPORT_STATIC_ALLOCATION set to 1 the rings (or queues) and the
+ * 	frame slots of each port are arrays in its port structure rather than
+ * 	allocated from the heap, so are at a fixed address in the map file.
  *
  * Initial version (2016-08-11): Bruno Landau Albrecht (brunolalb@gmail.com)
  *
@@ -86,13 +138,30 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 #include <avr/interrupt.h>
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
 #include "serial.h"
 
-#define serBAUD_DIV_CONSTANT			( ( uint32_t ) 8 )
+/* The number of USARTs the driver supports, starting from USART0. */
+#ifndef serNUM_PORTS
+	#define serNUM_PORTS				4
+#endif
+
+#if( ( serNUM_PORTS < 1 ) || ( serNUM_PORTS > 4 ) )
+	#error serNUM_PORTS must be between 1 and 4.
+#endif
+
+/* With static allocation the Rx and Tx buffers of every port are arrays in the
+port structures, each of this many bytes, and longer queue lengths are cut to
+it.  Set serNUM_PORTS to the ports used to save the rest. */
+#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#ifndef serSTATIC_BUFFER_SIZE
+		#define serSTATIC_BUFFER_SIZE	128
+	#endif
+#endif
 
 /* Constants for writing to UCSRnA. */
 #define serDOUBLE_SPEED					( ( unsigned char ) 0b00000010 )
@@ -109,151 +178,1365 @@
 
 /* Constants for writing to UCSRnC. */
 #define serEIGHT_DATA_BITS				( ( unsigned char ) 0b00000110 )
+#define serEVEN_PARITY_BITS				( ( unsigned char ) 0b00100000 )
+#define serODD_PARITY_BITS				( ( unsigned char ) 0b00110000 )
+#define serTWO_STOP_BITS				( ( unsigned char ) 0b00001000 )
+#define serDATA_BITS_SHIFT				( 1 )
+
+/* UDRn is wider than 8 bits in the simulation. */
+typedef __typeof__( UDR0 ) SerialData_t;
+
+/*
+ * The registers of one USART.  The table of these is constant, so when an ISR
+ * is expanded for one USART the compiler replaces the pointers with the
+ * register addresses.
+ */
+typedef struct SERIAL_REGISTERS
+{
+	volatile uint8_t *pucUCSRA;
+	volatile uint8_t *pucUCSRB;
+	volatile uint8_t *pucUCSRC;
+	volatile uint16_t *pusUBRR;
+	SerialData_t *pxUDR;
+} SerialRegisters_t;
+
+#if( serUSE_RING_BUFFERS == 1 )
+
+	#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		#if( ( serSTATIC_BUFFER_SIZE < 2 ) || ( serSTATIC_BUFFER_SIZE > 256 ) || ( ( serSTATIC_BUFFER_SIZE & ( serSTATIC_BUFFER_SIZE - 1 ) ) != 0 ) )
+			#error serSTATIC_BUFFER_SIZE must be a power of 2 from 2 to 256 for the rings.
+		#endif
+
+		/* The ring is the array in the ring structure. */
+		#define serMAX_RING_SIZE		serSTATIC_BUFFER_SIZE
+	#else
+		/* The largest ring the 8 bit indices can address. */
+		#define serMAX_RING_SIZE		256U
+	#endif
+
+	/* The mask of the largest ring has to fit in ucMask.  The size is kept
+	out of UBaseType_t, which is 8 bits on the AVR. */
+	#if( ( serMAX_RING_SIZE - 1 ) > 0xff )
+		#error The ring mask does not fit in 8 bits.
+	#endif
+
+	/*
+	 * A single producer, single consumer byte ring.  The producer only writes
+	 * ucHead and the consumer only writes ucTail, and one byte is always left
+	 * empty, so neither needs a critical section to add or remove a byte.
+	 */
+	typedef struct SERIAL_RING
+	{
+		volatile uint8_t *pucBuffer;
+		uint8_t ucMask;							/* Ring size - 1. */
+		volatile uint8_t ucHead;				/* Next byte to write. */
+		volatile uint8_t ucTail;				/* Next byte to read. */
+		volatile TaskHandle_t xWaitingTask;		/* Task to notify, or NULL. */
+		volatile uint8_t ucWakeLevel;			/* Bytes (Rx) or spaces (Tx) to notify at. */
+
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			uint8_t ucStorage[ serSTATIC_BUFFER_SIZE ];	/* pucBuffer points here. */
+		#endif
+	} SerialRing_t;
+
+	#define serRING_USED( pxRing )		( ( uint8_t ) ( ( pxRing )->ucHead - ( pxRing )->ucTail ) & ( pxRing )->ucMask )
+	#define serRING_FREE( pxRing )		( ( uint8_t ) ( ( pxRing )->ucMask - serRING_USED( pxRing ) ) )
+
+#elif( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/* The longest queue the static storage takes.  A byte queue holds at most
+	255 items, so a 256 byte buffer (which would also be 0 as a UBaseType_t on
+	the AVR) gives 255. */
+	#if( serSTATIC_BUFFER_SIZE > 255 )
+		#define serSTATIC_QUEUE_LENGTH	255U
+	#else
+		#define serSTATIC_QUEUE_LENGTH	serSTATIC_BUFFER_SIZE
+	#endif
+
+#endif /* serUSE_RING_BUFFERS */
+
+#if( serUSE_COBS_FRAMES == 1 )
+
+	/* The code byte of a COBS block that is not followed by a zero. */
+	#define serCOBS_FULL_BLOCK			( ( uint8_t ) 0xff )
+
+	/*
+	 * The two frame slots of a port and the state of the decoder.  A slot
+	 * belongs to the ISR until ucReady is set, and to the task from then
+	 * until it is released.  The ISR fills the slots, and the task takes
+	 * them, in turn, so frames are received in order.
+	 */
+	typedef struct SERIAL_FRAMER
+	{
+		uint8_t *pucSlot[ 2 ];
+		unsigned short usLength[ 2 ];			/* Length of a complete frame. */
+		volatile uint8_t ucReady[ 2 ];			/* Set by the ISR when the slot holds a frame. */
+		uint8_t ucFilling;						/* Slot the ISR decodes into. */
+		uint8_t ucTaking;						/* Slot the task takes next. */
+		unsigned short usFill;					/* Bytes decoded into the slot so far. */
+		uint8_t ucRemaining;					/* Data bytes left in the block, 0 for a code byte next. */
+		uint8_t ucLastCode;						/* Code byte of the block before, 0 before the first. */
+		uint8_t ucDiscard;						/* Set to drop the rest of the frame. */
+		volatile TaskHandle_t xWaitingTask;		/* Task to notify, or NULL. */
+	} SerialFramer_t;
+
+#endif /* serUSE_COBS_FRAMES */
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	#define serXON						( ( uint8_t ) 0x11 )
+	#define serXOFF						( ( uint8_t ) 0x13 )
+
+	/*
+	 * The flow control settings and state of a port.  RTS and CTS are active
+	 * low.
+	 */
+	typedef struct SERIAL_FLOW
+	{
+		volatile uint8_t *pucRTSPort;			/* PORTx register RTS is on. */
+		uint8_t ucRTSMask;
+		volatile uint8_t *pucCTSPin;			/* PINx register CTS is on. */
+		uint8_t ucCTSMask;
+		volatile uint8_t ucMode;				/* An eFlowControl value. */
+		UBaseType_t uxLowWater;					/* Rx level to restart the remote at. */
+		UBaseType_t uxHighWater;				/* Rx level to stop the remote at. */
+		volatile uint8_t ucRxStopped;			/* The remote has been told to stop. */
+		volatile uint8_t ucTxStopped;			/* An XOFF has been received. */
+		volatile uint8_t ucSendControl;			/* XON or XOFF to send next, or 0. */
+	} SerialFlow_t;
+
+#endif /* serUSE_FLOW_CONTROL */
+
+/*
+ * The state of one port.  A handle returned by the init functions points to
+ * one of these.
+ */
+typedef struct SERIAL_PORT
+{
+	const SerialRegisters_t *pxRegisters;
+	SerialBaud_t xBaud;						/* The baud rate settings in use. */
+
+	#if( serUSE_RING_BUFFERS == 1 )
+		SerialRing_t xRxRing;
+		SerialRing_t xTxRing;
+	#else
+		QueueHandle_t xRxedChars;
+		QueueHandle_t xCharsForTx;
+
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			StaticByteQueue_t xRxQueueBuffer;
+			StaticByteQueue_t xTxQueueBuffer;
+			uint8_t ucRxStorage[ serSTATIC_BUFFER_SIZE ];
+			uint8_t ucTxStorage[ serSTATIC_BUFFER_SIZE ];
+		#endif
+	#endif
+
+	#if( serUSE_COBS_FRAMES == 1 )
+		SerialFramer_t * volatile pxFramer;		/* NULL unless frames are enabled. */
+
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			SerialFramer_t xFramerBuffer;		/* pxFramer points here once enabled. */
+			uint8_t ucFrameSlots[ 2 * serMAX_FRAME_LENGTH ];
+		#endif
+	#endif
+
+	#if( serUSE_FLOW_CONTROL == 1 )
+		SerialFlow_t xFlow;
+	#endif
+
+	#if( serUSE_STATS == 1 )
+		volatile SerialStats_t xStats;
+	#endif
+} SerialPort_t;
+
+#if( serUSE_STATS == 1 )
+
+	#define serSTATS_INCREMENT( pxPort, xCounter )			( ( pxPort )->xStats.xCounter++ )
+
+	#define serSTATS_PEAK( pxPort, xPeak, uxLevel )				\
+	{															\
+		UBaseType_t uxNow = ( uxLevel );						\
+																\
+		if( uxNow > ( pxPort )->xStats.xPeak )					\
+		{														\
+			( pxPort )->xStats.xPeak = uxNow;					\
+		}														\
+	}
+
+#else
+
+	#define serSTATS_INCREMENT( pxPort, xCounter )
+	#define serSTATS_PEAK( pxPort, xPeak, uxLevel )
+
+#endif /* serUSE_STATS */
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	/* Called after a task has taken characters from the Rx buffer. */
+	#define serFLOW_RX_TAKEN( pxPort )								\
+	{																\
+		if( ( pxPort )->xFlow.ucRxStopped != pdFALSE )				\
+		{															\
+			prvFlowRxTaken( pxPort );								\
+		}															\
+	}
+
+#else
+
+	#define serFLOW_RX_TAKEN( pxPort )
+
+#endif /* serUSE_FLOW_CONTROL */
+
+static const SerialRegisters_t xRegisters[ serNUM_PORTS ] =
+{
+	{ &UCSR0A, &UCSR0B, &UCSR0C, &UBRR0, &UDR0 },
+	#if( serNUM_PORTS > 1 )
+		{ &UCSR1A, &UCSR1B, &UCSR1C, &UBRR1, &UDR1 },
+	#endif
+	#if( serNUM_PORTS > 2 )
+		{ &UCSR2A, &UCSR2B, &UCSR2C, &UBRR2, &UDR2 },
+	#endif
+	#if( serNUM_PORTS > 3 )
+		{ &UCSR3A, &UCSR3B, &UCSR3C, &UBRR3, &UDR3 },
+	#endif
+};
 
-static QueueHandle_t xRxedChars; 
-static QueueHandle_t xCharsForTx; 
+static SerialPort_t xPorts[ serNUM_PORTS ];
 
-#define vInterrupt0On()										\
+/*
+ * Set up the buffers and registers of ePort.  ucFrame is the value for UCSRnC.
+ */
+static xComPortHandle prvPortInit( eCOMPort ePort, unsigned long ulWantedBaud, unsigned char ucFrame, unsigned portBASE_TYPE uxQueueLength );
+
+/*
+ * The body of the Rx and UDRE ISRs.  Expanded once for each USART.
+ */
+static inline void prvRxISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs ) __attribute__( ( always_inline ) );
+static inline void prvUdreISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs ) __attribute__( ( always_inline ) );
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	/*
+	 * Called by the UDRE ISR first.  Sends a pending XON or XOFF, or turns
+	 * the UDRE interrupt off while the remote holds the Tx, and returns
+	 * pdTRUE if it did either.
+	 */
+	static inline BaseType_t prvFlowTxFromISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs ) __attribute__( ( always_inline ) );
+
+#endif /* serUSE_FLOW_CONTROL */
+
+#if( serUSE_RING_BUFFERS == 1 )
+
+	/*
+	 * Allocate a ring that holds at least uxLength bytes (up to 255).
+	 */
+	static void prvInitialiseRing( SerialRing_t *pxRing, UBaseType_t uxLength );
+
+	/*
+	 * Wait until the ring holds at least uxWanted bytes (xForSpace is pdFALSE)
+	 * or has at least uxWanted free spaces (xForSpace is pdTRUE).  The task is
+	 * not notified until uxWakeLevel is reached, which can be higher than
+	 * uxWanted so a writer is not woken for every byte sent.  Returns pdFALSE
+	 * if xBlockTime expires first.
+	 */
+	static BaseType_t prvWaitForRing( SerialRing_t *pxRing, BaseType_t xForSpace, UBaseType_t uxWanted, UBaseType_t uxWakeLevel, TickType_t xBlockTime );
+
+	/*
+	 * Called by an ISR after changing the ring.  Notifies the waiting task if
+	 * uxLevel has reached its wake level.
+	 */
+	static void prvWakeFromISR( SerialRing_t *pxRing, uint8_t ucLevel, BaseType_t *pxHigherPriorityTaskWoken );
+
+#endif /* serUSE_RING_BUFFERS */
+
+#if( serUSE_COBS_FRAMES == 1 )
+
+	/*
+	 * Decode one received byte into the frame slots.  A zero byte ends the
+	 * frame, and the waiting task is notified if the frame is complete.
+	 */
+	static void prvFrameByteFromISR( SerialPort_t *pxPort, uint8_t ucByte, BaseType_t *pxHigherPriorityTaskWoken );
+
+#endif /* serUSE_COBS_FRAMES */
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	/*
+	 * The number of characters in the Rx buffer.
+	 */
+	static UBaseType_t prvRxLevel( SerialPort_t *pxPort );
+
+	/*
+	 * Tell the remote to stop (xStop is pdTRUE) or to start again, by RTS or
+	 * by sending XOFF or XON.  Called with interrupts disabled.
+	 */
+	static void prvFlowSetRxStopped( SerialPort_t *pxPort, BaseType_t xStop );
+
+	/*
+	 * Start the remote again if the Rx buffer is down to the low watermark.
+	 */
+	static void prvFlowRxTaken( SerialPort_t *pxPort );
+
+#endif /* serUSE_FLOW_CONTROL */
+
+#define vInterruptOn( pxRegs )								\
 {															\
 	unsigned char ucByte;									\
 															\
-	ucByte = UCSR0B;										\
+	ucByte = *( ( pxRegs )->pucUCSRB );						\
 	ucByte |= serTX_INT_ENABLE;								\
-	UCSR0B = ucByte;										\
+	*( ( pxRegs )->pucUCSRB ) = ucByte;						\
 }																				
 /*-----------------------------------------------------------*/
 
-#define vInterrupt0Off()									\
+#define vInterruptOff( pxRegs )								\
 {															\
 	unsigned char ucInByte;									\
 															\
-	ucInByte = UCSR0B;										\
+	ucInByte = *( ( pxRegs )->pucUCSRB );					\
 	ucInByte &= ~serTX_INT_ENABLE;							\
-	UCSR0B = ucInByte;										\
+	*( ( pxRegs )->pucUCSRB ) = ucInByte;					\
+}
+/*-----------------------------------------------------------*/
+
+xComPortHandle xSerialPortInitMinimal( unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength )
+{
+	/* The minimal interface always uses USART0, 8n1. */
+	return prvPortInit( serCOM1, ulWantedBaud, serEIGHT_DATA_BITS, uxQueueLength );
+}
+/*-----------------------------------------------------------*/
+
+xComPortHandle xSerialPortInitUSART( eCOMPort ePort, unsigned long ulWantedBaud, unsigned portBASE_TYPE uxQueueLength )
+{
+	return prvPortInit( ePort, ulWantedBaud, serEIGHT_DATA_BITS, uxQueueLength );
 }
 /*-----------------------------------------------------------*/
 
-xComPortHandle xSerialPortInitMinimal( uint32_t ulWantedBaud, unsigned portBASE_TYPE uxQueueLength )
+xComPortHandle xSerialPortInit( eCOMPort ePort, eBaud eWantedBaud, eParity eWantedParity, eDataBits eWantedDataBits, eStopBits eWantedStopBits, unsigned portBASE_TYPE uxBufferLength )
 {
-uint32_t ulBaudRateCounter;
+static const uint32_t ulBaudRates[] = { 50UL, 75UL, 110UL, 134UL, 150UL, 200UL, 300UL, 600UL, 1200UL, 1800UL, 2400UL, 4800UL, 9600UL, 19200UL, 38400UL, 57600UL, 115200UL };
+unsigned char ucFrame;
+
+	/* The USART has no mark or space parity. */
+	if( ( ( UBaseType_t ) eWantedBaud >= ( sizeof( ulBaudRates ) / sizeof( ulBaudRates[ 0 ] ) ) ) ||
+		( eWantedParity == serMARK_PARITY ) || ( eWantedParity == serSPACE_PARITY ) )
+	{
+		return NULL;
+	}
+
+	/* serBITS_5 to serBITS_8 map directly onto UCSZn1:0. */
+	ucFrame = ( unsigned char ) ( ( ( unsigned char ) eWantedDataBits & 0x03 ) << serDATA_BITS_SHIFT );
+
+	if( eWantedParity == serEVEN_PARITY )
+	{
+		ucFrame |= serEVEN_PARITY_BITS;
+	}
+	else if( eWantedParity == serODD_PARITY )
+	{
+		ucFrame |= serODD_PARITY_BITS;
+	}
+
+	if( eWantedStopBits == serSTOP_2 )
+	{
+		ucFrame |= serTWO_STOP_BITS;
+	}
+
+	return prvPortInit( ePort, ulBaudRates[ eWantedBaud ], ucFrame, uxBufferLength );
+}
+/*-----------------------------------------------------------*/
+
+static xComPortHandle prvPortInit( eCOMPort ePort, unsigned long ulWantedBaud, unsigned char ucFrame, unsigned portBASE_TYPE uxQueueLength )
+{
+SerialPort_t *pxPort;
+const SerialRegisters_t *pxRegs;
 unsigned char ucByte;
 
+	if( ( UBaseType_t ) ePort >= ( UBaseType_t ) serNUM_PORTS )
+	{
+		return NULL;
+	}
+
+	pxPort = &( xPorts[ ePort ] );
+	pxRegs = &( xRegisters[ ePort ] );
+	pxPort->pxRegisters = pxRegs;
+	vSerialSolveBaud( configCPU_CLOCK_HZ, ulWantedBaud, &( pxPort->xBaud ) );
+
 	portENTER_CRITICAL();
 	{
-		/* Create the queues used by the com test task. */
-		xRxedChars = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
-		xCharsForTx = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
+		#if( serUSE_RING_BUFFERS == 1 )
+		{
+			prvInitialiseRing( &( pxPort->xRxRing ), uxQueueLength );
+			prvInitialiseRing( &( pxPort->xTxRing ), uxQueueLength );
+		}
+		#else
+		{
+			/* Create the queues used by the com test task. */
+			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				if( uxQueueLength > ( unsigned portBASE_TYPE ) serSTATIC_QUEUE_LENGTH )
+				{
+					uxQueueLength = ( unsigned portBASE_TYPE ) serSTATIC_QUEUE_LENGTH;
+				}
 
-		/* Calculate the baud rate register value from the equation in the data sheet, around page 203.
-		 *	We'll be using double speed mode (U2Xn = 1)
-		 *	UBRRn = (fOSC / (8*BAUD)) - 1
-		 */
-		ulBaudRateCounter = ( configCPU_CLOCK_HZ / ( serBAUD_DIV_CONSTANT * ulWantedBaud ) ) - ( uint32_t ) 1;
+				pxPort->xRxedChars = xQueueCreateByteStatic( uxQueueLength, pxPort->ucRxStorage, &( pxPort->xRxQueueBuffer ) );
+				pxPort->xCharsForTx = xQueueCreateByteStatic( uxQueueLength, pxPort->ucTxStorage, &( pxPort->xTxQueueBuffer ) );
+			}
+			#else
+			{
+				pxPort->xRxedChars = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
+				pxPort->xCharsForTx = xQueueCreate( uxQueueLength, ( unsigned portBASE_TYPE ) sizeof( signed char ) );
+			}
+			#endif
+		}
+		#endif
 
+		#if( serUSE_STATS == 1 )
+		{
+			memset( ( void * ) &( pxPort->xStats ), 0x00, sizeof( pxPort->xStats ) );
+		}
+		#endif
 
-		/* Set the baud rate. */	
-		UBRR0 = ulBaudRateCounter;
+		/* Set the baud rate worked out by vSerialSolveBaud(). */
+		*( pxRegs->pusUBRR ) = pxPort->xBaud.usUBRR;
 
-		/* Choose the double speed mode */
-		ucByte = UCSR0A;
-		ucByte |= ( serDOUBLE_SPEED );
-		UCSR0A = ucByte;
+		/* Choose the normal or double speed mode. */
+		ucByte = *( pxRegs->pucUCSRA );
+		if( pxPort->xBaud.ucDoubleSpeed != 0 )
+		{
+			ucByte |= ( serDOUBLE_SPEED );
+		}
+		else
+		{
+			ucByte &= ~( serDOUBLE_SPEED );
+		}
+		*( pxRegs->pucUCSRA ) = ucByte;
 
 		/* Enable the Rx interrupt.  The Tx interrupt will get enabled
 		later. Also enable the Rx and Tx. */
-		UCSR0B = ( serRX_INT_ENABLE | serRX_ENABLE | serTX_ENABLE );
+		*( pxRegs->pucUCSRB ) = ( serRX_INT_ENABLE | serRX_ENABLE | serTX_ENABLE );
 
-		/* Set the data bits to 8, 1 stop bit, no parity (8n1). */
-		UCSR0C = ( serEIGHT_DATA_BITS );
+		/* Set the data bits, parity and stop bits (8n1 for the minimal
+		interface). */
+		*( pxRegs->pucUCSRC ) = ucFrame;
 	}
 	portEXIT_CRITICAL();
-	
-	/* Unlike other ports, this serial code does not allow for more than one
-	com port.  We therefore don't return a pointer to a port structure and can
-	instead just return NULL. */
-	return NULL;
+
+	return ( xComPortHandle ) pxPort;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialSolveBaud( uint32_t ulClockHz, uint32_t ulWantedBaud, SerialBaud_t *pxBaud )
+{
+uint64_t ullSamples, ullDivisor, ullError, ullDivisors[ 2 ], ullErrors[ 2 ];
+UBaseType_t uxMode;
+
+	/* The same sums as the serBAUD_...() macros, so the two always agree.
+	64 bit, but only done when a port is opened. */
+	for( uxMode = 0; uxMode < 2; uxMode++ )
+	{
+		/* Mode 0 is normal speed, 1 double speed. */
+		ullSamples = ( uxMode == 0 ) ? 16ULL : 8ULL;
+		ullDivisor = serBAUD_LOW_DIVISOR( ulClockHz, ulWantedBaud, ullSamples );
+		ullError = serBAUD_CLOCK_ERROR( ulClockHz, ulWantedBaud, ullSamples, ullDivisor );
+
+		/* Rounded up is better if its rate error, once both are scaled by
+		the divisors, is smaller. */
+		if( ( ullError * ( ullDivisor + 1ULL ) ) > ( serBAUD_CLOCK_ERROR( ulClockHz, ulWantedBaud, ullSamples, ullDivisor + 1ULL ) * ullDivisor ) )
+		{
+			ullDivisor++;
+			ullError = serBAUD_CLOCK_ERROR( ulClockHz, ulWantedBaud, ullSamples, ullDivisor );
+		}
+
+		ullDivisors[ uxMode ] = ullDivisor;
+		ullErrors[ uxMode ] = ullError;
+	}
+
+	/* Normal speed samples each bit more often, so is kept on a tie. */
+	uxMode = ( ( ullErrors[ 1 ] * 2ULL * ullDivisors[ 0 ] ) < ( ullErrors[ 0 ] * ullDivisors[ 1 ] ) ) ? 1 : 0;
+	ullSamples = ( uxMode == 0 ) ? 16ULL : 8ULL;
+	ullDivisor = ullDivisors[ uxMode ];
+
+	pxBaud->usUBRR = ( uint16_t ) ( ullDivisor - 1ULL );
+	pxBaud->ucDoubleSpeed = ( uint8_t ) uxMode;
+	pxBaud->ulBaud = ( uint32_t ) serBAUD_RATE_FOR( ulClockHz, ullSamples, ullDivisor );
+
+	/* In hundredths of a percent, limited to what fits in sError. */
+	ullError = serBAUD_ERROR_FOR( ulClockHz, ulWantedBaud, ullSamples, ullDivisor );
+	if( ullError > 0x7fffULL )
+	{
+		ullError = 0x7fffULL;
+	}
+
+	pxBaud->sError = ( ( uint64_t ) ulClockHz >= ( ullSamples * ulWantedBaud * ullDivisor ) ) ? ( int16_t ) ullError : -( int16_t ) ullError;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialGetBaud( xComPortHandle pxPort, SerialBaud_t *pxBaud )
+{
+	*pxBaud = ( ( SerialPort_t * ) pxPort )->xBaud;
 }
 /*-----------------------------------------------------------*/
 
 signed portBASE_TYPE xSerialGetChar( xComPortHandle pxPort, signed char *pcRxedChar, TickType_t xBlockTime )
 {
-	/* Only one port is supported by now. */
-	( void ) pxPort;
+SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
 
 	/* Get the next character from the buffer.  Return false if no characters
 	are available, or arrive before xBlockTime expires. */
-	if( xQueueReceive( xRxedChars, pcRxedChar, xBlockTime ) )
+	#if( serUSE_RING_BUFFERS == 1 )
 	{
-		return pdTRUE;
+	SerialRing_t * const pxRing = &( pxSerial->xRxRing );
+
+		if( prvWaitForRing( pxRing, pdFALSE, 1, 1, xBlockTime ) != pdFALSE )
+		{
+			*pcRxedChar = ( signed char ) pxRing->pucBuffer[ pxRing->ucTail ];
+			pxRing->ucTail = ( pxRing->ucTail + 1 ) & pxRing->ucMask;
+			serFLOW_RX_TAKEN( pxSerial );
+			return pdTRUE;
+		}
+		else
+		{
+			return pdFALSE;
+		}
 	}
-	else
+	#else
 	{
-		return pdFALSE;
+		if( xQueueReceive( pxSerial->xRxedChars, pcRxedChar, xBlockTime ) )
+		{
+			serFLOW_RX_TAKEN( pxSerial );
+			return pdTRUE;
+		}
+		else
+		{
+			return pdFALSE;
+		}
 	}
+	#endif
 }
 /*-----------------------------------------------------------*/
 
 signed portBASE_TYPE xSerialPutChar( xComPortHandle pxPort, signed char cOutChar, TickType_t xBlockTime )
 {
-	/* Only one port is supported by now. */
-	( void ) pxPort;
+SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
 
-	/* Return false if after the block time there is no room on the Tx queue. */
-	if( xQueueSend( xCharsForTx, &cOutChar, xBlockTime ) != pdPASS )
+	/* Return false if after the block time there is no room on the Tx queue.
+	A writer that has to wait is woken once the ring is half empty. */
+	#if( serUSE_RING_BUFFERS == 1 )
 	{
-		return pdFAIL;
+	SerialRing_t * const pxRing = &( pxSerial->xTxRing );
+
+		if( serRING_FREE( pxRing ) == 0 )
+		{
+			serSTATS_INCREMENT( pxSerial, ulTxStalls );
+		}
+
+		if( prvWaitForRing( pxRing, pdTRUE, 1, ( pxRing->ucMask + 1 ) / 2, xBlockTime ) == pdFALSE )
+		{
+			return pdFAIL;
+		}
+
+		pxRing->pucBuffer[ pxRing->ucHead ] = ( uint8_t ) cOutChar;
+		pxRing->ucHead = ( pxRing->ucHead + 1 ) & pxRing->ucMask;
+		serSTATS_PEAK( pxSerial, uxTxPeak, serRING_USED( pxRing ) );
 	}
+	#else
+	{
+		if( xQueueSend( pxSerial->xCharsForTx, &cOutChar, 0 ) != pdPASS )
+		{
+			serSTATS_INCREMENT( pxSerial, ulTxStalls );
 
-	vInterrupt0On();
+			if( xQueueSend( pxSerial->xCharsForTx, &cOutChar, xBlockTime ) != pdPASS )
+			{
+				return pdFAIL;
+			}
+		}
+
+		serSTATS_PEAK( pxSerial, uxTxPeak, uxQueueMessagesWaiting( pxSerial->xCharsForTx ) );
+	}
+	#endif
+
+	vInterruptOn( pxSerial->pxRegisters );
 
 	return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
+signed portBASE_TYPE xSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength, TickType_t xBlockTime )
+{
+SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+const signed char *pcNext = pcString;
+signed portBASE_TYPE xReturn = pdPASS;
+TimeOut_t xTimeOut;
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	#if( serUSE_RING_BUFFERS == 1 )
+	{
+	SerialRing_t * const pxRing = &( pxSerial->xTxRing );
+	UBaseType_t uxHalf = ( pxRing->ucMask + 1 ) / 2, uxCount;
+	uint8_t ucHead;
+
+		while( usStringLength > 0 )
+		{
+			/* Wait for room, but don't wake for less than the rest of the
+			string or half the ring. */
+			uxCount = ( usStringLength < uxHalf ) ? ( UBaseType_t ) usStringLength : uxHalf;
+
+			if( serRING_FREE( pxRing ) == 0 )
+			{
+				serSTATS_INCREMENT( pxSerial, ulTxStalls );
+			}
+
+			if( prvWaitForRing( pxRing, pdTRUE, 1, uxCount, xBlockTime ) == pdFALSE )
+			{
+				xReturn = pdFAIL;
+				break;
+			}
+
+			/* Copy all that fits, then hand it to the ISR with one write of
+			the head and one enable of the UDRE interrupt. */
+			uxCount = serRING_FREE( pxRing );
+			if( uxCount > usStringLength )
+			{
+				uxCount = ( UBaseType_t ) usStringLength;
+			}
+
+			usStringLength -= uxCount;
+			ucHead = pxRing->ucHead;
+
+			while( uxCount > 0 )
+			{
+				pxRing->pucBuffer[ ucHead ] = ( uint8_t ) *pcNext;
+				ucHead = ( ucHead + 1 ) & pxRing->ucMask;
+				pcNext++;
+				uxCount--;
+			}
+
+			pxRing->ucHead = ucHead;
+			vInterruptOn( pxSerial->pxRegisters );
+			serSTATS_PEAK( pxSerial, uxTxPeak, serRING_USED( pxRing ) );
+
+			if( xTaskCheckForTimeOut( &xTimeOut, &xBlockTime ) != pdFALSE )
+			{
+				xBlockTime = 0;
+			}
+		}
+	}
+	#else
+	{
+		while( usStringLength > 0 )
+		{
+			if( xQueueSend( pxSerial->xCharsForTx, pcNext, 0 ) != pdPASS )
+			{
+				/* The queue is full, so the characters already in it have to
+				be on their way before waiting for room. */
+				vInterruptOn( pxSerial->pxRegisters );
+				serSTATS_INCREMENT( pxSerial, ulTxStalls );
+				serSTATS_PEAK( pxSerial, uxTxPeak, uxQueueMessagesWaiting( pxSerial->xCharsForTx ) );
+
+				if( xTaskCheckForTimeOut( &xTimeOut, &xBlockTime ) != pdFALSE )
+				{
+					xBlockTime = 0;
+				}
+
+				if( xQueueSend( pxSerial->xCharsForTx, pcNext, xBlockTime ) != pdPASS )
+				{
+					xReturn = pdFAIL;
+					break;
+				}
+			}
+
+			pcNext++;
+			usStringLength--;
+		}
+
+		vInterruptOn( pxSerial->pxRegisters );
+		serSTATS_PEAK( pxSerial, uxTxPeak, uxQueueMessagesWaiting( pxSerial->xCharsForTx ) );
+	}
+	#endif
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vSerialPutString( xComPortHandle pxPort, const signed char * const pcString, unsigned short usStringLength )
+{
+	( void ) xSerialPutString( pxPort, pcString, usStringLength, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+void vSerialPutValue( xComPortHandle pxPort, const char *pcName, uint32_t ulValue, TickType_t xBlockTime )
+{
+char cBuffer[ 10 ];
+char *pcDigit = &( cBuffer[ sizeof( cBuffer ) ] );
+
+	( void ) xSerialPutString( pxPort, ( const signed char * ) pcName, ( unsigned short ) strlen( pcName ), xBlockTime );
+
+	/* Build the digits backwards from the end of the buffer. */
+	do
+	{
+		pcDigit--;
+		*pcDigit = ( char ) ( '0' + ( ulValue % 10UL ) );
+		ulValue /= 10UL;
+	} while( ulValue != 0UL );
+
+	( void ) xSerialPutString( pxPort, ( const signed char * ) pcDigit, ( unsigned short ) ( &( cBuffer[ sizeof( cBuffer ) ] ) - pcDigit ), xBlockTime );
+}
+/*-----------------------------------------------------------*/
+
+unsigned short usSerialRead( xComPortHandle pxPort, signed char *pcBuffer, unsigned short usMaxLength, TickType_t xBlockTime )
+{
+SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+unsigned short usReceived = 0;
+
+	if( usMaxLength == 0 )
+	{
+		return 0;
+	}
+
+	#if( serUSE_RING_BUFFERS == 1 )
+	{
+	SerialRing_t * const pxRing = &( pxSerial->xRxRing );
+	uint8_t ucTail;
+
+		/* Wait for the first character only, then take all there is. */
+		if( prvWaitForRing( pxRing, pdFALSE, 1, 1, xBlockTime ) != pdFALSE )
+		{
+			usReceived = serRING_USED( pxRing );
+			if( usReceived > usMaxLength )
+			{
+				usReceived = usMaxLength;
+			}
+
+			ucTail = pxRing->ucTail;
+
+			for( usMaxLength = 0; usMaxLength < usReceived; usMaxLength++ )
+			{
+				pcBuffer[ usMaxLength ] = ( signed char ) pxRing->pucBuffer[ ucTail ];
+				ucTail = ( ucTail + 1 ) & pxRing->ucMask;
+			}
+
+			/* The space is handed back to the ISR in one go. */
+			pxRing->ucTail = ucTail;
+			serFLOW_RX_TAKEN( pxSerial );
+		}
+	}
+	#else
+	{
+		if( xQueueReceive( pxSerial->xRxedChars, pcBuffer, xBlockTime ) == pdPASS )
+		{
+			do
+			{
+				usReceived++;
+			} while( ( usReceived < usMaxLength ) && ( xQueueReceive( pxSerial->xRxedChars, &( pcBuffer[ usReceived ] ), 0 ) == pdPASS ) );
+
+			serFLOW_RX_TAKEN( pxSerial );
+		}
+	}
+	#endif
+
+	return usReceived;
+}
+/*-----------------------------------------------------------*/
+
+#if( serUSE_COBS_FRAMES == 1 )
+
+	signed portBASE_TYPE xSerialEnableFrames( xComPortHandle pxPort )
+	{
+	SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+	SerialFramer_t *pxFramer;
+	uint8_t *pucSlots;
+
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxFramer = &( pxSerial->xFramerBuffer );
+			pucSlots = pxSerial->ucFrameSlots;
+		}
+		#else
+		{
+			pxFramer = ( SerialFramer_t * ) pvPortMalloc( sizeof( SerialFramer_t ) );
+			pucSlots = ( uint8_t * ) pvPortMalloc( 2 * serMAX_FRAME_LENGTH );
+		}
+		#endif
+
+		if( ( pxFramer == NULL ) || ( pucSlots == NULL ) )
+		{
+			return pdFAIL;
+		}
+
+		pxFramer->pucSlot[ 0 ] = pucSlots;
+		pxFramer->pucSlot[ 1 ] = pucSlots + serMAX_FRAME_LENGTH;
+		pxFramer->ucReady[ 0 ] = pdFALSE;
+		pxFramer->ucReady[ 1 ] = pdFALSE;
+		pxFramer->ucFilling = 0;
+		pxFramer->ucTaking = 0;
+		pxFramer->usFill = 0;
+		pxFramer->ucRemaining = 0;
+		pxFramer->ucLastCode = 0;
+
+		/* Anything before the first delimiter is part of a frame that started
+		before the decoder, so is dropped. */
+		pxFramer->ucDiscard = pdTRUE;
+		pxFramer->xWaitingTask = NULL;
+
+		/* From here on the Rx ISR passes the characters to the decoder. */
+		pxSerial->pxFramer = pxFramer;
+
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	const uint8_t *pucSerialGetFrame( xComPortHandle pxPort, unsigned short *pusLength, TickType_t xBlockTime )
+	{
+	SerialFramer_t * const pxFramer = ( ( SerialPort_t * ) pxPort )->pxFramer;
+	const uint8_t ucSlot = pxFramer->ucTaking;
+	TimeOut_t xTimeOut;
+	BaseType_t xTimedOut = pdFALSE;
+
+		/* A frame is normally waited for, so no fast path is needed. */
+		vTaskSetTimeOutState( &xTimeOut );
+
+		while( ( pxFramer->ucReady[ ucSlot ] == pdFALSE ) && ( xTimedOut == pdFALSE ) )
+		{
+			portENTER_CRITICAL();
+			{
+				if( pxFramer->ucReady[ ucSlot ] == pdFALSE )
+				{
+					pxFramer->xWaitingTask = xTaskGetCurrentTaskHandle();
+				}
+			}
+			portEXIT_CRITICAL();
+
+			if( pxFramer->ucReady[ ucSlot ] == pdFALSE )
+			{
+				xTimedOut = xTaskCheckForTimeOut( &xTimeOut, &xBlockTime );
+
+				if( xTimedOut == pdFALSE )
+				{
+					( void ) ulTaskNotifyTake( pdTRUE, xBlockTime );
+				}
+			}
+		}
+
+		pxFramer->xWaitingTask = NULL;
+
+		if( pxFramer->ucReady[ ucSlot ] == pdFALSE )
+		{
+			return NULL;
+		}
+
+		/* The frame stays in the slot until the task releases it. */
+		*pusLength = pxFramer->usLength[ ucSlot ];
+		return pxFramer->pucSlot[ ucSlot ];
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSerialReleaseFrame( xComPortHandle pxPort )
+	{
+	SerialFramer_t * const pxFramer = ( ( SerialPort_t * ) pxPort )->pxFramer;
+
+		/* Hand the slot back to the ISR. */
+		pxFramer->ucReady[ pxFramer->ucTaking ] = pdFALSE;
+		pxFramer->ucTaking ^= 1;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* serUSE_COBS_FRAMES */
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	void vSerialSetFlowPins( xComPortHandle pxPort, volatile uint8_t *pucRTSPort, uint8_t ucRTSMask, volatile uint8_t *pucCTSPin, uint8_t ucCTSMask )
+	{
+	SerialFlow_t * const pxFlow = &( ( ( SerialPort_t * ) pxPort )->xFlow );
+
+		/* The pins are only read or written once RTS/CTS is selected.  Their
+		DDR bits are left to the application. */
+		pxFlow->pucRTSPort = pucRTSPort;
+		pxFlow->ucRTSMask = ucRTSMask;
+		pxFlow->pucCTSPin = pucCTSPin;
+		pxFlow->ucCTSMask = ucCTSMask;
+	}
+	/*-----------------------------------------------------------*/
+
+	signed portBASE_TYPE xSerialSetFlowControl( xComPortHandle pxPort, eFlowControl eFlow, UBaseType_t uxLowWater, UBaseType_t uxHighWater )
+	{
+	SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+	SerialFlow_t * const pxFlow = &( pxSerial->xFlow );
+	UBaseType_t uxCapacity;
+
+		#if( serUSE_RING_BUFFERS == 1 )
+		{
+			uxCapacity = pxSerial->xRxRing.ucMask;
+		}
+		#else
+		{
+			uxCapacity = uxQueueMessagesWaiting( pxSerial->xRxedChars ) + uxQueueSpacesAvailable( pxSerial->xRxedChars );
+		}
+		#endif
+
+		/* The characters the remote sends after being told to stop have to
+		fit above the high watermark. */
+		if( ( eFlow != serFLOW_NONE ) &&
+			( ( uxLowWater >= uxHighWater ) || ( uxHighWater >= uxCapacity ) ||
+			( ( eFlow == serFLOW_RTS_CTS ) && ( ( pxFlow->pucRTSPort == NULL ) || ( pxFlow->pucCTSPin == NULL ) ) ) ) )
+		{
+			return pdFAIL;
+		}
+
+		portENTER_CRITICAL();
+		{
+			/* Start from a running link. */
+			if( pxFlow->ucRxStopped != pdFALSE )
+			{
+				prvFlowSetRxStopped( pxSerial, pdFALSE );
+			}
+
+			pxFlow->ucMode = ( uint8_t ) eFlow;
+			pxFlow->uxLowWater = uxLowWater;
+			pxFlow->uxHighWater = uxHighWater;
+			pxFlow->ucTxStopped = pdFALSE;
+			pxFlow->ucSendControl = 0;
+
+			if( eFlow == serFLOW_RTS_CTS )
+			{
+				*( pxFlow->pucRTSPort ) &= ~( pxFlow->ucRTSMask );
+			}
+
+			vInterruptOn( pxSerial->pxRegisters );
+		}
+		portEXIT_CRITICAL();
+
+		return pdPASS;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSerialCheckCTS( xComPortHandle pxPort )
+	{
+	SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+
+		/* The UDRE ISR turns itself off while CTS is high, and nothing tells
+		it when CTS goes low again.  So this is to be called from a pin change
+		interrupt on CTS, or from the tick hook.  Restarting the UDRE interrupt
+		is harmless when there is nothing to send.  The CTS pin is only set for
+		RTS/CTS flow control. */
+		if( ( pxSerial->xFlow.ucMode == serFLOW_RTS_CTS ) && ( ( *( pxSerial->xFlow.pucCTSPin ) & pxSerial->xFlow.ucCTSMask ) == 0 ) )
+		{
+			vInterruptOn( pxSerial->pxRegisters );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvRxLevel( SerialPort_t *pxPort )
+	{
+		#if( serUSE_RING_BUFFERS == 1 )
+		{
+			return serRING_USED( &( pxPort->xRxRing ) );
+		}
+		#else
+		{
+			return uxQueueMessagesWaitingFromISR( pxPort->xRxedChars );
+		}
+		#endif
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFlowSetRxStopped( SerialPort_t *pxPort, BaseType_t xStop )
+	{
+	SerialFlow_t * const pxFlow = &( pxPort->xFlow );
+
+		pxFlow->ucRxStopped = ( uint8_t ) xStop;
+
+		if( pxFlow->ucMode == serFLOW_RTS_CTS )
+		{
+			if( xStop != pdFALSE )
+			{
+				*( pxFlow->pucRTSPort ) |= pxFlow->ucRTSMask;
+			}
+			else
+			{
+				*( pxFlow->pucRTSPort ) &= ~( pxFlow->ucRTSMask );
+			}
+		}
+		else
+		{
+			/* Sent by the UDRE ISR before anything else, even while an XOFF
+			from the remote holds the Tx. */
+			pxFlow->ucSendControl = ( xStop != pdFALSE ) ? serXOFF : serXON;
+			vInterruptOn( pxPort->pxRegisters );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvFlowRxTaken( SerialPort_t *pxPort )
+	{
+		portENTER_CRITICAL();
+		{
+			if( ( pxPort->xFlow.ucRxStopped != pdFALSE ) && ( prvRxLevel( pxPort ) <= pxPort->xFlow.uxLowWater ) )
+			{
+				prvFlowSetRxStopped( pxPort, pdFALSE );
+			}
+		}
+		portEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* serUSE_FLOW_CONTROL */
+
+#if( serUSE_STATS == 1 )
+
+	void vSerialGetStats( xComPortHandle pxPort, SerialStats_t *pxStats )
+	{
+	SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+
+		/* The ISRs update the counters, so take a consistent copy. */
+		portENTER_CRITICAL();
+		{
+			*pxStats = pxSerial->xStats;
+		}
+		portEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSerialResetStats( xComPortHandle pxPort )
+	{
+	SerialPort_t * const pxSerial = ( SerialPort_t * ) pxPort;
+
+		portENTER_CRITICAL();
+		{
+			memset( ( void * ) &( pxSerial->xStats ), 0x00, sizeof( pxSerial->xStats ) );
+		}
+		portEXIT_CRITICAL();
+	}
+	/*-----------------------------------------------------------*/
+
+	void vSerialPutStats( xComPortHandle pxOutPort, xComPortHandle pxPort )
+	{
+	SerialStats_t xStats;
+
+		vSerialGetStats( pxPort, &xStats );
+
+		vSerialPutValue( pxOutPort, "SERSTAT fe=", xStats.ulFrameErrors, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " ovr=", xStats.ulOverruns, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " par=", xStats.ulParityErrors, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " rxdrop=", xStats.ulRxDropped, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " frdrop=", xStats.ulFramesDropped, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " txstall=", xStats.ulTxStalls, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " rxpeak=", ( uint32_t ) xStats.uxRxPeak, portMAX_DELAY );
+		vSerialPutValue( pxOutPort, " txpeak=", ( uint32_t ) xStats.uxTxPeak, portMAX_DELAY );
+		vSerialPutString( pxOutPort, ( const signed char * ) "\r\n", 2 );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* serUSE_STATS */
+
 void vSerialClose( xComPortHandle xPort )
 {
+const SerialRegisters_t * const pxRegs = ( ( SerialPort_t * ) xPort )->pxRegisters;
 unsigned char ucByte;
 
-	/* The parameter is not used. */
-	( void ) xPort;
-
 	/* Turn off the interrupts.  We may also want to delete the queues and/or
 	re-install the original ISR. */
 
 	portENTER_CRITICAL();
 	{
-		vInterrupt0Off();
-		ucByte = UCSR0B;
+		vInterruptOff( pxRegs );
+		ucByte = *( pxRegs->pucUCSRB );
 		ucByte &= ~( serRX_INT_ENABLE | serRX_ENABLE | serTX_ENABLE );
-		UCSR0B = ucByte;
+		*( pxRegs->pucUCSRB ) = ucByte;
 	}
 	portEXIT_CRITICAL();
 }
+/*-----------------------------------------------------------*/
+
+#if( serUSE_RING_BUFFERS == 1 )
+
+	static void prvInitialiseRing( SerialRing_t *pxRing, UBaseType_t uxLength )
+	{
+	uint16_t usSize = 2;
+
+		/* A power of 2 larger than uxLength, as one byte is kept empty. */
+		while( ( usSize <= uxLength ) && ( usSize < serMAX_RING_SIZE ) )
+		{
+			usSize <<= 1;
+		}
+
+		#if( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxRing->pucBuffer = pxRing->ucStorage;
+		}
+		#else
+		{
+			pxRing->pucBuffer = ( volatile uint8_t * ) pvPortMalloc( ( size_t ) usSize );
+			configASSERT( pxRing->pucBuffer );
+		}
+		#endif
+		pxRing->ucMask = ( uint8_t ) ( usSize - 1U );
+		pxRing->ucHead = 0;
+		pxRing->ucTail = 0;
+		pxRing->xWaitingTask = NULL;
+		pxRing->ucWakeLevel = 0;
+	}
+	/*-----------------------------------------------------------*/
+
+	static BaseType_t prvWaitForRing( SerialRing_t *pxRing, BaseType_t xForSpace, UBaseType_t uxWanted, UBaseType_t uxWakeLevel, TickType_t xBlockTime )
+	{
+	TimeOut_t xTimeOut;
+	BaseType_t xReady, xTimedOut = pdFALSE;
+
+		/* Most calls find the ring ready. */
+		xReady = ( ( xForSpace != pdFALSE ) ? serRING_FREE( pxRing ) : serRING_USED( pxRing ) ) >= uxWanted;
+
+		if( ( xReady == pdFALSE ) && ( xBlockTime != ( TickType_t ) 0 ) )
+		{
+			vTaskSetTimeOutState( &xTimeOut );
+
+			while( ( xReady == pdFALSE ) && ( xTimedOut == pdFALSE ) )
+			{
+				/* The ISR can't change the ring between the check and the
+				task recording that it is waiting. */
+				portENTER_CRITICAL();
+				{
+					xReady = ( ( xForSpace != pdFALSE ) ? serRING_FREE( pxRing ) : serRING_USED( pxRing ) ) >= uxWanted;
+
+					if( xReady == pdFALSE )
+					{
+						pxRing->ucWakeLevel = ( uint8_t ) uxWakeLevel;
+						pxRing->xWaitingTask = xTaskGetCurrentTaskHandle();
+					}
+				}
+				portEXIT_CRITICAL();
+
+				if( xReady == pdFALSE )
+				{
+					xTimedOut = xTaskCheckForTimeOut( &xTimeOut, &xBlockTime );
+
+					if( xTimedOut == pdFALSE )
+					{
+						/* A notification left over from an earlier timeout
+						only causes one more time round the loop. */
+						( void ) ulTaskNotifyTake( pdTRUE, xBlockTime );
+					}
+				}
+			}
+
+			portENTER_CRITICAL();
+			{
+				pxRing->xWaitingTask = NULL;
+			}
+			portEXIT_CRITICAL();
+		}
+
+		return xReady;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWakeFromISR( SerialRing_t *pxRing, uint8_t ucLevel, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+		if( ( pxRing->xWaitingTask != NULL ) && ( ucLevel >= pxRing->ucWakeLevel ) )
+		{
+			vTaskNotifyGiveFromISR( pxRing->xWaitingTask, pxHigherPriorityTaskWoken );
+			pxRing->xWaitingTask = NULL;
+		}
+	}
+
+#endif /* serUSE_RING_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( serUSE_COBS_FRAMES == 1 )
+
+	static void prvFrameByteFromISR( SerialPort_t *pxPort, uint8_t ucByte, BaseType_t *pxHigherPriorityTaskWoken )
+	{
+	SerialFramer_t * const pxFramer = pxPort->pxFramer;
+	const uint8_t ucSlot = pxFramer->ucFilling;
+
+		if( ucByte == 0 )
+		{
+			/* The delimiter.  The frame is complete if its last block is.  A
+			delimiter straight after another ends no frame, but a single code
+			byte of 1 before it is an empty frame. */
+			if( ( pxFramer->ucDiscard == pdFALSE ) && ( pxFramer->ucRemaining == 0 ) && ( pxFramer->ucLastCode != 0 ) )
+			{
+				pxFramer->usLength[ ucSlot ] = pxFramer->usFill;
+				pxFramer->ucReady[ ucSlot ] = pdTRUE;
+				pxFramer->ucFilling = ucSlot ^ 1;
+
+				if( pxFramer->xWaitingTask != NULL )
+				{
+					vTaskNotifyGiveFromISR( pxFramer->xWaitingTask, pxHigherPriorityTaskWoken );
+					pxFramer->xWaitingTask = NULL;
+				}
+			}
+
+			/* Start the next frame. */
+			pxFramer->usFill = 0;
+			pxFramer->ucRemaining = 0;
+			pxFramer->ucLastCode = 0;
+			pxFramer->ucDiscard = pdFALSE;
+		}
+		else if( pxFramer->ucDiscard == pdFALSE )
+		{
+			if( pxFramer->ucReady[ ucSlot ] != pdFALSE )
+			{
+				/* Both slots are still held by the task. */
+				pxFramer->ucDiscard = pdTRUE;
+				serSTATS_INCREMENT( pxPort, ulFramesDropped );
+			}
+			else if( pxFramer->ucRemaining == 0 )
+			{
+				/* A code byte.  The block before it stood for its data and a
+				zero, unless it was a full block or there was none. */
+				if( ( pxFramer->ucLastCode != 0 ) && ( pxFramer->ucLastCode != serCOBS_FULL_BLOCK ) )
+				{
+					if( pxFramer->usFill < serMAX_FRAME_LENGTH )
+					{
+						pxFramer->pucSlot[ ucSlot ][ pxFramer->usFill ] = 0;
+						pxFramer->usFill++;
+					}
+					else
+					{
+						pxFramer->ucDiscard = pdTRUE;
+						serSTATS_INCREMENT( pxPort, ulFramesDropped );
+					}
+				}
+
+				pxFramer->ucLastCode = ucByte;
+				pxFramer->ucRemaining = ucByte - 1;
+			}
+			else if( pxFramer->usFill < serMAX_FRAME_LENGTH )
+			{
+				pxFramer->pucSlot[ ucSlot ][ pxFramer->usFill ] = ucByte;
+				pxFramer->usFill++;
+				pxFramer->ucRemaining--;
+			}
+			else
+			{
+				/* Too long for the slot. */
+				pxFramer->ucDiscard = pdTRUE;
+				serSTATS_INCREMENT( pxPort, ulFramesDropped );
+			}
+		}
+	}
+
+#endif /* serUSE_COBS_FRAMES */
 /*-----------------------------------------------------------
  * INTERRUPTS
  *-----------------------------------------------------------
  */
 
-ISR( USART0_RX_vect )
+static inline void prvRxISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs )
 {
 signed char cChar;
 unsigned char ucChar;
 signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
 	/* If some problem occurred (Frame Error, Data Overrun or Parity), just flush the buffer and move on */
-	ucChar = UCSR0A;
+	ucChar = *( pxRegs->pucUCSRA );
 	if (ucChar & (serFRAME_ERROR_BIT | serOVERRUN_ERROR_BIT | serPARITY_ERROR_BIT))
 	{
-		while ( UCSR0A & serRECEIVE_COMPLETE) cChar = UDR0;
+		while ( *( pxRegs->pucUCSRA ) & serRECEIVE_COMPLETE) cChar = *( pxRegs->pxUDR );
+
+		#if( serUSE_STATS == 1 )
+		{
+			if( ( ucChar & serFRAME_ERROR_BIT ) != 0 )
+			{
+				serSTATS_INCREMENT( pxPort, ulFrameErrors );
+			}
+
+			if( ( ucChar & serOVERRUN_ERROR_BIT ) != 0 )
+			{
+				serSTATS_INCREMENT( pxPort, ulOverruns );
+			}
+
+			if( ( ucChar & serPARITY_ERROR_BIT ) != 0 )
+			{
+				serSTATS_INCREMENT( pxPort, ulParityErrors );
+			}
+		}
+		#endif
+
+		#if( serUSE_COBS_FRAMES == 1 )
+		{
+			/* The frame being received can't be trusted. */
+			if( ( pxPort->pxFramer != NULL ) && ( pxPort->pxFramer->ucDiscard == pdFALSE ) )
+			{
+				pxPort->pxFramer->ucDiscard = pdTRUE;
+				serSTATS_INCREMENT( pxPort, ulFramesDropped );
+			}
+		}
+		#endif
 	}
 	else
 	{
 		/* Get the character and post it on the queue of Rxed characters.
 		If the post causes a task to wake force a context switch as the woken task
 		may have a higher priority than the task we have interrupted. */
-		cChar = UDR0;
+		cChar = *( pxRegs->pxUDR );
+
+		#if( serUSE_FLOW_CONTROL == 1 )
+		if( ( pxPort->xFlow.ucMode == serFLOW_XON_XOFF ) && ( ( ( uint8_t ) cChar == serXON ) || ( ( uint8_t ) cChar == serXOFF ) ) )
+		{
+			/* The remote starting or stopping our Tx. */
+			pxPort->xFlow.ucTxStopped = ( ( uint8_t ) cChar == serXOFF );
+			vInterruptOn( pxRegs );
+		}
+		else
+		#endif
+		#if( serUSE_COBS_FRAMES == 1 )
+		if( pxPort->pxFramer != NULL )
+		{
+			prvFrameByteFromISR( pxPort, ( uint8_t ) cChar, &xHigherPriorityTaskWoken );
+		}
+		else
+		#endif
+		#if( serUSE_RING_BUFFERS == 1 )
+		{
+		SerialRing_t * const pxRing = &( pxPort->xRxRing );
+		uint8_t ucUsed;
 
-		xQueueSendFromISR( xRxedChars, &cChar, &xHigherPriorityTaskWoken );
+			/* The character is dropped if the ring is full. */
+			if( serRING_FREE( pxRing ) != 0 )
+			{
+				pxRing->pucBuffer[ pxRing->ucHead ] = ( uint8_t ) cChar;
+				pxRing->ucHead = ( pxRing->ucHead + 1 ) & pxRing->ucMask;
+			}
+			else
+			{
+				serSTATS_INCREMENT( pxPort, ulRxDropped );
+			}
+
+			ucUsed = serRING_USED( pxRing );
+			serSTATS_PEAK( pxPort, uxRxPeak, ucUsed );
+
+			#if( serUSE_FLOW_CONTROL == 1 )
+			{
+				if( ( pxPort->xFlow.ucMode != serFLOW_NONE ) && ( ucUsed >= pxPort->xFlow.uxHighWater ) && ( pxPort->xFlow.ucRxStopped == pdFALSE ) )
+				{
+					prvFlowSetRxStopped( pxPort, pdTRUE );
+				}
+			}
+			#endif
+
+			prvWakeFromISR( pxRing, ucUsed, &xHigherPriorityTaskWoken );
+		}
+		#else
+		{
+			if( xQueueSendFromISR( pxPort->xRxedChars, &cChar, &xHigherPriorityTaskWoken ) != pdPASS )
+			{
+				serSTATS_INCREMENT( pxPort, ulRxDropped );
+			}
+
+			serSTATS_PEAK( pxPort, uxRxPeak, uxQueueMessagesWaitingFromISR( pxPort->xRxedChars ) );
+
+			#if( serUSE_FLOW_CONTROL == 1 )
+			{
+				if( ( pxPort->xFlow.ucMode != serFLOW_NONE ) && ( pxPort->xFlow.ucRxStopped == pdFALSE ) && ( uxQueueMessagesWaitingFromISR( pxPort->xRxedChars ) >= pxPort->xFlow.uxHighWater ) )
+				{
+					prvFlowSetRxStopped( pxPort, pdTRUE );
+				}
+			}
+			#endif
+		}
+		#endif
 
 		if( xHigherPriorityTaskWoken != pdFALSE )
 		{
@@ -263,19 +1546,156 @@ signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 }
 /*-----------------------------------------------------------*/
 
-ISR( USART0_UDRE_vect )
+static inline void prvUdreISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs )
 {
-signed char cChar, cTaskWoken;
+#if( serUSE_RING_BUFFERS == 1 )
+
+SerialRing_t * const pxRing = &( pxPort->xTxRing );
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	#if( serUSE_FLOW_CONTROL == 1 )
+	{
+		if( prvFlowTxFromISR( pxPort, pxRegs ) != pdFALSE )
+		{
+			return;
+		}
+	}
+	#endif
+
+	if( pxRing->ucHead != pxRing->ucTail )
+	{
+		/* Send the next character queued for Tx. */
+		*( pxRegs->pxUDR ) = pxRing->pucBuffer[ pxRing->ucTail ];
+		pxRing->ucTail = ( pxRing->ucTail + 1 ) & pxRing->ucMask;
+
+		prvWakeFromISR( pxRing, serRING_FREE( pxRing ), &xHigherPriorityTaskWoken );
+
+		if( xHigherPriorityTaskWoken != pdFALSE )
+		{
+			taskYIELD();
+		}
+	}
+	else
+	{
+		/* Ring empty, nothing to send. */
+		vInterruptOff( pxRegs );
+	}
+
+#else
+
+signed char cChar;
+signed portBASE_TYPE xTaskWoken = pdFALSE;
+
+	#if( serUSE_FLOW_CONTROL == 1 )
+	{
+		if( prvFlowTxFromISR( pxPort, pxRegs ) != pdFALSE )
+		{
+			return;
+		}
+	}
+	#endif
 
-	if( xQueueReceiveFromISR( xCharsForTx, &cChar, &cTaskWoken ) == pdTRUE )
+	if( xQueueReceiveFromISR( pxPort->xCharsForTx, &cChar, &xTaskWoken ) == pdTRUE )
 	{
 		/* Send the next character queued for Tx. */
-		UDR0 = cChar;
+		*( pxRegs->pxUDR ) = cChar;
 	}
 	else
 	{
 		/* Queue empty, nothing to send. */
-		vInterrupt0Off();
+		vInterruptOff( pxRegs );
 	}
+
+#endif /* serUSE_RING_BUFFERS */
+}
+/*-----------------------------------------------------------*/
+
+#if( serUSE_FLOW_CONTROL == 1 )
+
+	static inline BaseType_t prvFlowTxFromISR( SerialPort_t *pxPort, const SerialRegisters_t *pxRegs )
+	{
+	SerialFlow_t * const pxFlow = &( pxPort->xFlow );
+	BaseType_t xHandled = pdFALSE;
+
+		if( pxFlow->ucMode != serFLOW_NONE )
+		{
+			if( pxFlow->ucSendControl != 0 )
+			{
+				/* XON or XOFF goes ahead of the data. */
+				*( pxRegs->pxUDR ) = pxFlow->ucSendControl;
+				pxFlow->ucSendControl = 0;
+				xHandled = pdTRUE;
+			}
+			else if( ( pxFlow->ucTxStopped != pdFALSE ) ||
+					 ( ( pxFlow->ucMode == serFLOW_RTS_CTS ) && ( ( *( pxFlow->pucCTSPin ) & pxFlow->ucCTSMask ) != 0 ) ) )
+			{
+				/* Turned on again by an XON or by vSerialCheckCTS(). */
+				vInterruptOff( pxRegs );
+				xHandled = pdTRUE;
+			}
+		}
+
+		return xHandled;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* serUSE_FLOW_CONTROL */
+
+ISR( USART0_RX_vect )
+{
+	prvRxISR( &( xPorts[ 0 ] ), &( xRegisters[ 0 ] ) );
 }
+/*-----------------------------------------------------------*/
+
+ISR( USART0_UDRE_vect )
+{
+	prvUdreISR( &( xPorts[ 0 ] ), &( xRegisters[ 0 ] ) );
+}
+/*-----------------------------------------------------------*/
+
+#if( serNUM_PORTS > 1 )
+
+	ISR( USART1_RX_vect )
+	{
+		prvRxISR( &( xPorts[ 1 ] ), &( xRegisters[ 1 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	ISR( USART1_UDRE_vect )
+	{
+		prvUdreISR( &( xPorts[ 1 ] ), &( xRegisters[ 1 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif
+
+#if( serNUM_PORTS > 2 )
+
+	ISR( USART2_RX_vect )
+	{
+		prvRxISR( &( xPorts[ 2 ] ), &( xRegisters[ 2 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	ISR( USART2_UDRE_vect )
+	{
+		prvUdreISR( &( xPorts[ 2 ] ), &( xRegisters[ 2 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif
+
+#if( serNUM_PORTS > 3 )
+
+	ISR( USART3_RX_vect )
+	{
+		prvRxISR( &( xPorts[ 3 ] ), &( xRegisters[ 3 ] ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	ISR( USART3_UDRE_vect )
+	{
+		prvUdreISR( &( xPorts[ 3 ] ), &( xRegisters[ 3 ] ) );
+	}
 
+#endif